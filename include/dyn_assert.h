@@ -6,5 +6,62 @@
 #include <exception>    // terminate()
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <type_traits>    // is_invocable_v
+#include <utility>        // forward()
 
-void dynamic_assert(bool assertion, std::string message);
+//
+// dynamic_assert():  always checked (e.g. validation of Sudoku parameters)
+//
+// index_assert():    bounds checks in element accessors; checked depending on the
+//                    policy selected at compile time:
+//
+//   DYN_ASSERT_ALWAYS   check in all builds
+//   DYN_ASSERT_OFF      never check
+//   (default)           check in debug builds only, i.e. if NDEBUG is not defined
+//
+// Messages are given either as string literal or as callable returning the message.
+// The callable is only invoked if the assertion fails, so no string is built on the
+// (likely) path where the assertion holds.
+//
+
+enum class Dyn_assert_policy { always, debug_only, off };
+
+#if defined(DYN_ASSERT_ALWAYS)
+inline constexpr Dyn_assert_policy dyn_assert_policy = Dyn_assert_policy::always;
+#elif defined(DYN_ASSERT_OFF)
+inline constexpr Dyn_assert_policy dyn_assert_policy = Dyn_assert_policy::off;
+#else
+inline constexpr Dyn_assert_policy dyn_assert_policy = Dyn_assert_policy::debug_only;
+#endif
+
+#if defined(NDEBUG)
+inline constexpr bool dyn_assert_debug_build = false;
+#else
+inline constexpr bool dyn_assert_debug_build = true;
+#endif
+
+inline constexpr bool index_assert_enabled =
+    dyn_assert_policy == Dyn_assert_policy::always ||
+    (dyn_assert_policy == Dyn_assert_policy::debug_only && dyn_assert_debug_build);
+
+// print message and terminate (cold path, kept out of line)
+[[noreturn]] void dynamic_assert_failed(std::string_view message);
+
+inline void dynamic_assert(bool assertion, const char* message) {
+    if (!assertion) [[unlikely]] { dynamic_assert_failed(message); }
+}
+
+template <typename F>
+    requires std::is_invocable_v<F>
+inline void dynamic_assert(bool assertion, F&& make_message) {
+    if (!assertion) [[unlikely]] {
+        dynamic_assert_failed(std::string(std::forward<F>(make_message)()));
+    }
+}
+
+template <typename M> inline void index_assert(bool assertion, M&& message) {
+    if constexpr (index_assert_enabled) {
+        dynamic_assert(assertion, std::forward<M>(message));
+    }
+}
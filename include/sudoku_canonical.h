@@ -0,0 +1,65 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// canonical form of a sudoku under its symmetry group
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Symmetries that map valid sudokus (and their solutions) onto valid sudokus:
+//
+//   - relabelling of the digits
+//   - permutation of the rows within a band and of the bands (band: rows of one block)
+//   - permutation of the cols within a stack and of the stacks (stack: cols of one block)
+//   - transposition (only for square blocks, e.g. 4x4, 9x9, 16x16; for 6x6 it would
+//     turn 2x3 blocks into 3x2 blocks)
+//
+// The canonical form is the lexicographically smallest grid reachable by these
+// symmetries, read row by row (empty cells are smallest). Digits are relabelled in the
+// order of their first occurrence, which is the smallest relabelling for a given
+// arrangement of the cells; the arrangement is found by branch and bound, building the
+// grid row by row and dropping any partial arrangement larger than the best one found
+// so far. The order of the cols and stacks is not chosen up front but refined with each
+// row, so only ties between new digits lead to branching. All sudokus of one
+// equivalence class have the same canonical form.
+//
+// Cost: about 0.1 ms for a 9x9 puzzle on one core; use sudoku_canonicalize_all() to
+// spread a batch over all cores.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// maps sudoku s onto t: first transpose s (if transpose is set), then
+// t(i, j) = digit[s'(row[i], col[j])] (digit[0] == 0: empty cells stay empty)
+struct Sudoku_transform {
+    bool transpose{false};
+    std::vector<int> row;
+    std::vector<int> col;
+    std::vector<int> digit;
+};
+
+struct Sudoku_canonical {
+    std::string key;              // shape and canonical grid (see sudoku_canonical_key())
+    Sudoku_transform transform;   // maps s onto its canonical form
+};
+
+Sudoku_canonical sudoku_canonicalize(const Sudoku& s);
+
+// canonicalize all sudokus of v in parallel (threads 0: all cores)
+std::vector<Sudoku_canonical> sudoku_canonicalize_all(const std::vector<Sudoku>& v,
+                                                      int threads = 0);
+
+// string representation of s: "<region_size>:<blocks_per_row>:<blocks_per_col>:" and
+// one character per cell ('0' empty, '1'..'9', then 'A' for 10, 'B' for 11, ...), so
+// that keys of the same shape compare like the grids
+std::string sudoku_canonical_key(const Sudoku& s);
+
+Sudoku_transform sudoku_identity_transform(const Sudoku& s);
+Sudoku_transform sudoku_inverse_transform(const Sudoku_transform& tr);
+
+// apply tr to s (candidates are recomputed from the entries)
+Sudoku sudoku_apply_transform(const Sudoku& s, const Sudoku_transform& tr);
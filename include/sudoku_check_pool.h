@@ -0,0 +1,100 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include <algorithm>    // min()
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <iterator>    // make_move_iterator()
+#include <mutex>
+#include <thread>
+#include <utility>    // as_const(), move()
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// batches of independent checks on persistent worker threads
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Sudoku_check_pool starts its worker threads once and keeps them until it is
+// destroyed; a batch only wakes them up. The calling thread takes part in each batch,
+// so a pool of one thread has no workers and runs everything inline.
+//
+// sudoku_check_keep_first() is the "check a batch, keep the first" step of the
+// generator (removal checks, sudoku_generate.h) and of the minimizer (clue checks,
+// sudoku_minimize.h) on top of it:
+//
+//   - the next pending items, one per thread, are checked independently against the
+//     current state
+//   - the first item of the batch passing its check is kept (which changes the state)
+//   - items failing their check are dropped for good (callers only use this where a
+//     failing item keeps failing as the state changes further)
+//   - passing items after the kept one stay pending, to be checked again against the
+//     new state
+//
+// Items are kept in the same order as in a sequential run, so the result does not
+// depend on the no. of threads.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class Sudoku_check_pool {
+
+  public:
+    // pool of t_threads threads incl. the calling one (0: all cores)
+    explicit Sudoku_check_pool(int t_threads = 0);
+    ~Sudoku_check_pool();
+
+    Sudoku_check_pool(const Sudoku_check_pool&)            = delete;
+    Sudoku_check_pool& operator=(const Sudoku_check_pool&) = delete;
+
+    int threads() const { return m_threads; }
+
+    // call task(k) for k = 0..n-1, spread over the workers and the calling thread;
+    // returns when all calls are done (one batch at a time: not reentrant)
+    void run(int n, const std::function<void(int)>& task);
+
+  private:
+    void work();    // loop of a worker thread
+
+    int m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;    // new batch or stop
+    std::condition_variable m_done;    // all workers done with the batch
+    const std::function<void(int)>* m_task{nullptr};    // current batch
+    int m_num_tasks{0};
+    std::atomic<int> m_next{0};    // next task (handed out one by one)
+    int m_busy{0};                 // workers not done with the current batch
+    long m_batch{0};               // no. of the current batch
+    bool m_stop{false};
+    std::vector<std::thread> m_workers;
+};
+
+// one "check a batch, keep the first" step (see above) on pending: check(item) is called
+// in parallel and must only read the state, keep(item) is called for the first item
+// passing its check (on the calling thread, after all checks); returns the no. of
+// checks made
+template <typename T, typename Check, typename Keep>
+int sudoku_check_keep_first(Sudoku_check_pool& pool, std::vector<T>& pending,
+                            Check&& check, Keep&& keep) {
+
+    const int batch = std::min(pool.threads(), static_cast<int>(pending.size()));
+    std::vector<char> ok(batch, 0);
+    pool.run(batch, [&](int k) { ok[k] = check(std::as_const(pending[k])); });
+
+    std::vector<T> rest;
+    bool kept = false;
+    for (int k = 0; k < batch; ++k) {
+        if (!ok[k]) continue;
+        if (!kept) {
+            keep(std::as_const(pending[k]));
+            kept = true;
+        }
+        else {
+            rest.push_back(std::move(pending[k]));
+        }
+    }
+    rest.insert(rest.end(), std::make_move_iterator(pending.begin() + batch),
+                std::make_move_iterator(pending.end()));
+    pending = std::move(rest);
+    return batch;
+}
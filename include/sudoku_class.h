@@ -3,129 +3,259 @@
 
 #pragma once
 
-#include "dyn_assert.h"    // dynamic_assert()
+#include "dyn_assert.h"    // dynamic_assert(), index_assert()
 
+#include <algorithm>    // copy_n()
+#include <bit>          // popcount(), countr_zero()
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <set>
+#include <iterator>    // forward_iterator_tag
+#include <span>
 #include <string>
-#include <utility>    // pair<T,T>(), make_pair()
+#include <type_traits>    // is_trivial_v
+#include <utility>        // pair<T,T>(), make_pair()
 #include <vector>
 
 #include <fmt/format.h>    // friend access for printing
 
-struct Sudoku_cell {
-    Sudoku_cell(int t_cnt,             // cell number
-                int t_ri, int t_rj,    // row indizes
-                int t_ci, int t_cj,    // col indizes
-                int t_bi, int t_bj)    // block indizes
-        :
-        cnt(t_cnt),
-        ri(t_ri), rj(t_rj), ci(t_ci), cj(t_cj), bi(t_bi), bj(t_bj) {}
-
-    const int cnt;           // cell index of this cell within sudoku
-    const int ri;            // row index the cell belongs to
-    const int rj;            // index within the cell's row
-    const int ci;            // col index the cell belongs to
-    const int cj;            // index within the cell's col
-    const int bi;            // block index the cell belongs to
-    const int bj;            // index within the cell's block
-    int val{0};              // entry value 0: empty indicator; 1..N for set value
-    std::set<int> cand{};    // set of remaining candidates for this cell
-                             // (=remaining permissible entries)
+//
+// candidates of a cell, stored as bitmask (bit v-1 is set, if v is a candidate)
+//
+// Sudoku_candidates offers the subset of the std::set<int> interface the solvers use
+// (insert, erase, count, size, iteration in ascending order, ...) on top of the mask,
+// so a cell's candidates are a single word and can be combined with bit operations.
+//
+using cand_mask_t = std::uint32_t;
+
+class Sudoku_candidates {
+
+    cand_mask_t m_mask;
+
+  public:
+    // iterates over the values set in the mask in ascending order
+    class const_iterator {
+        cand_mask_t m_rest{0};
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = int;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const int*;
+        using reference         = int;
+
+        const_iterator() = default;
+        explicit const_iterator(cand_mask_t t_rest) : m_rest(t_rest) {}
+
+        int operator*() const { return std::countr_zero(m_rest) + 1; }
+        const_iterator& operator++() {
+            m_rest &= m_rest - 1;    // clear lowest bit
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+        bool operator==(const const_iterator&) const = default;
+    };
+    using iterator   = const_iterator;
+    using key_type   = int;    // print like std::set<int>
+    using value_type = int;
+
+    // trivial, like an int: no candidates if value-initialized (Sudoku_candidates{}),
+    // indeterminate if default-initialized
+    Sudoku_candidates() = default;
+    explicit Sudoku_candidates(cand_mask_t t_mask) : m_mask(t_mask) {}
+
+    static constexpr cand_mask_t bit(int value) { return cand_mask_t{1} << (value - 1); }
+
+    cand_mask_t mask() const { return m_mask; }
+
+    bool empty() const { return m_mask == 0; }
+    int size() const { return std::popcount(m_mask); }
+    int count(int value) const { return (m_mask & bit(value)) ? 1 : 0; }
+    bool contains(int value) const { return (m_mask & bit(value)) != 0; }
+
+    void insert(int value) { m_mask |= bit(value); }
+    int erase(int value) {    // returns no. of erased elements (like std::set)
+        int n = count(value);
+        m_mask &= ~bit(value);
+        return n;
+    }
+    void clear() { m_mask = 0; }
+
+    // keep only candidates contained in mask
+    Sudoku_candidates& operator&=(cand_mask_t t_mask) {
+        m_mask &= t_mask;
+        return *this;
+    }
+
+    const_iterator begin() const { return const_iterator(m_mask); }
+    const_iterator end() const { return const_iterator(); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    bool operator==(const Sudoku_candidates&) const = default;
 };
 
+static_assert(std::is_trivial_v<Sudoku_candidates>);
+
+//
+// Sudoku_cell: handle to the data of one cell
+//
+// The data of a Sudoku is stored as structure of arrays (values and candidates in
+// separate contiguous arrays, index information in the shared Sudoku_index_table).
+// Sudoku::operator() returns this lightweight handle, which refers to the value and
+// the candidates of the cell and carries its indices. The value is read-only in both
+// handles: it is written by Sudoku::set_value() only, which keeps the hash up to date.
+//
+template <typename V, typename C> struct Sudoku_cell_handle {
+    const int cnt;    // cell index of this cell within sudoku
+    const int ri;     // row index the cell belongs to
+    const int rj;     // index within the cell's row
+    const int ci;     // col index the cell belongs to
+    const int cj;     // index within the cell's col
+    const int bi;     // block index the cell belongs to
+    const int bj;     // index within the cell's block
+    V& val;           // entry value 0: empty indicator; 1..N for set value
+    C& cand;          // set of remaining candidates for this cell
+                      // (=remaining permissible entries)
+};
+
+using Sudoku_cell       = Sudoku_cell_handle<const std::uint8_t, Sudoku_candidates>;
+using Sudoku_const_cell = Sudoku_cell_handle<const std::uint8_t, const Sudoku_candidates>;
+
 //
 // interface class Sudoku
 //
 // Sudoku keeps track of data structure to represent a sudoku of arbitrary size
 //
 
-class Sudoku;    // forward declaration for access class
+// largest supported shape: 25x25 (values 1..25, see sudoku_line.h)
+//
+// Every Sudoku stores its cells inline for this shape, i.e. takes 5 bytes per cell of
+// it (3.1 KB for 25x25). Builds for smaller shapes only may lower the limit with
+// SUDOKU_MAX_REGION_SIZE (see CMakeLists.txt), e.g. 16 (1.3 KB) or 9 (0.4 KB).
+#if defined(SUDOKU_MAX_REGION_SIZE)
+inline constexpr int sudoku_max_region_size = SUDOKU_MAX_REGION_SIZE;
+#else
+inline constexpr int sudoku_max_region_size = 25;
+#endif
+static_assert(sudoku_max_region_size >= 4 && sudoku_max_region_size <= 25,
+              "SUDOKU_MAX_REGION_SIZE must be in 4..25 (candidates of a cell: 32 bit)");
+inline constexpr int sudoku_max_cells = sudoku_max_region_size * sudoku_max_region_size;
 
 enum class Region_t { row, col, block };    // region types
 
-// access classes of Sudoku for various access schemes (row, col, block)
-class Region_access {
-
-    friend class fmt::formatter<Region_access>;    // allow printing of private members
+//
+// index lookup tables for one Sudoku layout
+//
+// All index conversions (region index & index within region <-> cell index) are
+// computed once per layout and shared by all Sudoku instances of that layout.
+// Tables are flat; the region type is the outermost index (row = 0, col = 1, block = 2).
+//
+struct Sudoku_index_table {
+    int region_size;
+    int blocks_per_row;
+    int blocks_per_col;
+    int total_size;
 
-    Sudoku* const m_s;          // const pointer to non-const Sudoku instance (non-owning)
-    const Region_t m_region;    // region type for this instance
-    std::vector<std::vector<Sudoku_cell*>> m_rv;    // region vectors (row/col/block)
+    // [(region*region_size + i)*region_size + j] -> cnt
+    // (i... region index, j... index within region)
+    std::vector<int> region_cnt;
+    // [region*total_size + cnt] -> region index i of cell cnt
+    std::vector<int> cnt_region;
+    // [region*total_size + cnt] -> index j of cell cnt within its region
+    std::vector<int> cnt_index;
+    // [cnt*(region_size + 1) + v] -> random Zobrist key of value v in cell cnt
+    // (v = 0, i.e. empty: key 0; keys are the same in every run)
+    std::vector<std::uint64_t> zobrist;
 
-  public:
-    Region_access(Sudoku& t_sref, const Region_t t_region);
-
-    // to be called AFTER Sudoku entries are set up in Sudoku constructor
-    // in order to set up access references depending on region type
-    void init_access();
-
-    // access to region(i)
-    std::vector<Sudoku_cell*>& operator()(int i);
-    const std::vector<Sudoku_cell*>& operator()(int i) const;
-    // element access at region(i,j)
-    Sudoku_cell& operator()(int i, int j);
-    const Sudoku_cell& operator()(int i, int j) const;
-
-    // iterator access to region
-    using iterator       = std::vector<std::vector<Sudoku_cell*>>::iterator;
-    using const_iterator = std::vector<std::vector<Sudoku_cell*>>::const_iterator;
-    iterator begin() { return m_rv.begin(); }
-    iterator end() { return m_rv.end(); }
-    const_iterator cbegin() const { return m_rv.begin(); }
-    const_iterator cend() const { return m_rv.end(); }
+    // tables for the requested layout (built on first request, then cached;
+    // returned references stay valid for the lifetime of the program)
+    static const Sudoku_index_table& get(int t_region_size, int t_blocks_per_row,
+                                         int t_blocks_per_col);
 };
 
 class Sudoku {
 
-    friend class Region_access;             // allow access to regions
     friend class fmt::formatter<Sudoku>;    // allow printing of private members
 
-    std::vector<Sudoku_cell> m_cell;    // contains Sudoku entries
+    // mutable state of the Sudoku (structure of arrays)
+    //
+    // The arrays are stored inline with the capacity of the largest shape, so creating
+    // or copying a Sudoku does not allocate. Only the first total_size elements are
+    // used: constructors and assignments initialize and copy just these (the rest is
+    // left uninitialized, so a 9x9 copy moves 0.4 KB, not the 3.1 KB of the arrays).
+    std::uint8_t m_val[sudoku_max_cells];          // entry values (0: empty)
+    Sudoku_candidates m_cand[sudoku_max_cells];    // candidates of each cell
+    const Sudoku_index_table* m_idx;    // index lookup tables (shared, non-owning)
+    std::uint64_t m_hash{0};            // Zobrist hash of m_val (see hash())
 
   public:
-    const int region_size;       // no. of cells per region (= row / col / block)
-    const int blocks_per_row;    // no. of blocks in "x-direction"
-    const int blocks_per_col;    // no. of blocks in "y-direction"
-    const int total_size;        // total size of sudoku = region_size*region_size
-
-    // provide cell access in various forms for regions
-    // (all addressing the same memory)
-    Region_access row;
-    Region_access col;
-    Region_access block;
+    // layout (set by the constructor; copies and assignments take it along)
+    int region_size;       // no. of cells per region (= row / col / block)
+    int blocks_per_row;    // no. of blocks in "x-direction"
+    int blocks_per_col;    // no. of blocks in "y-direction"
+    int total_size;        // total size of sudoku = region_size*region_size
 
     // constructors
     Sudoku(int t_region_size, int t_blocks_per_row, int t_blocks_per_col);
 
-    // copy
-    Sudoku(const Sudoku& other_Sudoku);
-    // copy assignment
-    Sudoku& operator=(const Sudoku& other_Sudoku);
-    // move
-    Sudoku(Sudoku&& other_Sudoku) noexcept;
-    // move assignment
-    Sudoku& operator=(Sudoku&& other_Sudoku) noexcept;
+    // copies of the used cells only (moves are copies, too: the state is inline)
+    Sudoku(const Sudoku& other);
+    Sudoku& operator=(const Sudoku& other);
 
     // element access
-    Sudoku_cell& operator()(int cnt);
-    const Sudoku_cell& operator()(int cnt) const;
-    Sudoku_cell& operator()(int i, int j);
-    const Sudoku_cell& operator()(int i, int j) const;
-
-    // iterator access to Sudoku_cell (delegate to vector<Sudoku_cell> m_cell)
-    using iterator       = std::vector<Sudoku_cell>::iterator;
-    using const_iterator = std::vector<Sudoku_cell>::const_iterator;
-    iterator begin() { return m_cell.begin(); }
-    iterator end() { return m_cell.end(); }
-    const_iterator cbegin() const { return m_cell.begin(); }
-    const_iterator cend() const { return m_cell.end(); }
+    Sudoku_cell operator()(int cnt);
+    Sudoku_const_cell operator()(int cnt) const;
+    Sudoku_cell operator()(int i, int j);
+    Sudoku_const_cell operator()(int i, int j) const;
+
+    // cell access in various forms for regions (all addressing the same memory):
+    // cell indices (cnt) of region i, element access at (i, j) within region i
+    std::span<const int> row(int i) const { return region_cells(Region_t::row, i); }
+    std::span<const int> col(int i) const { return region_cells(Region_t::col, i); }
+    std::span<const int> block(int i) const { return region_cells(Region_t::block, i); }
+    Sudoku_cell row(int i, int j) { return region(Region_t::row, i, j); }
+    Sudoku_cell col(int i, int j) { return region(Region_t::col, i, j); }
+    Sudoku_cell block(int i, int j) { return region(Region_t::block, i, j); }
+    Sudoku_const_cell row(int i, int j) const { return region(Region_t::row, i, j); }
+    Sudoku_const_cell col(int i, int j) const { return region(Region_t::col, i, j); }
+    Sudoku_const_cell block(int i, int j) const { return region(Region_t::block, i, j); }
+    Sudoku_cell region(const Region_t region, int i, int j);
+    Sudoku_const_cell region(const Region_t region, int i, int j) const;
+
+    // direct access to the contiguous state arrays (size total_size each)
+    std::uint8_t* values() { return m_val; }
+    const std::uint8_t* values() const { return m_val; }
+    Sudoku_candidates* candidates() { return m_cand; }
+    const Sudoku_candidates* candidates() const { return m_cand; }
+
+    // index lookup tables of this layout
+    const Sudoku_index_table& index_table() const { return *m_idx; }
+
+    // Zobrist hash of the values (xor of the keys of all cells, see Sudoku_index_table)
+    //
+    // set_value() keeps the hash up to date in O(1); copies and moves take it along,
+    // so restoring a saved copy restores the hash, too. Values written directly via
+    // values() are not tracked: call rehash() after such writes.
+    // Candidates do not enter the hash (they follow from the values in all solvers).
+    void set_value(int cnt, int value);
+    std::uint64_t hash() const { return m_hash; }
+    std::uint64_t compute_hash() const;    // full recompute from the values
+    void rehash() { m_hash = compute_hash(); }
+    // verify the hash against a full recompute (debug builds, see index_assert())
+    void check_hash() const;
 
     // access by index (this is where the mapping happens)
     int row_to_cnt(int i, int j) const;
     int col_to_cnt(int i, int j) const;
     int block_to_cnt(int i, int j) const;
     int region_to_cnt(const Region_t region, int i, int j) const;
+    // cell indices of region(i)
+    std::span<const int> region_cells(const Region_t region, int i) const;
 
     std::pair<int, int> cnt_to_row(int cnt) const;
     std::pair<int, int> cnt_to_col(int cnt) const;
@@ -138,4 +268,215 @@ class Sudoku {
     bool is_valid_index(int cnt) const;
     bool is_valid_region_index(int i) const;
     bool is_valid_region_index(int i, int j) const;
+
+  private:
+    template <typename Cell, typename S> static Cell make_cell(S& s, int cnt);
 };
+
+//
+// element access and index conversions
+//
+// (defined inline, since they are called in the innermost loops of all solvers;
+// bounds are checked by index_assert(), see dyn_assert.h for the checking policy)
+//
+
+template <typename Cell, typename S> inline Cell Sudoku::make_cell(S& s, int cnt) {
+    const Sudoku_index_table& t = *s.m_idx;
+    const int n                 = s.total_size;
+
+    return Cell{cnt,
+                t.cnt_region[cnt],
+                t.cnt_index[cnt],
+                t.cnt_region[n + cnt],
+                t.cnt_index[n + cnt],
+                t.cnt_region[2 * n + cnt],
+                t.cnt_index[2 * n + cnt],
+                s.m_val[cnt],
+                s.m_cand[cnt]};
+}
+
+inline Sudoku::Sudoku(const Sudoku& other) :
+    m_idx(other.m_idx), m_hash(other.m_hash), region_size(other.region_size),
+    blocks_per_row(other.blocks_per_row), blocks_per_col(other.blocks_per_col),
+    total_size(other.total_size) {
+    std::copy_n(other.m_val, total_size, m_val);
+    std::copy_n(other.m_cand, total_size, m_cand);
+}
+
+inline Sudoku& Sudoku::operator=(const Sudoku& other) {
+    if (this != &other) {
+        // the layout is copied along (assigning a Sudoku of another shape is fine)
+        m_idx          = other.m_idx;
+        m_hash         = other.m_hash;
+        region_size    = other.region_size;
+        blocks_per_row = other.blocks_per_row;
+        blocks_per_col = other.blocks_per_col;
+        total_size     = other.total_size;
+        std::copy_n(other.m_val, total_size, m_val);
+        std::copy_n(other.m_cand, total_size, m_cand);
+    }
+    return *this;
+}
+
+inline void Sudoku::set_value(int cnt, int value) {
+    index_assert(is_valid_index(cnt), "Index out of range.");
+    index_assert(value >= 0 && value <= region_size, "Value out of range.");
+
+    const std::uint64_t* key = m_idx->zobrist.data() + cnt * (region_size + 1);
+    m_hash ^= key[m_val[cnt]] ^ key[value];
+    m_val[cnt] = static_cast<std::uint8_t>(value);
+}
+
+inline void Sudoku::check_hash() const {
+    if constexpr (index_assert_enabled) {
+        index_assert(m_hash == compute_hash(), "Zobrist hash out of date.");
+    }
+}
+
+inline Sudoku_cell Sudoku::operator()(int cnt) {
+    index_assert(is_valid_index(cnt), "Index out of range.");
+
+    return make_cell<Sudoku_cell>(*this, cnt);
+}
+
+inline Sudoku_const_cell Sudoku::operator()(int cnt) const {
+    index_assert(is_valid_index(cnt), "Index out of range.");
+
+    return make_cell<Sudoku_const_cell>(*this, cnt);
+}
+
+inline Sudoku_cell Sudoku::operator()(int i, int j) {
+    index_assert(is_valid_region_index(i, j), "Index out of range.");
+
+    // use row conversion for 2D array mem_order
+    return make_cell<Sudoku_cell>(*this, row_to_cnt(i, j));
+}
+
+inline Sudoku_const_cell Sudoku::operator()(int i, int j) const {
+    index_assert(is_valid_region_index(i, j), "Index out of range.");
+
+    // use row conversion for 2D array mem_order
+    return make_cell<Sudoku_const_cell>(*this, row_to_cnt(i, j));
+}
+
+inline Sudoku_cell Sudoku::region(const Region_t region, int i, int j) {
+    // i... region index
+    // j... index within region
+    return (*this)(region_to_cnt(region, i, j));
+}
+
+inline Sudoku_const_cell Sudoku::region(const Region_t region, int i, int j) const {
+    // i... region index
+    // j... index within region
+    return (*this)(region_to_cnt(region, i, j));
+}
+
+inline int Sudoku::row_to_cnt(int i, int j) const {
+    // i... row index
+    // j... index within row
+
+    return m_idx->region_cnt[i * region_size + j];
+}
+
+inline int Sudoku::col_to_cnt(int i, int j) const {
+    // i... col index
+    // j... index within col
+
+    return m_idx->region_cnt[(region_size + i) * region_size + j];
+}
+
+inline int Sudoku::block_to_cnt(int i, int j) const {
+    // i... block index
+    // j... index within block
+    //
+    // row_in_block = j/cols_per_block
+    // col_in_block = j%cols_per_block
+    //
+    // row = row_in_block + rows_per_block * (i / blocks_per_row)
+    // col = col_in_block + cols_per_block * (i % blocks_per_row)
+    //
+    // cnt = col + row*region_size
+    //
+    // (precomputed in Sudoku_index_table::get())
+
+    return m_idx->region_cnt[(2 * region_size + i) * region_size + j];
+}
+
+inline int Sudoku::region_to_cnt(Region_t region, int i, int j) const {
+    // i... region index
+    // j... index within region
+    index_assert(is_valid_region_index(i, j), "Index out of range.");
+
+    return m_idx->region_cnt[(static_cast<int>(region) * region_size + i) * region_size +
+                             j];
+}
+
+inline std::span<const int> Sudoku::region_cells(const Region_t region, int i) const {
+    index_assert(is_valid_region_index(i), "Index out of range.");
+
+    const int offset = (static_cast<int>(region) * region_size + i) * region_size;
+    return std::span<const int>(m_idx->region_cnt.data() + offset, region_size);
+}
+
+inline std::pair<int, int> Sudoku::cnt_to_row(int cnt) const {
+    // first = row index = cnt/region_size
+    // second= col index = cnt%region_size
+
+    return std::make_pair(m_idx->cnt_region[cnt], m_idx->cnt_index[cnt]);
+}
+
+inline std::pair<int, int> Sudoku::cnt_to_col(int cnt) const {
+    // first = col index = cnt%region_size
+    // second= row index = cnt/region_size
+
+    return std::make_pair(m_idx->cnt_region[total_size + cnt],
+                          m_idx->cnt_index[total_size + cnt]);
+}
+
+inline std::pair<int, int> Sudoku::cnt_to_block(int cnt) const {
+    // first = block index
+    // second= index in block
+    //
+    // row = cnt/region_size
+    // col = cnt%region_size
+    //
+    // rows_per_block = region_size/blocks_per_col
+    // cols_per_block = region_size/blocks_per_row
+    //
+    // 1st index:
+    //
+    // block index = col/cols_per_block + (row/rows_per_block)*blocks_per_row
+    // row_in_block = row % rows_per_block
+    // col_in_block = col % cols_per_block
+    //
+    // 2nd index:
+    //
+    // index in block = col_in_block + row_in_block*cols_per_block
+    //
+    // (precomputed in Sudoku_index_table::get())
+
+    return std::make_pair(m_idx->cnt_region[2 * total_size + cnt],
+                          m_idx->cnt_index[2 * total_size + cnt]);
+}
+
+inline std::pair<int, int> Sudoku::cnt_to_region(const Region_t region, int cnt) const {
+    index_assert(is_valid_index(cnt), "Index out of range.");
+
+    int offset = static_cast<int>(region) * total_size + cnt;
+
+    return std::make_pair(m_idx->cnt_region[offset], m_idx->cnt_index[offset]);
+}
+
+inline bool Sudoku::is_valid_index(int cnt) const {
+    return ((cnt >= 0) && (cnt < total_size));
+}
+
+inline bool Sudoku::is_valid_region_index(int i) const {
+
+    return ((i >= 0) && (i < region_size));
+}
+
+inline bool Sudoku::is_valid_region_index(int i, int j) const {
+
+    return ((i >= 0) && (i < region_size) && (j >= 0) && (j < region_size));
+}
@@ -0,0 +1,17 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// replacing small files atomically (checkpoints, solution cache, metrics)
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// replace the file at path by one holding data, atomically: written to a temporary
+// file, which is renamed to path (a crash leaves either the old or the new file); on
+// POSIX systems durably as well: fsync of the file before, of the directory after the
+// rename; returns false on i/o errors
+bool sudoku_replace_file(const std::string& path, std::string_view data);
@@ -0,0 +1,92 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+#include "sudoku_rate.h"
+#include "sudoku_solve.h"
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <random>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// puzzle generator
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// A puzzle is generated in two steps:
+//
+// 1. a random full solution is built by a depth first search with randomized value
+//    order (branching on the empty cell with the fewest candidates)
+//
+// 2. clues are removed in random order, single cells or groups of cells forming a
+//    symmetric pattern. A removal is kept, if the puzzle still has a unique solution
+//    (sudoku_count_solutions() with limit 2) and meets the difficulty limits (rated
+//    by sudoku_rate()).
+//
+// The removal checks run in parallel batches on a pool of threads kept for the whole
+// call (see sudoku_check_keep_first() in sudoku_check_pool.h): the first removal of a
+// batch passing its check is kept, so the puzzle depends on the seed only, not on the
+// threads. A removal failing its check is dropped for good: removing even more clues
+// can't make the solution unique again.
+//
+// Supported shapes: all shapes of class Sudoku (e.g. 4x4, 6x6 with 2x3 or 3x2 blocks,
+// 9x9, 16x16); the uniqueness checks use the specialized solvers where available.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+enum class Sudoku_symmetry_t {
+    none,          // cells removed one by one (asymmetric pattern)
+    rotational,    // cell and its image under rotation by 180 degrees
+    mirror         // cell and its mirror image (left/right)
+};
+
+struct Sudoku_generate_options {
+    Sudoku_symmetry_t symmetry{Sudoku_symmetry_t::rotational};
+
+    // stop removing clues as soon as the puzzle has target_clues clues or less
+    // (0: remove as many clues as possible); an attempt not reaching target_clues is
+    // repeated with a new solution
+    int target_clues{0};
+
+    // difficulty (see sudoku_rate.h): the puzzle must be solvable by logic techniques up
+    // to max_technique (enum_count: no limit, search may be required) and must need at
+    // least min_technique; with a tier, removals making the puzzle harder than the tier
+    // are rejected. min_technique and the tier are checked after all removals, an
+    // attempt failing them is repeated.
+    Sudoku_solution_t max_technique{Sudoku_solution_t::enum_count};
+    Sudoku_solution_t min_technique{Sudoku_solution_t::naked_single};
+    std::optional<Sudoku_tier_t> tier;
+
+    int max_attempts{16};       // solutions tried before giving up
+    int threads{0};             // threads for the removal checks (0: all cores)
+    std::uint64_t seed{0};      // same seed and options: same puzzle
+};
+
+struct Sudoku_generate_stats {
+    long attempts{0};    // full solutions generated
+    long checks{0};      // removal checks (uniqueness and difficulty)
+    long removals{0};    // removals kept
+    long batches{0};     // batches of parallel checks
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// random full solution of the given shape
+//////////////////////////////////////////////////////////////////////////////////////////
+Sudoku sudoku_generate_solution(int region_size, int blocks_per_row, int blocks_per_col,
+                                std::mt19937_64& rng);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// generate a puzzle with a unique solution (candidates are up to date)
+// returns an empty optional if no attempt met target_clues and the difficulty limits
+//////////////////////////////////////////////////////////////////////////////////////////
+std::optional<Sudoku> sudoku_generate(int region_size, int blocks_per_row,
+                                      int blocks_per_col,
+                                      const Sudoku_generate_options& opt,
+                                      Sudoku_generate_stats& stats);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// write s in the format of the input files (see input/sudoku.in)
+//////////////////////////////////////////////////////////////////////////////////////////
+void sudoku_write(std::ostream& os, const Sudoku& s);
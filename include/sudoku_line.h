@@ -0,0 +1,31 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// one-line text format of a sudoku (for corpora, pipes and the solve service)
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// One character per cell, row by row: '0' or '.' for an empty cell, '1'..'9' for the
+// values 1..9, 'A'..'P' (or 'a'..'p') for the values 10..25. The shape follows from
+// the no. of cells (16: 4x4, 36: 6x6 with 2x3 blocks, 81: 9x9, 256: 16x16, 625:
+// 25x25), or is given by an optional prefix "<region_size>:<blocks_per_row>:
+// <blocks_per_col>:" as in sudoku_canonical_key(), e.g. "6:3:2:..." for 6x6 sudokus
+// with 3x2 blocks.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// sudoku of line (candidates are up to date), or an empty optional if line is not a
+// sudoku in this format (trailing '\r' and blanks are ignored)
+std::optional<Sudoku> sudoku_from_line(std::string_view line);
+
+// append s in this format to out (with prefix only if the shape is not the default one
+// for its no. of cells), no line end
+void sudoku_append_line(std::string& out, const Sudoku& s);
+std::string sudoku_to_line(const Sudoku& s);
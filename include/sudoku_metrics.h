@@ -0,0 +1,134 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_solve.h"    // Sudoku_engine_t
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solve latency histogram and throughput metrics (batch and service runs)
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Sudoku_latency_histogram buckets latencies (in ns) logarithmically as HDR histograms
+// do: values below 32 exactly, above in 32 sub-buckets per power of two, i.e. with a
+// relative error of at most 1/32 (3%) over the whole range of uint64. Recording is a
+// relaxed atomic increment, so any no. of threads can record without a lock; reading
+// takes a snapshot, which is exact once the recording threads are done and otherwise
+// off by at most the records in progress.
+//
+// Sudoku_metrics keeps one histogram per engine. Reports are text for humans (puzzles/s,
+// p50/p90/p99/p999/max per engine and over all) and the Prometheus text exposition
+// format, written to a file atomically (for a textfile collector or a local scraper).
+// Sudoku_metrics_reporter writes both periodically on a thread and once more at stop().
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// no. of values of Sudoku_engine_t: the last one + 1
+inline constexpr int sudoku_num_engines =
+    static_cast<int>(Sudoku_engine_t::batch) + 1;
+const char* sudoku_engine_name(Sudoku_engine_t engine);
+
+// plain copy of a histogram
+struct Sudoku_latency_snapshot {
+    std::vector<std::uint64_t> counts;    // per bucket
+    std::uint64_t count{0};
+    std::uint64_t sum_ns{0};
+    std::uint64_t max_ns{0};
+
+    // latency in ns below which a fraction q of the records lies (0 if empty)
+    std::uint64_t percentile(double q) const;
+    double mean_ns() const { return count > 0 ? double(sum_ns) / double(count) : 0.0; }
+
+    void merge(const Sudoku_latency_snapshot& other);
+};
+
+class Sudoku_latency_histogram {
+
+  public:
+    static constexpr int sub_bucket_bits = 5;
+    static constexpr int sub_buckets     = 1 << sub_bucket_bits;
+    static constexpr int num_buckets     = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+    void record(std::uint64_t ns);
+    Sudoku_latency_snapshot snapshot() const;
+
+    static int bucket_of(std::uint64_t ns);
+    // largest value of bucket b (all its values are reported as this one)
+    static std::uint64_t bucket_max(int b);
+
+  private:
+    std::array<std::atomic<std::uint64_t>, num_buckets> m_counts{};
+    std::atomic<std::uint64_t> m_count{0};
+    std::atomic<std::uint64_t> m_sum_ns{0};
+    std::atomic<std::uint64_t> m_max_ns{0};
+};
+
+class Sudoku_metrics {
+
+  public:
+    Sudoku_metrics();
+
+    void record(Sudoku_engine_t engine, std::chrono::nanoseconds latency) {
+        m_hist[static_cast<int>(engine)].record(
+            static_cast<std::uint64_t>(latency.count() > 0 ? latency.count() : 0));
+    }
+
+    // report over all records since construction
+    void print(std::ostream& os) const;
+    // the same in the Prometheus text format (metric names start with sudoku_)
+    std::string prometheus_text() const;
+    // replace the file at path by prometheus_text() (see sudoku_replace_file())
+    bool write_prometheus(const std::string& path) const;
+
+    // one line: puzzles & puzzles/s since the previous call, percentiles over all
+    void print_interval(std::ostream& os);
+
+  private:
+    std::array<Sudoku_latency_histogram, sudoku_num_engines> m_hist;
+    const std::chrono::steady_clock::time_point m_start;
+
+    std::mutex m_interval_mutex;    // state of print_interval()
+    std::chrono::steady_clock::time_point m_interval_start;
+    std::uint64_t m_interval_count{0};
+};
+
+class Sudoku_metrics_reporter {
+
+  public:
+    // every interval: print_interval() to os and, if path is not empty, write the
+    // Prometheus file
+    Sudoku_metrics_reporter(Sudoku_metrics& t_metrics, std::ostream& t_os,
+                            std::string t_path, std::chrono::milliseconds t_interval);
+    ~Sudoku_metrics_reporter();    // stops the reporter
+
+    Sudoku_metrics_reporter(const Sudoku_metrics_reporter&)            = delete;
+    Sudoku_metrics_reporter& operator=(const Sudoku_metrics_reporter&) = delete;
+
+    // stop the thread, then print the full report and write the file a last time;
+    // returns false if writing the file failed
+    bool stop();
+
+  private:
+    void run();
+
+    Sudoku_metrics& m_metrics;
+    std::ostream& m_os;
+    const std::string m_path;
+    const std::chrono::milliseconds m_interval;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop{false};
+    bool m_write_ok{true};
+    std::thread m_thread;
+};
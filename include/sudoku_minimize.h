@@ -0,0 +1,61 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// reduce a puzzle to a minimal puzzle
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// A puzzle is minimal, if removing any of its clues makes the solution ambiguous. The
+// clues are tried one after the other (in cell order, or in random order with
+// opt.shuffle); a clue is removed, if the solution stays unique.
+//
+// Uniqueness check: the solution S of the puzzle is known. After removing clue c, any
+// other solution T must have T(c) != S(c) (otherwise T would solve the original puzzle
+// as well). So the check only searches for a solution with S(c) removed from the
+// candidates of c and stops at the first one, instead of counting to two solutions.
+//
+// The checks run in parallel batches on a pool of threads kept for the whole call (see
+// sudoku_check_keep_first() in sudoku_check_pool.h): the first clue of a batch found
+// redundant is removed. A clue found necessary stays necessary when more clues are
+// removed, so it is never checked again.
+//
+// For many puzzles sudoku_minimize_all() is faster: it spreads the puzzles over the
+// threads instead of the checks of one puzzle (no synchronization per batch).
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct Sudoku_minimize_options {
+    bool shuffle{false};       // try the clues in random order (else in cell order)
+    std::uint64_t seed{0};     // for shuffle
+    int threads{0};            // threads for the checks (0: all cores)
+};
+
+struct Sudoku_minimize_stats {
+    long checks{0};      // uniqueness checks
+    long removals{0};    // clues removed
+    long batches{0};     // batches of parallel checks
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// minimal puzzle with the same solution as s (a subset of the clues of s, candidates up
+// to date); returns an empty optional if s does not have a unique solution
+//////////////////////////////////////////////////////////////////////////////////////////
+std::optional<Sudoku> sudoku_minimize(const Sudoku& s, const Sudoku_minimize_options& opt,
+                                      Sudoku_minimize_stats& stats);
+
+// minimize all sudokus of v in parallel, one per thread at a time (opt.threads; the
+// result of each is the one of sudoku_minimize())
+std::vector<std::optional<Sudoku>> sudoku_minimize_all(const std::vector<Sudoku>& v,
+                                                       const Sudoku_minimize_options& opt,
+                                                       Sudoku_minimize_stats& stats);
+
+// true if no clue of s can be removed without losing uniqueness
+// (pre-condition: s has a unique solution)
+bool sudoku_is_minimal(const Sudoku& s);
@@ -41,13 +41,13 @@ void print_list_list_int(const std::list<std::list<int>>& ll);
 //
 // extend fmt to print my types
 //
-template <> struct fmt::formatter<Sudoku_cell> {
+template <typename V, typename C> struct fmt::formatter<Sudoku_cell_handle<V, C>> {
     template <typename ParseContext> constexpr auto parse(ParseContext& ctx) {
         return ctx.begin();
     }
 
     template <typename FormatContext>
-    auto format(const Sudoku_cell& c, FormatContext& ctx) {
+    auto format(const Sudoku_cell_handle<V, C>& c, FormatContext& ctx) {
         // ctx.out() is an output iterator to write to.
         auto out = ctx.out();
 
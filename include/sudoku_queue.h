@@ -0,0 +1,81 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>    // size_t
+#include <deque>
+#include <mutex>
+#include <utility>    // move()
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// bounded blocking queue (multiple producers, multiple consumers)
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// push() blocks while the queue is full, so a producer faster than its consumers is
+// slowed down to their pace (backpressure) instead of growing the queue without bound.
+// Consumers take items in batches of up to max_items to amortize the locking.
+//
+// close() wakes everybody up: push() fails from then on, pop_batch() returns the items
+// still queued and then 0.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T> class Sudoku_bounded_queue {
+
+  public:
+    explicit Sudoku_bounded_queue(std::size_t t_capacity) :
+        m_capacity(t_capacity > 0 ? t_capacity : 1) {}
+
+    // append item, waiting for free space; returns false if the queue is closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_full.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+        if (m_closed) return false;
+        m_items.push_back(std::move(item));
+        lock.unlock();
+        m_not_empty.notify_one();
+        return true;
+    }
+
+    // move up to max_items items to the end of out, waiting for at least one; returns
+    // the no. of items moved (0: queue closed and empty)
+    std::size_t pop_batch(std::vector<T>& out, std::size_t max_items) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_empty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+        std::size_t n = 0;
+        while (n < max_items && !m_items.empty()) {
+            out.push_back(std::move(m_items.front()));
+            m_items.pop_front();
+            ++n;
+        }
+        lock.unlock();
+        if (n > 0) m_not_full.notify_all();
+        return n;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_not_full.notify_all();
+        m_not_empty.notify_all();
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_items.size();
+    }
+
+    std::size_t capacity() const { return m_capacity; }
+
+  private:
+    const std::size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_not_full;
+    std::condition_variable m_not_empty;
+    std::deque<T> m_items;
+    bool m_closed{false};
+};
@@ -0,0 +1,57 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+#include "sudoku_solve.h"
+
+#include <array>
+#include <string_view>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// difficulty rating from a technique trace
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// The puzzle is solved with the logic techniques only, always applying the simplest
+// technique that makes progress (in the order of Sudoku_solution_t), until it is solved
+// or no technique helps any more. The trace records how often each technique was
+// needed and how many steps (technique passes) it took.
+//
+// The rater works on flat candidate masks of its own (candidates are derived from the
+// entries of s), so it is cheap enough to run inside the generator loop: about 20 us
+// for a generated (minimal) 9x9 puzzle in a Release build, about 70 us in a Debug
+// build; 1 to 12 us for the 9x9 puzzles in input/, which have more clues.
+//
+// Score: weighted sum of the technique applications (harder techniques weigh more),
+// plus 10 per step after the first (long chains of dependent steps are harder than
+// many independent ones) plus 20 per cell left empty when the techniques got stuck
+// (these cells need search).
+//
+// Tier by score (thresholds for 9x9, scaled with the region size for other shapes):
+//
+//   einsteiger  < 30      few empty cells, solved in about one pass
+//   einfach     < 60
+//   mittel      < 300     solved by logic, may need subsets (twins, triples, ...)
+//   standard    < 1000    logic gets stuck, search needed for the remaining cells
+//   hardest               logic gets stuck early
+//////////////////////////////////////////////////////////////////////////////////////////
+
+enum class Sudoku_tier_t { einsteiger, einfach, mittel, standard, hardest };
+
+struct Sudoku_rating {
+    bool solved{false};    // solved by logic techniques alone
+    bool valid{true};      // false: contradiction found (no solution)
+    // hardest technique applied (enum_count: not solved by logic, search needed)
+    Sudoku_solution_t hardest{Sudoku_solution_t::naked_single};
+    std::array<int, Sudoku_solution_t::enum_count> count{};    // applications
+    int steps{0};        // technique passes that made progress
+    int remaining{0};    // empty cells left when the techniques got stuck
+    int score{0};
+    Sudoku_tier_t tier{Sudoku_tier_t::einsteiger};
+};
+
+Sudoku_rating sudoku_rate(const Sudoku& s);
+
+// name of the tier (as used in the names of the input files)
+std::string_view sudoku_tier_name(Sudoku_tier_t tier);
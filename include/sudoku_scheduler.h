@@ -0,0 +1,184 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include <algorithm>    // push_heap(), pop_heap()
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>    // size_t
+#include <cstdint>
+#include <mutex>
+#include <utility>    // move()
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// job scheduler with priority classes and deadlines (multiple producers and consumers)
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Jobs are queued per priority class. Within a class they are dispatched earliest
+// deadline first (jobs without deadline last, in the order of arrival). Interactive jobs
+// go before batch jobs; to keep batch jobs from starving completely, one batch job is
+// dispatched after interactive_burst interactive jobs in a row while batch jobs wait
+// (interactive_burst 0: strict priority).
+//
+// pop_batch() hands out interactive jobs in batches, but a batch job ends the batch:
+// batch jobs are taken one at a time, so a worker busy with them looks at the
+// interactive jobs again after each one instead of holding back a batch of jobs it
+// hasn't started yet.
+//
+// Each class has its own capacity: push() blocks while the class of the job is full
+// (backpressure), so a flood of batch jobs never keeps interactive jobs out of the
+// queue. Jobs found past their deadline at dispatch are not run but handed back
+// separately, so the caller can tell their clients.
+//
+// close() wakes everybody up: push() fails from then on, pop_batch() returns the jobs
+// still queued and then 0.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+enum class Sudoku_priority_t { interactive, batch };
+inline constexpr int sudoku_num_priorities = 2;
+
+struct Sudoku_scheduler_class_stats {
+    long queued{0};        // jobs pushed
+    long dispatched{0};    // jobs handed out to run
+    long expired{0};       // jobs dropped, because their deadline had passed
+    double wait_us_sum{0.0};    // time in queue of the jobs dispatched
+    long wait_us_max{0};
+
+    double wait_us_mean() const {
+        return dispatched > 0 ? wait_us_sum / static_cast<double>(dispatched) : 0.0;
+    }
+};
+
+struct Sudoku_scheduler_stats {
+    // indexed by Sudoku_priority_t
+    std::array<Sudoku_scheduler_class_stats, sudoku_num_priorities> cls;
+};
+
+template <typename T> class Sudoku_scheduler {
+
+  public:
+    using clock      = std::chrono::steady_clock;
+    using time_point = clock::time_point;
+    static constexpr time_point no_deadline = time_point::max();
+
+    explicit Sudoku_scheduler(std::size_t t_capacity, int t_interactive_burst = 16) :
+        m_capacity(t_capacity > 0 ? t_capacity : 1),
+        m_interactive_burst(t_interactive_burst) {}
+
+    // queue item, waiting for free space in its class; returns false if closed
+    bool push(T item, Sudoku_priority_t prio, time_point deadline = no_deadline) {
+        const int c = static_cast<int>(prio);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_full[c].wait(lock,
+                           [&] { return m_closed || m_heap[c].size() < m_capacity; });
+        if (m_closed) return false;
+        m_heap[c].push_back(Entry{deadline, m_seq++, clock::now(), std::move(item)});
+        std::push_heap(m_heap[c].begin(), m_heap[c].end(), later);
+        ++m_stats.cls[c].queued;
+        lock.unlock();
+        m_not_empty.notify_one();
+        return true;
+    }
+
+    // move up to max_items jobs in dispatch order to the end of out, waiting for at
+    // least one job; a batch job is the last one moved; jobs past their deadline are
+    // moved to expired instead (and don't count against max_items); returns the no. of
+    // jobs moved to out or expired (0: closed and empty)
+    std::size_t pop_batch(std::vector<T>& out, std::size_t max_items,
+                          std::vector<T>& expired) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_empty.wait(lock, [this] { return m_closed || num_queued() > 0; });
+
+        const time_point now = clock::now();
+        std::size_t n = 0, num_expired = 0;
+        std::array<bool, sudoku_num_priorities> freed{};    // class with space freed
+        while (n < max_items && num_queued() > 0) {
+            const int c = next_class();
+            std::pop_heap(m_heap[c].begin(), m_heap[c].end(), later);
+            Entry e = std::move(m_heap[c].back());
+            m_heap[c].pop_back();
+            freed[c] = true;
+
+            auto& st = m_stats.cls[c];
+            if (e.deadline < now) {
+                expired.push_back(std::move(e.item));
+                ++st.expired;
+                ++num_expired;
+                continue;
+            }
+            const long wait_us = static_cast<long>(
+                std::chrono::duration_cast<std::chrono::microseconds>(now - e.enqueued)
+                    .count());
+            ++st.dispatched;
+            st.wait_us_sum += wait_us;
+            st.wait_us_max = std::max(st.wait_us_max, wait_us);
+            // count interactive jobs in a row only while batch jobs wait
+            m_since_batch = (c == 0 && !m_heap[1].empty()) ? m_since_batch + 1 : 0;
+            out.push_back(std::move(e.item));
+            ++n;
+            if (c == 1) break;    // batch jobs one at a time
+        }
+        lock.unlock();
+        for (int c = 0; c < sudoku_num_priorities; ++c) {
+            if (freed[c]) m_not_full[c].notify_all();
+        }
+        return n + num_expired;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        for (auto& cv : m_not_full) cv.notify_all();
+        m_not_empty.notify_all();
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return num_queued();
+    }
+
+    std::size_t capacity() const { return m_capacity; }    // per class
+
+    Sudoku_scheduler_stats stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+  private:
+    struct Entry {
+        time_point deadline;
+        std::uint64_t seq;    // order of arrival (ties of deadline)
+        time_point enqueued;
+        T item;
+    };
+
+    // heap order: the entry with the earliest deadline on top
+    static bool later(const Entry& a, const Entry& b) {
+        return a.deadline != b.deadline ? a.deadline > b.deadline : a.seq > b.seq;
+    }
+
+    std::size_t num_queued() const { return m_heap[0].size() + m_heap[1].size(); }
+
+    // class of the next job to dispatch (some job must be queued)
+    int next_class() const {
+        if (m_heap[0].empty()) return 1;
+        if (m_heap[1].empty()) return 0;
+        return (m_interactive_burst > 0 && m_since_batch >= m_interactive_burst) ? 1 : 0;
+    }
+
+    const std::size_t m_capacity;
+    const int m_interactive_burst;
+    mutable std::mutex m_mutex;
+    std::array<std::condition_variable, sudoku_num_priorities> m_not_full;
+    std::condition_variable m_not_empty;
+    std::array<std::vector<Entry>, sudoku_num_priorities> m_heap;
+    std::uint64_t m_seq{0};
+    int m_since_batch{0};    // interactive jobs dispatched in a row while batch jobs wait
+    bool m_closed{false};
+    Sudoku_scheduler_stats m_stats;
+};
@@ -0,0 +1,164 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+#include "sudoku_scheduler.h"
+#include "sudoku_solve.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>    // size_t
+#include <cstdint>
+#include <list>
+#include <memory>    // shared_ptr
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solve service on a Unix domain socket
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// A resident process accepting puzzles on a Unix domain socket (stream), so the cost
+// of process startup is paid once instead of per puzzle. Each connection may send any
+// mix of requests in two forms:
+//
+//   text:    one line per puzzle, "[<id> ][p=i|b ][d=<ms> ]<puzzle>\n" with the
+//            puzzle in the one-line format of sudoku_line.h; without id a request gets
+//            its no. among the text requests of its connection (from 0); p: priority
+//            (interactive or batch), d: deadline in ms from arrival (0: none)
+//            reply: "<id> <status> <solution or -> <solve time in us>\n"
+//            with status solved, unsolvable, invalid, expired or unsolved (see below);
+//            unsolved comes with the partly filled puzzle instead of a solution
+//
+//   binary:  byte 0x00, id (uint32, little endian), region_size, blocks_per_row,
+//            blocks_per_col (one byte each), region_size^2 values (one byte each, row
+//            by row, 0: empty)
+//            or byte 0x01, id, priority (one byte, 0: interactive, 1: batch), deadline
+//            in ms (uint32, 0: none), then shape and values as for 0x00
+//            reply: byte 0x00, id (uint32), status (0: solved, 1: unsolvable,
+//            2: invalid, 3: expired, 4: unsolved), region_size, blocks_per_row,
+//            blocks_per_col, region_size^2 values (the solution, the partly filled
+//            puzzle if unsolved, else the puzzle; invalid: shape 0 0 0 and no values),
+//            solve time in us (uint32)
+//
+// Requests without priority or deadline get the defaults of the options. A puzzle
+// breaking the rules (an entry twice in a row, column or block) is answered as
+// invalid. unsolved: the logic engine stopped with cells left empty, which proves
+// nothing about the puzzle (the complete engines answer solved or unsolvable).
+//
+// One reader thread per connection parses the requests into a Sudoku_scheduler: per
+// priority class earliest deadline first, interactive before batch. If the class of a
+// request is full, the reader blocks and stops reading its socket, so the kernel
+// buffers fill up and the client blocks in turn (backpressure); clients mixing both
+// classes should use one connection per class. Worker threads take interactive requests
+// in batches and batch requests one at a time (see Sudoku_scheduler), solve them with
+// sudoku_remove_engine() (or sudoku_remove_cached(), if a cache is set) and write the
+// replies of a batch with one write per connection. Requests past their deadline when
+// taken or when their turn in the batch comes are not solved but answered as expired.
+// Replies of a connection may come out of order if several workers serve it: match
+// them by id.
+//
+// A client not reading its replies must not stall the workers: a reply not written
+// within send_timeout_ms breaks the connection. It is shut down and the requests of it
+// still queued are dropped without reply.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class Sudoku_metrics;
+class Sudoku_solution_cache;
+
+struct Sudoku_service_options {
+    std::string socket_path;
+    int threads{0};                       // worker threads (0: all cores)
+    std::size_t queue_capacity{4096};     // requests waiting for a worker (per class)
+    std::size_t batch_size{32};           // max. interactive requests taken at once
+    int interactive_burst{16};            // see Sudoku_scheduler
+    Sudoku_priority_t priority{Sudoku_priority_t::batch};    // default of requests
+    int deadline_ms{0};                   // default of requests (0: none)
+    int max_connections{64};              // further connections are closed at once
+    int send_timeout_ms{5000};            // for a reply, then the connection is broken
+    Sudoku_engine_t engine{Sudoku_engine_t::recursive};
+    Sudoku_search_options search;         // options of the engine
+    Sudoku_metrics* metrics{nullptr};     // if set: solve latencies recorded there
+    Sudoku_solution_cache* cache{nullptr};    // if set: solve via sudoku_remove_cached()
+};
+
+struct Sudoku_service_stats {
+    long connections{0};    // connections accepted
+    long rejected{0};       // connections closed, because of max_connections
+    long requests{0};
+    long solved{0};
+    long unsolvable{0};
+    long unsolved{0};   // left with empty cells by the logic engine
+    long invalid{0};    // requests not in one of the formats, or breaking the rules
+    long expired{0};    // requests not solved, because their deadline had passed
+    long dropped{0};    // requests of broken connections, not replied
+    long batches{0};    // batches taken by the workers
+    Sudoku_scheduler_stats scheduler;    // wait times & deadline misses per class
+};
+
+class Sudoku_service {
+
+  public:
+    explicit Sudoku_service(Sudoku_service_options t_opt);
+    ~Sudoku_service();    // stops the service
+
+    Sudoku_service(const Sudoku_service&)            = delete;
+    Sudoku_service& operator=(const Sudoku_service&) = delete;
+
+    // bind the socket and start the threads; returns false if the socket can't be set
+    // up (see error()); a socket left at socket_path is replaced, any other file there
+    // is left alone and makes start() fail
+    bool start();
+    // stop accepting, finish the requests already read, then join all threads
+    void stop();
+
+    const std::string& error() const { return m_error; }
+    Sudoku_service_stats stats() const;
+
+  private:
+    struct Connection;
+    struct Reader;
+
+    // one request
+    struct Job {
+        std::shared_ptr<Connection> conn;
+        std::uint32_t id{0};
+        bool binary{false};
+        bool expired{false};    // dropped by the scheduler
+        Sudoku_priority_t priority{Sudoku_priority_t::batch};
+        std::chrono::steady_clock::time_point deadline{
+            std::chrono::steady_clock::time_point::max()};    // max(): none
+        std::optional<Sudoku> puzzle;    // empty: invalid request
+    };
+
+    void accept_loop();
+    void read_loop(std::shared_ptr<Connection> conn);
+    void work_loop();
+
+    const Sudoku_service_options m_opt;
+    std::string m_error;
+    int m_listen_fd{-1};
+    std::atomic<bool> m_stop{false};
+
+    Sudoku_scheduler<Job> m_queue;
+    std::thread m_accept_thread;
+    std::vector<std::thread> m_workers;
+    std::mutex m_readers_mutex;
+    std::list<Reader> m_readers;
+
+    std::atomic<long> m_connections{0};
+    std::atomic<long> m_rejected{0};
+    std::atomic<long> m_requests{0};
+    std::atomic<long> m_solved{0};
+    std::atomic<long> m_unsolvable{0};
+    std::atomic<long> m_unsolved{0};
+    std::atomic<long> m_invalid{0};
+    std::atomic<long> m_expired{0};
+    std::atomic<long> m_dropped{0};
+    std::atomic<long> m_batches{0};
+};
@@ -0,0 +1,52 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+
+#include <cstdint>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// vectorized kernels on the contiguous state arrays of a Sudoku
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// The kernels work on the value array (uint8_t, 0: empty) and the candidate array
+// (one 32 bit mask per cell) as returned by Sudoku::values() and Sudoku::candidates().
+//
+// Each kernel exists as scalar version and, on x86-64 with gcc or clang, as SSE4.1 and
+// AVX2 version. The instruction set is selected at runtime according to the
+// capabilities of the CPU (the binary itself is built for the baseline target).
+// All versions return identical results; sudoku_simd_kernels(Sudoku_simd_t::scalar)
+// gives access to the scalar reference path.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+enum class Sudoku_simd_t { scalar, sse4, avx2 };
+
+struct Sudoku_kernels {
+    Sudoku_simd_t level;
+
+    // no. of empty cells (val == 0)
+    int (*num_empty)(const std::uint8_t* val, int n);
+
+    // sum of candidates of all empty cells
+    // (returns -1, if an empty cell without candidates exists)
+    int (*num_candidates)(const std::uint8_t* val, const Sudoku_candidates* cand, int n);
+
+    // write indices of empty cells with exactly one candidate into cells (capacity n)
+    // and return their number (indices in ascending order)
+    int (*naked_single_cells)(const std::uint8_t* val, const Sudoku_candidates* cand,
+                              int n, int* cells);
+
+    // cand[i] = (val[i] != 0) ? {} : cand[i] without (common_used | used[i])
+    void (*filter_candidates)(const std::uint8_t* val, Sudoku_candidates* cand, int n,
+                              cand_mask_t common_used, const cand_mask_t* used);
+};
+
+// best instruction set supported by the CPU (detected once)
+Sudoku_simd_t sudoku_simd_supported();
+
+// kernels for the best supported instruction set
+const Sudoku_kernels& sudoku_simd_kernels();
+// kernels for the requested instruction set (or the best supported one below it)
+const Sudoku_kernels& sudoku_simd_kernels(Sudoku_simd_t level);
@@ -6,6 +6,9 @@
 #include "sudoku_class.h"
 
 #include <algorithm>    // std::unique, std::sort
+#include <atomic>
+#include <cstddef>    // size_t
+#include <cstdint>
 #include <map>
 #include <tuple>
 #include <utility>    // std::pair
@@ -84,6 +87,10 @@ using quad_vec = std::vector<std::tuple<int, int, int, int, Region_t, int, int,
 void sudoku_update_candidates_cell(Sudoku& s, int cnt);
 void sudoku_update_candidates_affected_by_cell(Sudoku& s, int cnt);
 void sudoku_update_candidates_all_cells(Sudoku& s);
+// cell(cnt) was just filled in: clear its candidates & remove its value from its peers
+void sudoku_update_candidates_peers_of_cell(Sudoku& s, int cnt);
+// candidates derived from the entries only (drops reductions by logic techniques)
+void sudoku_reset_candidates_all_cells(Sudoku& s);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // validation of sudoku
@@ -110,6 +117,7 @@ single_vec sudoku_naked_singles(const Sudoku& s);
 int sudoku_num_naked_singles(const Sudoku& s);
 bool sudoku_has_naked_singles(const Sudoku& s);
 int sudoku_remove_naked_singles(Sudoku& s);
+int sudoku_apply_naked_singles(Sudoku& s, const single_vec& naked_singles);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // hidden singles
@@ -121,6 +129,7 @@ single_vec sudoku_hidden_singles(const Sudoku& s);
 int sudoku_num_hidden_singles(const Sudoku& s);
 bool sudoku_has_hidden_singles(const Sudoku& s);
 int sudoku_remove_hidden_singles(Sudoku& s);
+int sudoku_apply_hidden_singles(Sudoku& s, const single_vec& hidden_singles);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // naked twins
@@ -134,6 +143,7 @@ bool sudoku_has_naked_twins(const Sudoku& s);
 // solution steps (return no. of removed naked twins)
 // just reduces candidate lists of cells in region, does not fill in cells
 int sudoku_remove_naked_twins(Sudoku& s);
+int sudoku_apply_naked_twins(Sudoku& s, const twin_vec& naked_twins);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // hidden twins
@@ -147,6 +157,7 @@ bool sudoku_has_hidden_twins(const Sudoku& s);
 // solution steps (return no. of removed hidden twins)
 // just reduces candidate lists of cells in region, does not fill in cells
 int sudoku_remove_hidden_twins(Sudoku& s);
+int sudoku_apply_hidden_twins(Sudoku& s, const twin_vec& hidden_twins);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // naked triples
@@ -160,6 +171,7 @@ bool sudoku_has_naked_triples(const Sudoku& s);
 // solution steps (return no. of removed naked triples)
 // just reduces candidate lists of cells in region, does not fill in cells
 int sudoku_remove_naked_triples(Sudoku& s);
+int sudoku_apply_naked_triples(Sudoku& s, const triple_vec& naked_triples);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // hidden triples
@@ -173,6 +185,7 @@ bool sudoku_has_hidden_triples(const Sudoku& s);
 // solution steps (return no. of removed hidden triples)
 // just reduces candidate lists of cells in region, does not fill in cells
 int sudoku_remove_hidden_triples(Sudoku& s);
+int sudoku_apply_hidden_triples(Sudoku& s, const triple_vec& hidden_triples);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // naked quadruples
@@ -186,24 +199,172 @@ bool sudoku_has_naked_quadruples(const Sudoku& s);
 // solution steps (return no. of removed naked quadruples)
 // just reduces candidate lists of cells in region, does not fill in cells
 int sudoku_remove_naked_quadruples(Sudoku& s);
+int sudoku_apply_naked_quadruples(Sudoku& s, const quad_vec& naked_quadruples);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// options and statistics of the recursive search
+// (optional stages are off by default, i.e. the default options give the plain search)
+//////////////////////////////////////////////////////////////////////////////////////////
+enum class Sudoku_restart_t { none, luby, geometric };    // restart strategies
+
+class Sudoku_transposition_table;    // see sudoku_solve_tt.h
+
+// replacement policies of the transposition table (see sudoku_solve_tt.h)
+enum class Sudoku_tt_replace_t { always, depth_preferred, two_tier };
+
+struct Sudoku_search_options {
+    // failed-literal probing on bivalue cells before branching (mixed search)
+    // (see sudoku_solve_probe.h)
+    bool probing{false};
+    int probing_max_rounds{4};    // max. no. of probing passes per search node
+
+    // conflict-directed backjumping (recursive search, see sudoku_solve_cbj.h)
+    bool backjumping{false};
+    bool nogoods{false};            // record small nogoods (requires backjumping)
+    int nogood_max_size{6};         // max. no. of assignments in a recorded nogood
+    int nogood_max_count{65536};    // max. no. of nogoods recorded per search
+
+    // randomized restarts (mixed search): runs with growing node limits (Luby sequence
+    // or geometric), branching on a cell with the least candidates and trying its
+    // values in random order; ties are broken by a generator seeded with seed, so runs
+    // are reproducible. Puzzles with several solutions may give another solution.
+    // Restarts cut off long runs caused by early wrong branching; puzzles the search
+    // solves in few nodes anyway only pay for the extra runs.
+    Sudoku_restart_t restarts{Sudoku_restart_t::none};
+    long restart_base{100};        // node limit of the first run (Luby: unit; min. 1)
+    double restart_factor{2.0};    // growth of the node limit per run (geometric;
+                                   // min. 1.1, smaller values are taken as 1.1)
+    std::uint64_t seed{0};
+
+    // transposition table (mixed search and solution counting, see sudoku_solve_tt.h):
+    // sub-search outcomes keyed by the Zobrist hash of the grid; a table of its own
+    // for each mixed search (shared by the runs of restarts), or the table tt if set
+    // (shared by several searches, e.g. the uniqueness checks of the generator);
+    // solution counts use the table tt only (none if it is not set: allocating
+    // tt_max_bytes per count costs more than most counts take)
+    bool transposition{false};
+    std::size_t tt_max_bytes{std::size_t{1} << 20};    // memory cap of the table
+    Sudoku_tt_replace_t tt_replace{Sudoku_tt_replace_t::two_tier};
+    Sudoku_transposition_table* tt{nullptr};
+
+    // cooperative cancellation (e.g. from another thread): the search gives up as soon
+    // as *cancel is set and returns the sudoku unchanged (honored by all complete
+    // searches incl. the SAT engine; nullptr: no cancellation)
+    const std::atomic<bool>* cancel{nullptr};
+};
+
+struct Sudoku_search_stats {
+    long nodes{0};    // search nodes visited
+
+    // probing
+    long probes{0};              // tentative assignments propagated
+    long probe_failures{0};      // candidates removed, because their probe failed
+    long probe_agreements{0};    // values entered, because both probes agreed
+
+    // backjumping
+    long backjumps{0};         // backtracks skipping at least one decision level
+    long levels_skipped{0};    // decision levels skipped by backjumps
+    long nogoods_recorded{0};
+    long nogood_prunes{0};    // values rejected by a recorded nogood
+
+    // restarts
+    long restarts{0};    // runs given up at their node limit
+
+    // transposition table
+    long tt_probes{0};        // lookups
+    long tt_hits{0};          // lookups that skipped a whole subtree
+    long tt_stores{0};        // outcomes stored
+    long tt_overwrites{0};    // stores replacing the outcome of another grid
+};
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // recursively try candidate values in cell
 //////////////////////////////////////////////////////////////////////////////////////////
 std::pair<int, Sudoku> sudoku_remove_recursive(Sudoku s, int lvl = 0);
+// same, with optional search stages (statistics are accumulated in stats)
+std::pair<int, Sudoku> sudoku_remove_recursive(Sudoku s, const Sudoku_search_options& opt,
+                                               Sudoku_search_stats& stats);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// no. of solutions of s; counting stops as soon as limit solutions are found
+// (limit 2: 0 = no solution, 1 = unique solution, 2 = several solutions)
+// returns 0 if s is not valid; candidates are recomputed from the entries of s
+//////////////////////////////////////////////////////////////////////////////////////////
+int sudoku_count_solutions(const Sudoku& s, int limit = 2);
+// same, with search options (only opt.transposition and its settings are used;
+// statistics are accumulated in stats)
+int sudoku_count_solutions(const Sudoku& s, int limit, const Sudoku_search_options& opt,
+                           Sudoku_search_stats& stats);
+// same, but only solutions within the current candidates of s are counted (candidates
+// must not contain values entered in a peer, but may be reduced further, e.g. to
+// exclude a known solution)
+int sudoku_count_solutions_within_candidates(const Sudoku& s, int limit = 2);
+int sudoku_count_solutions_within_candidates(const Sudoku& s, int limit,
+                                             const Sudoku_search_options& opt,
+                                             Sudoku_search_stats& stats);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// all solutions found by algorithm for one state of the sudoku
+// (computed once and then counted or applied, see sudoku_remove_algo_all)
+//////////////////////////////////////////////////////////////////////////////////////////
+struct Sudoku_algo_solutions {
+    single_vec naked_singles;
+    single_vec hidden_singles;
+    twin_vec naked_twins;
+    twin_vec hidden_twins;
+    triple_vec naked_triples;
+    triple_vec hidden_triples;
+    quad_vec naked_quadruples;
+};
+
+Sudoku_algo_solutions sudoku_algo_solutions(const Sudoku& s);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // number of enties solvable by algorithm
 //////////////////////////////////////////////////////////////////////////////////////////
+std::vector<int> sudoku_num_algo_solutions(const Sudoku_algo_solutions& sol);
 std::vector<int> sudoku_num_algo_solutions(const Sudoku& s);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // remove all types of singles, twins, etc. by algorithm
 //////////////////////////////////////////////////////////////////////////////////////////
 int sudoku_remove_algo_all(Sudoku& s);
+// same, but starting with the solutions already found for the current state of s
+int sudoku_remove_algo_all(Sudoku& s, Sudoku_algo_solutions sol);
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // recursively try candidate values in cell using algo solutions if available
 //////////////////////////////////////////////////////////////////////////////////////////
 std::pair<int, Sudoku> sudoku_remove_recursive_algo_all_mixed(Sudoku s, int lvl = 0);
+// same, with optional search stages (statistics are accumulated in stats)
+std::pair<int, Sudoku>
+sudoku_remove_recursive_algo_all_mixed(Sudoku s, const Sudoku_search_options& opt,
+                                       Sudoku_search_stats& stats, int lvl = 0);
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// search with a selectable engine
+//
+// recursive: sudoku_remove_recursive()
+// mixed:     sudoku_remove_recursive_algo_all_mixed()
+// sat:       sudoku_remove_sat() (see sudoku_solve_sat.h)
+// logic:     sudoku_remove_algo_all(), i.e. logic techniques only (not complete: cells
+//            may be left empty; returns the no. of entries made and the reduced sudoku)
+// portfolio: sudoku_remove_portfolio() with sudoku_default_portfolio(), i.e. the
+//            engines above raced on threads (see sudoku_solve_portfolio.h; the entries
+//            use their own options, only opt.cancel is honored)
+// batch:     sudoku_remove_recursive_batch() (see sudoku_solve_batch.h; opt is not
+//            used); meant for many puzzles at once, as the chunks of
+//            sudoku_solve_stream(): a single puzzle is a batch of one
+//
+// all complete engines return the same solution for puzzles with a unique solution
+//////////////////////////////////////////////////////////////////////////////////////////
+// (new engines go last: per-engine arrays have sudoku_num_engines entries, see
+// sudoku_metrics.h)
+enum class Sudoku_engine_t { recursive, mixed, sat, logic, portfolio, batch };
+
+std::pair<int, Sudoku> sudoku_remove_engine(Sudoku s, Sudoku_engine_t engine);
+// same, with search options (statistics are accumulated in stats)
+std::pair<int, Sudoku> sudoku_remove_engine(Sudoku s, Sudoku_engine_t engine,
+                                            const Sudoku_search_options& opt,
+                                            Sudoku_search_stats& stats);
 //
@@ -0,0 +1,178 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+#include "sudoku_solve_fixed.h"
+
+#include <array>
+#include <bit>    // countr_zero()
+#include <cstdint>
+#include <utility>    // pair
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// batch solver: propagates several puzzles of the same shape in lockstep
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// The candidate masks of up to "lanes" puzzles are interleaved cell by cell
+// (cand[cell][lane]), so every step of the propagation is the same bit operation on
+// all lanes. The lane loops have a constant trip count and no branches, which lets the
+// compiler map them onto vector registers (e.g. 16 x 16 bit masks in one AVX2
+// register for 9x9 puzzles).
+//
+// Entries and candidates use the same representation: a cell is decided, if its mask
+// has exactly one bit set. Propagation applies naked singles (remove decided values
+// from the other cells of a region) and hidden singles (a value possible in only one
+// cell of a region) until no lane changes any more. A lane whose state contradicts
+// itself (empty mask, value decided twice or not possible at all in a region) has no
+// solution.
+//
+// Puzzles that are not solved by propagation alone spill back to the scalar search
+// (Sudoku_fixed::remove_recursive(), i.e. sudoku_remove_recursive() for this shape).
+// Results are the same as calling sudoku_remove_recursive() for each puzzle.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <int t_region_size, int t_blocks_per_row, int t_blocks_per_col>
+class Sudoku_batch {
+
+  public:
+    using Fixed  = Sudoku_fixed<t_region_size, t_blocks_per_row, t_blocks_per_col>;
+    using mask_t = typename Fixed::mask_t;
+
+    static constexpr int region_size = Fixed::region_size;
+    static constexpr int total_size  = Fixed::total_size;
+    static constexpr int num_regions = Fixed::num_regions;
+    static constexpr mask_t all_mask = Fixed::all_mask;
+    // puzzles per batch: fill 256 bits per cell
+    static constexpr int lanes = 256 / (8 * static_cast<int>(sizeof(mask_t)));
+
+    // interleaved state of all lanes (trivially copyable)
+    struct Grid {
+        std::array<std::array<mask_t, lanes>, total_size> cand{};
+        std::array<mask_t, lanes> dead{};    // != 0: contradiction found in lane
+    };
+
+    // load s into lane l (unused lanes should be loaded with a copy of a used one)
+    static void load(Grid& g, int l, const Sudoku& s) {
+        for (int cnt = 0; cnt < total_size; ++cnt) {
+            g.cand[cnt][l] = (s(cnt).val != 0)
+                                 ? bit(s(cnt).val)
+                                 : static_cast<mask_t>(s(cnt).cand.mask() & all_mask);
+        }
+        g.dead[l] = 0;
+    }
+
+    // lane l is solved (all cells decided and no contradiction)
+    static bool solved(const Grid& g, int l) {
+        if (g.dead[l] != 0) return false;
+        for (int cnt = 0; cnt < total_size; ++cnt) {
+            if (!single(g.cand[cnt][l])) return false;
+        }
+        return true;
+    }
+
+    // write lane l into s (decided cells as values, others as candidates)
+    static void store(const Grid& g, int l, Sudoku& s) {
+        for (int cnt = 0; cnt < total_size; ++cnt) {
+            const mask_t m = g.cand[cnt][l];
+            if (single(m)) {
+                s.set_value(cnt, std::countr_zero(m) + 1);
+                s(cnt).cand.clear();
+            } else {
+                s.set_value(cnt, 0);
+                s(cnt).cand = Sudoku_candidates(m);
+            }
+        }
+    }
+
+    // propagate naked and hidden singles in all lanes until nothing changes
+    static void propagate(Grid& g) {
+        mask_t changed = 1;
+        while (changed != 0) {
+            changed = 0;
+            for (int r = 0; r < num_regions; ++r) {
+                changed |= propagate_region(g, Fixed::tables.region_cells[r]);
+            }
+        }
+    }
+
+    // solve s[0..n) (0 < n <= lanes); same result as sudoku_remove_recursive() for each
+    // (pre-condition: each s[i] is valid and still has empty cells)
+    static void remove_recursive(const Sudoku* s, int n, std::pair<int, Sudoku>* res);
+
+  private:
+    static constexpr mask_t bit(int v) {
+        return static_cast<mask_t>(mask_t{1} << (v - 1));
+    }
+
+    static constexpr bool single(mask_t m) { return m != 0 && (m & (m - 1)) == 0; }
+
+    using region_t = std::array<typename Fixed::cell_t, region_size>;
+
+    // all bits set if x == 0, otherwise 0 (branchless, so lane loops vectorize)
+    static constexpr mask_t zero_mask(mask_t x) {
+        return static_cast<mask_t>(mask_t{0} - static_cast<mask_t>(x == 0));
+    }
+
+    // one propagation step for one region in all lanes (returns != 0 on change)
+    static mask_t propagate_region(Grid& g, const region_t& rc) {
+        std::array<mask_t, lanes> once{};       // value possible in at least one cell
+        std::array<mask_t, lanes> twice{};      // value possible in at least two cells
+        std::array<mask_t, lanes> s_once{};     // value decided in at least one cell
+        std::array<mask_t, lanes> s_twice{};    // value decided in at least two cells
+
+        for (auto c : rc) {
+            for (int l = 0; l < lanes; ++l) {
+                const mask_t m = g.cand[c][l];
+                const mask_t s = m & zero_mask(m & (m - 1));    // decided value (or 0)
+                twice[l] |= once[l] & m;
+                once[l] |= m;
+                s_twice[l] |= s_once[l] & s;
+                s_once[l] |= s;
+            }
+        }
+
+        std::array<mask_t, lanes> exactly_once;
+        std::array<mask_t, lanes> dead;    // (local copy: no aliasing with g.cand)
+        for (int l = 0; l < lanes; ++l) {
+            exactly_once[l] = once[l] & static_cast<mask_t>(~twice[l]);
+            // value not possible in region or decided twice
+            dead[l] = g.dead[l] | static_cast<mask_t>(once[l] ^ all_mask) | s_twice[l];
+        }
+
+        mask_t changed = 0;
+        for (auto c : rc) {
+            for (int l = 0; l < lanes; ++l) {
+                const mask_t m         = g.cand[c][l];
+                const mask_t decided   = zero_mask(m & (m - 1));
+                const mask_t hit       = m & exactly_once[l];
+                const mask_t no_hidden = zero_mask(hit);
+                // decided cells keep their value, hidden singles become decided,
+                // all others lose the values decided elsewhere in the region
+                const mask_t reduced = (hit & ~no_hidden) | (m & ~s_once[l] & no_hidden);
+                const mask_t nm      = (m & decided) | (reduced & ~decided);
+                // empty cell or two hidden singles in the same cell
+                dead[l] |= zero_mask(nm) | (~zero_mask(nm & (nm - 1)) & ~no_hidden);
+                changed |= static_cast<mask_t>(nm ^ m);
+                g.cand[c][l] = nm;
+            }
+        }
+
+        g.dead = dead;
+
+        // masks only ever lose bits, so the propagation terminates for all lanes
+        return changed;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solve all puzzles (any mix of shapes)
+//
+// puzzles of a shape with Sudoku_fixed specialization are solved in batches, all others
+// with sudoku_remove_recursive(); result[i] belongs to puzzles[i] and equals
+// sudoku_remove_recursive(puzzles[i])
+//////////////////////////////////////////////////////////////////////////////////////////
+std::vector<std::pair<int, Sudoku>>
+sudoku_remove_recursive_batch(const std::vector<Sudoku>& puzzles);
@@ -0,0 +1,126 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_canonical.h"
+#include "sudoku_class.h"
+#include "sudoku_solve.h"
+
+#include <cstddef>    // size_t
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>    // pair
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solution cache keyed by the canonical form of the puzzle
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Puzzles are canonicalized (see sudoku_canonical.h) and keyed by a 128 bit hash of
+// their canonical form, so a puzzle and all its symmetric variants share one entry.
+// The entry holds the solution of the canonical puzzle (or the fact that there is
+// none); on a hit it is mapped back onto the puzzle by the inverse transform.
+//
+// The cache is bounded: inserting into a full cache evicts the least recently used
+// entry. All member functions are thread-safe (one mutex; canonicalization and solving
+// are done outside of the lock).
+//
+// A hit is checked before it is returned: the solution mapped back must be a full grid
+// keeping the rules and the clues of the puzzle. An entry failing this (a colliding hash
+// or a corrupt file) counts as a miss, and the result of solving replaces it. Entries
+// of puzzles without solution can't be checked this way.
+//
+// For puzzles with a unique solution the result is the same as that of the engine.
+// If there are several solutions, a hit returns the solution cached for the
+// equivalence class, which may differ from the one the engine would find.
+//
+// File format of save() and load(): one entry per line, most recently used first:
+// the hash (32 hex digits) and the canonical solution (see sudoku_canonical_key()) or
+// '-' if the puzzle has no solution.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct Sudoku_cache_stats {
+    long hits{0};
+    long misses{0};
+    long insertions{0};
+    long evictions{0};    // entries dropped to stay within the capacity
+    long rejected{0};     // entries found, but not fitting the puzzle (counted as misses)
+};
+
+class Sudoku_solution_cache {
+
+  public:
+    struct Hash {
+        std::uint64_t hi{0};
+        std::uint64_t lo{0};
+        bool operator==(const Hash&) const = default;
+    };
+
+    explicit Sudoku_solution_cache(std::size_t t_capacity = 1 << 16);
+
+    // solution of s from the cache: (no. of entries made, solved sudoku), (0, s
+    // unchanged) if s has no solution, or an empty optional if s is not cached
+    std::optional<std::pair<int, Sudoku>> lookup(const Sudoku& s);
+    // same, with the canonical form of s already known
+    std::optional<std::pair<int, Sudoku>> lookup(const Sudoku& s,
+                                                 const Sudoku_canonical& canon);
+
+    // enter the result of solving s (solved: full grid; otherwise s has no solution)
+    void insert(const Sudoku& s, const Sudoku& solved);
+    // same, with the canonical form of s already known
+    void insert(const Sudoku_canonical& canon, const Sudoku& solved);
+
+    std::size_t size() const;
+    std::size_t capacity() const { return m_capacity; }
+    Sudoku_cache_stats stats() const;
+    void clear();    // drop all entries (stats are kept)
+
+    // persist the entries to file path (atomically, see sudoku_replace_file() in
+    // sudoku_file.h); returns false on i/o errors
+    bool save(const std::string& path) const;
+    // warm the cache from file path; returns the no. of entries read (-1: can't open)
+    int load(const std::string& path);
+
+    static Hash hash(const std::string& canonical_key);
+
+  private:
+    struct Hash_hasher {
+        std::size_t operator()(const Hash& h) const { return h.lo; }
+    };
+
+    // solution of the canonical puzzle, empty if there is none
+    using Entry      = std::pair<Hash, std::string>;
+    using Entry_list = std::list<Entry>;
+
+    void insert_entry(const Hash& h, std::string solution);
+    // solution of s from the entry of its canonical form (see lookup()), or an empty
+    // optional if the entry doesn't fit s
+    static std::optional<std::pair<int, Sudoku>>
+    solution_of(const Sudoku& s, const Sudoku_canonical& canon,
+                const std::string& solution);
+
+    const std::size_t m_capacity;
+    mutable std::mutex m_mutex;
+    Entry_list m_lru;    // most recently used first
+    std::unordered_map<Hash, Entry_list::iterator, Hash_hasher> m_index;
+    Sudoku_cache_stats m_stats;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solve s with the cache: look up s, on a miss solve it with engine and cache the result
+// (results of the logic engine are only cached if it solved s completely)
+//////////////////////////////////////////////////////////////////////////////////////////
+std::pair<int, Sudoku>
+sudoku_remove_cached(const Sudoku& s, Sudoku_solution_cache& cache,
+                     Sudoku_engine_t engine = Sudoku_engine_t::mixed);
+// same, with search options (statistics of the engine are accumulated in stats, on
+// misses only; nothing is cached if the search was cancelled via opt.cancel)
+std::pair<int, Sudoku> sudoku_remove_cached(const Sudoku& s, Sudoku_solution_cache& cache,
+                                            Sudoku_engine_t engine,
+                                            const Sudoku_search_options& opt,
+                                            Sudoku_search_stats& stats);
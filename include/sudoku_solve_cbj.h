@@ -0,0 +1,38 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+#include "sudoku_solve.h"
+
+#include <utility>    // pair
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// recursive search with conflict-directed backjumping (CBJ)
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// The search of sudoku_remove_recursive() (see sudoku_solve_fixed.h: first empty cell,
+// candidates in ascending order, naked and hidden singles propagated after each
+// decision), extended by conflict sets: each entry remembers when and why it was made
+// (decision, naked single, hidden single in a region), so a contradiction can be traced
+// back to the decisions it follows from.
+//
+// If all values of a cell fail, the search does not just try the next candidate of the
+// previous decision: it jumps back directly to the latest decision involved in the
+// conflict (the conflict set of the cell). Decisions in between had no part in the
+// conflict, trying their other candidates would fail the same way.
+//
+// With opt.nogoods, the assignments of a conflict set with at most opt.nogood_max_size
+// entries are recorded as nogood; a value completing a nogood is rejected at once
+// instead of repeating the failing sub-search.
+//
+// Only sub-searches without solution are skipped, so the result is the same as that of
+// sudoku_remove_recursive() and the search never visits more nodes. The bookkeeping
+// makes a node about 2-3 times as expensive, so it pays off only for puzzles where
+// backjumping skips large parts of the search. Shapes without specialized solver fall
+// back to the plain search.
+//////////////////////////////////////////////////////////////////////////////////////////
+std::pair<int, Sudoku> sudoku_remove_recursive_cbj(Sudoku s,
+                                                   const Sudoku_search_options& opt,
+                                                   Sudoku_search_stats& stats);
@@ -0,0 +1,304 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+
+#include <algorithm>    // copy(), fill_n()
+#include <array>
+#include <atomic>
+#include <bit>    // popcount(), countr_zero()
+#include <cstdint>
+#include <optional>
+#include <type_traits>    // conditional_t
+#include <utility>        // pair
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Sudoku solver specialized at compile time for one shape
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// The shape (region_size, blocks_per_row, blocks_per_col) is a template parameter, so
+// all index math is done once by the compiler: peers and regions of each cell are
+// constexpr tables, the grid state lives in fixed-size arrays (values and candidate
+// bitmasks, bit (v-1) set if value v is a candidate) and every loop bound is a
+// compile-time constant the compiler is free to unroll.
+//
+// The search is the same as in sudoku_remove_recursive(): always branch on the first
+// empty cell and try its candidates in ascending order. Naked and hidden singles are
+// propagated after each assignment. Propagation only fills in forced values and cuts
+// dead branches, so the first solution found is the same as with the generic solver.
+//
+// Use sudoku_remove_recursive_fixed() to dispatch at runtime; it returns an empty
+// optional for shapes without specialization.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <int t_region_size, int t_blocks_per_row, int t_blocks_per_col>
+class Sudoku_fixed {
+
+  public:
+    static constexpr int region_size    = t_region_size;
+    static constexpr int blocks_per_row = t_blocks_per_row;
+    static constexpr int blocks_per_col = t_blocks_per_col;
+    static constexpr int total_size     = region_size * region_size;
+    static constexpr int rows_per_block = region_size / blocks_per_col;
+    static constexpr int cols_per_block = region_size / blocks_per_row;
+    static constexpr int num_regions    = 3 * region_size;    // rows, cols, blocks
+    // peers of a cell: rest of row and col + cells of block in other rows and cols
+    static constexpr int num_peers =
+        2 * (region_size - 1) + (rows_per_block - 1) * (cols_per_block - 1);
+
+    static_assert(region_size > 0 && region_size <= 32, "Unsupported region size.");
+    static_assert(region_size % blocks_per_row == 0 &&
+                      region_size / blocks_per_row == blocks_per_col,
+                  "Invalid Sudoku parameters.");
+
+    using mask_t = std::conditional_t<(region_size <= 16), std::uint16_t, std::uint32_t>;
+    using cell_t = std::conditional_t<(total_size <= 256), std::uint8_t, std::uint16_t>;
+
+    static constexpr mask_t all_mask =
+        static_cast<mask_t>((std::uint64_t{1} << region_size) - 1);
+
+    // mutable state of the grid (trivially copyable)
+    // (copied on every branch of the search: a few cache lines, about 250 bytes for 9x9)
+    struct Grid {
+        std::array<std::uint8_t, total_size> val{};    // 0: empty, 1..N: entry
+        std::array<mask_t, total_size> cand{};         // candidates of empty cells
+        int num_empty{0};
+    };
+
+    static_assert(std::is_trivially_copyable_v<Grid>);
+
+    // compile-time lookup tables
+    struct Tables {
+        std::array<std::array<cell_t, num_peers>, total_size> peers{};
+        std::array<std::array<cell_t, region_size>, num_regions> region_cells{};
+    };
+
+    static constexpr int block_to_cnt(int i, int j) {
+        // same mapping as Sudoku::block_to_cnt()
+        return j % cols_per_block + cols_per_block * (i % blocks_per_row) +
+               (j / cols_per_block + rows_per_block * (i / blocks_per_row)) * region_size;
+    }
+
+    static constexpr Tables make_tables() {
+        Tables t{};
+        for (int i = 0; i < region_size; ++i) {
+            for (int j = 0; j < region_size; ++j) {
+                t.region_cells[i][j]                   = i * region_size + j;    // row
+                t.region_cells[region_size + i][j]     = i + region_size * j;    // col
+                t.region_cells[2 * region_size + i][j] = block_to_cnt(i, j);     // block
+            }
+        }
+        for (int cnt = 0; cnt < total_size; ++cnt) {
+            int row   = cnt / region_size;
+            int col   = cnt % region_size;
+            int block = col / cols_per_block + (row / rows_per_block) * blocks_per_row;
+            int k     = 0;
+            for (int j = 0; j < region_size; ++j) {
+                int c_row = row * region_size + j;
+                int c_col = j * region_size + col;
+                if (c_row != cnt) t.peers[cnt][k++] = c_row;
+                if (c_col != cnt) t.peers[cnt][k++] = c_col;
+            }
+            for (int j = 0; j < region_size; ++j) {
+                int c = block_to_cnt(block, j);
+                if (c / region_size != row && c % region_size != col) t.peers[cnt][k++] = c;
+            }
+        }
+        return t;
+    }
+
+    static constexpr Tables tables = make_tables();
+
+    // copy values and candidates of s into the grid
+    // (candidates used by a peer are removed, they can't lead to a valid solution)
+    static Grid load(const Sudoku& s) {
+        Grid g;
+        for (int cnt = 0; cnt < total_size; ++cnt) {
+            g.val[cnt] = s(cnt).val;
+            if (g.val[cnt] != 0) continue;
+            ++g.num_empty;
+            g.cand[cnt] = static_cast<mask_t>(s(cnt).cand.mask() & all_mask);
+        }
+        for (int cnt = 0; cnt < total_size; ++cnt) {
+            if (g.val[cnt] == 0) continue;
+            for (auto p : tables.peers[cnt]) {
+                g.cand[p] &= static_cast<mask_t>(~bit(g.val[cnt]));
+            }
+        }
+        return g;
+    }
+
+    // write values back into s (all cells filled, i.e. no candidates left)
+    static void store(const Grid& g, Sudoku& s) {
+        std::copy(g.val.begin(), g.val.end(), s.values());
+        std::fill_n(s.candidates(), total_size, Sudoku_candidates());
+        s.rehash();    // values written directly
+    }
+
+    // equivalent of sudoku_remove_recursive() for this shape
+    // (pre-condition: s is valid and still has empty cells;
+    //  the search gives up, returning s unchanged, as soon as *cancel is set;
+    //  search nodes are added to *nodes, if set)
+    static std::pair<int, Sudoku>
+    remove_recursive(const Sudoku& s, const std::atomic<bool>* cancel = nullptr,
+                     long* nodes = nullptr) {
+        Grid g               = load(s);
+        int num_empty_before = g.num_empty;
+        for (int cnt = 0; cnt < total_size; ++cnt) {
+            if (g.val[cnt] == 0 && g.cand[cnt] == 0) return std::make_pair(0, s);
+        }
+        if (!propagate(g) || !search(g, cancel, nodes)) {
+            return std::make_pair(0, s);    // return sudoku unchanged
+        }
+        Sudoku s_solved(s);
+        store(g, s_solved);
+        return std::make_pair(num_empty_before, s_solved);
+    }
+
+    // set value v in empty cell cnt and propagate naked singles
+    // (returns false on contradiction, i.e. an empty cell without candidates)
+    static bool assign(Grid& g, int cnt, int v) {
+        // cells that became naked singles (or ran out of candidates); each cell can be
+        // added at most twice (one candidate left, no candidate left)
+        std::array<cell_t, 2 * total_size> pending;
+        int num_pending = 0;
+
+        set_value(g, cnt, v, pending, num_pending);
+        while (num_pending > 0) {
+            int c = pending[--num_pending];
+            if (g.val[c] != 0) continue;
+            if (g.cand[c] == 0) return false;
+            set_value(g, c, std::countr_zero(g.cand[c]) + 1, pending, num_pending);
+        }
+        return true;
+    }
+
+    // fill in hidden singles (and the naked singles they cause) until nothing changes
+    // (returns false on contradiction)
+    static bool propagate(Grid& g) {
+        bool changed = true;
+        while (changed && g.num_empty > 0) {
+            changed = false;
+            for (int r = 0; r < num_regions; ++r) {
+                mask_t once   = 0;    // candidate seen in at least one cell
+                mask_t twice  = 0;    // candidate seen in at least two cells
+                mask_t placed = 0;    // values already entered in region
+                for (auto c : tables.region_cells[r]) {
+                    if (g.val[c] != 0) {
+                        placed |= bit(g.val[c]);
+                    } else {
+                        twice |= once & g.cand[c];
+                        once |= g.cand[c];
+                    }
+                }
+                if ((once | placed) != all_mask) return false;    // value can't be set
+
+                mask_t exactly_once = once & static_cast<mask_t>(~twice);
+                if (exactly_once == 0) continue;
+                for (auto c : tables.region_cells[r]) {
+                    if (g.val[c] != 0) continue;
+                    mask_t hit = g.cand[c] & exactly_once;
+                    if (hit == 0) continue;
+                    if (std::popcount(hit) > 1) return false;    // two values, one cell
+                    if (!assign(g, c, std::countr_zero(hit) + 1)) return false;
+                    changed = true;
+                }
+            }
+        }
+        return true;
+    }
+
+    // depth first search on first empty cell (returns true if solved)
+    static bool search(Grid& g, const std::atomic<bool>* cancel = nullptr,
+                       long* nodes = nullptr) {
+        if (g.num_empty == 0) return true;
+        if (cancel != nullptr && cancel->load(std::memory_order_relaxed)) return false;
+        if (nodes != nullptr) ++*nodes;
+
+        int cnt = 0;
+        while (g.val[cnt] != 0) ++cnt;
+
+        for (mask_t m = g.cand[cnt]; m != 0; m &= m - 1) {
+            Grid g_try = g;
+            if (assign(g_try, cnt, std::countr_zero(m) + 1) && propagate(g_try) &&
+                search(g_try, cancel, nodes)) {
+                g = g_try;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // no. of solutions of s, counting stops at limit (pre-condition: s is valid)
+    static int count_solutions(const Sudoku& s, int limit) {
+        Grid g = load(s);
+        for (int cnt = 0; cnt < total_size; ++cnt) {
+            if (g.val[cnt] == 0 && g.cand[cnt] == 0) return 0;
+        }
+        if (!propagate(g)) return 0;
+        int num_solutions = 0;
+        count(g, limit, num_solutions);
+        return num_solutions;
+    }
+
+    // add the solutions of g to num_solutions until limit is reached
+    // (the no. of solutions does not depend on the search order: branch on the empty
+    //  cell with the fewest candidates)
+    static void count(const Grid& g, int limit, int& num_solutions) {
+        if (g.num_empty == 0) {
+            ++num_solutions;
+            return;
+        }
+
+        int cnt      = -1;
+        int min_cand = region_size + 1;
+        for (int c = 0; c < total_size && min_cand > 2; ++c) {
+            if (g.val[c] != 0) continue;
+            const int num_cand = std::popcount(g.cand[c]);
+            if (num_cand < min_cand) {
+                min_cand = num_cand;
+                cnt      = c;
+            }
+        }
+
+        for (mask_t m = g.cand[cnt]; m != 0 && num_solutions < limit; m &= m - 1) {
+            Grid g_try = g;
+            if (assign(g_try, cnt, std::countr_zero(m) + 1) && propagate(g_try)) {
+                count(g_try, limit, num_solutions);
+            }
+        }
+    }
+
+  private:
+    static constexpr mask_t bit(int v) { return static_cast<mask_t>(mask_t{1} << (v - 1)); }
+
+    static void set_value(Grid& g, int cnt, int v,
+                          std::array<cell_t, 2 * total_size>& pending, int& num_pending) {
+        const mask_t b = bit(v);
+        g.val[cnt]     = v;
+        g.cand[cnt]    = 0;
+        --g.num_empty;
+        for (auto p : tables.peers[cnt]) {
+            if ((g.cand[p] & b) == 0) continue;
+            g.cand[p] &= static_cast<mask_t>(~b);
+            if (g.val[p] == 0 && std::popcount(g.cand[p]) <= 1) pending[num_pending++] = p;
+        }
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// runtime dispatch to the specialized solvers
+//
+// supported shapes: 4x4 (2x2 blocks), 6x6 (2x3 and 3x2 blocks), 9x9, 16x16, 25x25
+// returns an empty optional for all other shapes (use the generic solver instead)
+//////////////////////////////////////////////////////////////////////////////////////////
+// (search nodes are added to *nodes, if set)
+std::optional<std::pair<int, Sudoku>>
+sudoku_remove_recursive_fixed(const Sudoku& s, const std::atomic<bool>* cancel = nullptr,
+                              long* nodes = nullptr);
+
+// no. of solutions of s with the specialized solvers (counting stops at limit);
+// returns an empty optional for shapes without specialization
+std::optional<int> sudoku_count_solutions_fixed(const Sudoku& s, int limit);
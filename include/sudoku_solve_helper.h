@@ -6,6 +6,7 @@
 #include "sudoku_class.h"
 
 #include <algorithm>    // equal()
+#include <cstdint>
 #include <iterator>     // prev(), next()
 #include <list>
 #include <set>
@@ -61,3 +62,16 @@ sudoku_candidate_positions_in_subregion(const Sudoku& s, const Region_t region,
 bool pairwise_different_if_size2(const set<int>& a, const set<int>& b, const set<int>& c);
 bool pairwise_different_if_size2(const set<int>& a, const set<int>& b, const set<int>& c,
                                  const set<int>& d);
+// same for candidate sets of cells
+bool pairwise_different_if_size2(const Sudoku_candidates& a, const Sudoku_candidates& b,
+                                 const Sudoku_candidates& c);
+bool pairwise_different_if_size2(const Sudoku_candidates& a, const Sudoku_candidates& b,
+                                 const Sudoku_candidates& c, const Sudoku_candidates& d);
+
+// element i (i >= 0) of the Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8...
+// (restart intervals of the search engines in units of a base interval)
+long sudoku_luby(long i);
+
+// finalizer of splitmix64 (every input bit affects every output bit; hashes of the
+// transposition table and the solution cache)
+std::uint64_t sudoku_mix64(std::uint64_t x);
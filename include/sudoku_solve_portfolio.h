@@ -0,0 +1,65 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+#include "sudoku_solve.h"
+
+#include <atomic>
+#include <string>
+#include <utility>    // pair
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// portfolio solve: race several engine configurations on threads
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Which engine is fastest depends strongly on the puzzle (logic techniques for easy
+// puzzles, the plain search for most 9x9 puzzles, the SAT engine for puzzles
+// constructed against backtracking). The portfolio runs each configuration on
+// its own thread on a copy of the sudoku; the first configuration to come to a definite
+// result wins and cancels all others (cooperatively, via opt.cancel of the entries).
+//
+// Results of complete engines (recursive, mixed, sat) are definite, also if there is no
+// solution. The logic engine only wins if it solved the sudoku completely (all cells
+// filled without breaking the rules).
+//
+// For puzzles with a unique solution the result is the same as that of
+// sudoku_remove_recursive(). If there are several solutions, the one returned depends
+// on the winning configuration and may vary from run to run.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct Sudoku_portfolio_entry {
+    std::string name;    // for statistics and reporting
+    Sudoku_engine_t engine{Sudoku_engine_t::recursive};
+    Sudoku_search_options opt;    // opt.cancel is set by the portfolio
+};
+
+struct Sudoku_portfolio_stats {
+    long solves{0};       // calls of sudoku_remove_portfolio()
+    long undecided{0};    // calls without definite result (no complete engine)
+    std::vector<long> wins;    // [i]: no. of calls won by entry i
+};
+
+// logic, recursive, mixed with probing, sat
+// (no backjumping: it visits a subset of the nodes of the recursive entry, at a higher
+// cost per node, so it hardly ever finishes first)
+std::vector<Sudoku_portfolio_entry> sudoku_default_portfolio();
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solve s with all entries of the portfolio concurrently (entry 0 runs on the calling
+// thread); returns the result of the winning entry: (no. of entries made, solved
+// sudoku), or (0, s unchanged) as sudoku_remove_recursive(). If no entry came to a
+// definite result, the result of the entry finishing first is returned.
+//
+// cancel: cooperative cancellation from outside as Sudoku_search_options::cancel
+// (all entries then run on threads and the calling thread watches *cancel); a
+// cancelled call without a winner counts as undecided and returns (0, s unchanged).
+// The entries must not use Sudoku_engine_t::portfolio themselves.
+//////////////////////////////////////////////////////////////////////////////////////////
+std::pair<int, Sudoku>
+sudoku_remove_portfolio(const Sudoku& s,
+                        const std::vector<Sudoku_portfolio_entry>& entries,
+                        Sudoku_portfolio_stats& stats,
+                        const std::atomic<bool>* cancel = nullptr);
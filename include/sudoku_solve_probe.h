@@ -0,0 +1,32 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+#include "sudoku_solve.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// failed-literal probing (Nishio-style) on bivalue cells
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// For each empty cell with exactly two candidates a and b, both values are assigned
+// tentatively and followed by cheap propagation (naked and hidden singles). All changes
+// of a probe are recorded on a trail and undone afterwards, so no copy of the Sudoku
+// is made per probe.
+//
+//   - a value whose probe ends in a contradiction can't be part of any solution: the
+//     cell gets the other value
+//   - cells that receive the same value in both probes must have that value in every
+//     solution: the value is entered
+//
+// Both conclusions keep all solutions of s, so a search started afterwards finds the
+// same (first) solution as without probing. Probing is repeated while it learns
+// something, up to opt.probing_max_rounds rounds.
+//
+// Returns the no. of values entered (>= 0), or -1 if s turned out to have no solution
+// (s is in an undefined state then). Candidates of s must be up to date on entry and
+// are kept up to date.
+//////////////////////////////////////////////////////////////////////////////////////////
+int sudoku_probe_bivalue_cells(Sudoku& s, const Sudoku_search_options& opt,
+                               Sudoku_search_stats& stats);
@@ -0,0 +1,52 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+
+#include <atomic>
+#include <utility>    // pair
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// built-in CDCL SAT engine (no external dependencies)
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// The empty cells of the Sudoku are encoded as CNF: one variable per empty cell and
+// remaining candidate value (candidates of the cell without the values already entered
+// in its row, column and block), clauses require exactly one value per cell and
+// exactly one cell per missing value in each region.
+//
+// The solver is a conflict-driven clause-learning solver: 2-watched literals, first UIP
+// learning with clause minimization, VSIDS branching with phase saving, Luby restarts
+// and periodic reduction of the learned clause database.
+//
+// In contrast to the backtracking search the runtime hardly depends on the order of the
+// cells, which makes it the engine of choice for 25x25 and larger shapes and for
+// puzzles constructed against backtracking.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct Sudoku_sat_stats {
+    long vars{0};            // variables of the encoding
+    long clauses{0};         // clauses of the encoding
+    long decisions{0};
+    long propagations{0};    // literals propagated
+    long conflicts{0};
+    long restarts{0};
+    long learned{0};    // clauses learned
+    long deleted{0};    // learned clauses removed by database reduction
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solve s with the SAT engine
+//
+// pre-conditions and return value as sudoku_remove_recursive(): (no. of entries made,
+// solved sudoku), or (0, s unchanged) if s is not valid, has no empty cells or has no
+// solution. For puzzles with a unique solution the result is the same as that of
+// sudoku_remove_recursive(); if there are several solutions, any of them is returned.
+//////////////////////////////////////////////////////////////////////////////////////////
+std::pair<int, Sudoku> sudoku_remove_sat(Sudoku s);
+// same, statistics are accumulated in stats; the search gives up as soon as *cancel is
+// set (returning (0, s unchanged))
+std::pair<int, Sudoku> sudoku_remove_sat(Sudoku s, Sudoku_sat_stats& stats,
+                                         const std::atomic<bool>* cancel = nullptr);
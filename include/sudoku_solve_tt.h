@@ -0,0 +1,87 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_solve.h"
+
+#include <cstddef>    // size_t
+#include <cstdint>
+#include <type_traits>    // is_trivially_copyable_v
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// transposition table for sub-search outcomes
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Searches reaching a partial grid a second time would repeat its sub-search in full.
+// The table remembers the outcome of finished sub-searches keyed by the Zobrist hash of
+// the grid (Sudoku::hash()), so that a hit skips the whole subtree:
+//
+//   dead:   the grid has no solution (mixed search and counting)
+//   count:  the grid has exactly count solutions (counting)
+//
+// The candidates of a node follow from the candidates of the root and the values of
+// the node (all eliminations are sound), so the values identify the node within one
+// search. Across searches sharing a table, the outcomes of a grid are the same only if
+// the searches start from the same candidates: the key is the hash of the values
+// xor a fingerprint of the root candidates that don't follow from the root values
+// (root_salt(); 0 if all do, e.g. sudoku_count_solutions(), so such searches share
+// their outcomes). Roots with reduced candidates (e.g. the clue checks of
+// sudoku_minimize() via sudoku_count_solutions_within_candidates()) get keys of their
+// own. Each entry carries a 32 bit tag of the grid from a hash independent of the key
+// (tag()), so a collision of the 64 bit keys of two grids is caught as well.
+//
+// Hits need grids reached twice: within one search this does not happen, since the
+// subtrees of a branch differ in the value of the branch cell. They occur across the
+// runs of a search with restarts and across searches sharing a table (e.g. uniqueness
+// checks of puzzles differing in a few clues).
+//
+// The table has a fixed size (power of two, within the memory cap; it is cleared on
+// construction, so keep the cap small for tables of a single short search). Replacement
+// policies when a slot is taken by another grid:
+//
+//   always:           the new outcome replaces the old one
+//   depth_preferred:  the outcome of the grid with more empty cells (the larger
+//                     subtree) is kept
+//   two_tier:         buckets of two slots: a depth-preferred slot and an always-replace
+//                     slot, so recent small subtrees don't evict large ones
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class Sudoku_transposition_table {
+
+  public:
+    enum class Outcome : std::uint8_t { none, dead, count };
+
+    struct Entry {
+        std::uint64_t key{0};
+        std::uint32_t tag{0};          // verification tag of the grid (see tag())
+        std::uint32_t count{0};        // no. of solutions (outcome count)
+        std::uint16_t num_empty{0};    // empty cells of the grid (size of the subtree)
+        Outcome outcome{Outcome::none};
+    };
+
+    static_assert(std::is_trivially_copyable_v<Entry>);
+
+    Sudoku_transposition_table(std::size_t t_max_bytes, Sudoku_tt_replace_t t_replace);
+
+    // fingerprint of the candidates of root s that don't follow from its values (0 if
+    // all do); the key of a grid in a search from s is grid.hash() ^ root_salt(s)
+    static std::uint64_t root_salt(const Sudoku& s);
+    // verification tag of grid s in a search with salt (independent of Sudoku::hash())
+    static std::uint32_t tag(const Sudoku& s, std::uint64_t salt);
+
+    // entry of the grid with key and tag, or nullptr if none is stored
+    const Entry* probe(std::uint64_t key, std::uint32_t tag,
+                       Sudoku_search_stats& stats) const;
+
+    void store(std::uint64_t key, std::uint32_t tag, int num_empty, Outcome outcome,
+               std::uint32_t count, Sudoku_search_stats& stats);
+
+    std::size_t size() const { return m_slots.size(); }    // no. of slots
+
+  private:
+    std::vector<Entry> m_slots;
+    std::size_t m_mask;    // slot (always, depth_preferred) or bucket (two_tier) index
+    const Sudoku_tt_replace_t m_replace;
+};
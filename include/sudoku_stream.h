@@ -0,0 +1,93 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_solve.h"
+
+#include <cstddef>    // size_t
+#include <cstdint>
+#include <string>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// streaming solve: puzzles in, results out, in input order
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Reads one puzzle per line (format of sudoku_line.h) from in_fd until end of input,
+// solves them on worker threads and writes one line per input line to out_fd, in input
+// order: "<status> <solution or ->" with status solved, unsolvable, unsolved or invalid.
+// invalid: not in the format, or breaking the rules (an entry twice in a row, column or
+// block); unsolved: the logic engine stopped with cells left empty, which proves nothing
+// about the puzzle, followed by the partly filled puzzle instead of a solution. Meant
+// for pipes, e.g. zcat corpus.gz | sudoku_cli --stream | ...
+//
+// With a solution cache (see sudoku_solve_cache.h), a puzzle repeated in the input, or
+// a symmetric variant of it, is solved once; the cache may be shared with other runs
+// and saved for the next one.
+//
+// The input is cut into chunks of batch_size lines. A chunk is solved by one worker and
+// its results wait in a reorder buffer until all chunks before it are written. The
+// buffer holds at most window chunks: the reader stops reading while the oldest chunk
+// is still in work, so memory stays bounded for any input size. Results are collected
+// and written in blocks of at least flush_bytes, or earlier whenever the writer would
+// otherwise have to wait for a chunk (so a slow producer still sees results).
+//
+// With the batch engine (Sudoku_engine_t::batch), the puzzles of a chunk not found in
+// the cache are solved together by sudoku_remove_recursive_batch(); each of them is
+// recorded in the metrics with the mean latency of the chunk.
+//
+// With a checkpoint path, the run can be resumed after being killed: at most every
+// checkpoint_interval seconds, after writing a block, the output is synced and the
+// checkpoint (input offset, records done, output offset, all at the end of the last
+// chunk written) replaces the previous one atomically. A run finding a checkpoint
+// continues from there: it cuts out_fd back to the output offset (dropping results
+// written after the checkpoint) and skips the input up to the input offset (seeking if
+// in_fd is a file, reading and discarding if it is a pipe). So each record is written
+// exactly once, provided the input is the same. out_fd must be a regular file then,
+// opened without truncation. The last checkpoint is written at the end of input, so a
+// finished run started again does nothing.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class Sudoku_metrics;
+class Sudoku_solution_cache;
+
+struct Sudoku_stream_options {
+    int threads{0};                       // worker threads (0: all cores)
+    std::size_t batch_size{64};           // lines per chunk
+    std::size_t window{256};              // chunks read but not written yet
+    std::size_t flush_bytes{1 << 16};     // output block size
+    std::string checkpoint_path;          // empty: no checkpoints
+    double checkpoint_interval{10.0};     // min. seconds between checkpoints
+    Sudoku_engine_t engine{Sudoku_engine_t::recursive};
+    Sudoku_search_options search;         // options of the engine
+    Sudoku_metrics* metrics{nullptr};     // if set: solve latencies recorded there
+    Sudoku_solution_cache* cache{nullptr};    // if set: solve via sudoku_remove_cached()
+};
+
+struct Sudoku_stream_stats {
+    long records{0};    // input lines
+    long solved{0};
+    long unsolvable{0};
+    long unsolved{0};   // left with empty cells by the logic engine
+    long invalid{0};    // lines not in the format of sudoku_line.h, or breaking the rules
+    long resumed{0};    // records done by earlier runs (from the checkpoint)
+    long checkpoints{0};    // checkpoints written
+};
+
+struct Sudoku_stream_checkpoint {
+    std::uint64_t input_offset{0};     // bytes of input consumed
+    std::uint64_t records{0};          // input lines done
+    std::uint64_t output_offset{0};    // bytes of output written
+};
+
+// read the checkpoint at path; false if there is none, or it is damaged
+bool sudoku_read_stream_checkpoint(const std::string& path, Sudoku_stream_checkpoint& cp);
+// replace the checkpoint at path atomically (see sudoku_replace_file() in sudoku_file.h)
+bool sudoku_write_stream_checkpoint(const std::string& path,
+                                    const Sudoku_stream_checkpoint& cp);
+
+// returns false if reading in_fd, writing out_fd or a checkpoint failed, or if out_fd
+// can't be cut back to the checkpoint; after a read error the results of the lines
+// read until then are still written
+bool sudoku_solve_stream(int in_fd, int out_fd, const Sudoku_stream_options& opt,
+                         Sudoku_stream_stats& stats);
@@ -3,12 +3,8 @@
 
 #include "dyn_assert.h"
 
-void dynamic_assert(bool assertion, std::string message) {
-    if (assertion) {
-        return;
-    } else {
-        std::cout << message << "\n";
-        std::cout << "Terminating.\n";
-        std::terminate();
-    }
-}
\ No newline at end of file
+void dynamic_assert_failed(std::string_view message) {
+    std::cout << message << "\n";
+    std::cout << "Terminating." << std::endl;    // flush before terminate()
+    std::terminate();
+}
@@ -49,7 +49,15 @@ int main(int argc, char* argv[]) {
     Sudoku s(region_size, bpr, bpc);
 
     // initialize sudoku with input values and initialize candidate values
-    for (int cnt = 0; cnt < s.total_size; ++cnt) { s(cnt).val = read_int(input_stream); }
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        const int value = read_int(input_stream);
+        if (value < 0 || value > region_size) {
+            std::cout << "\nInvalid value " << value << " in cell " << cnt
+                      << " (0: empty, 1.." << region_size << ")!\n";
+            return 1;
+        }
+        s.set_value(cnt, value);
+    }
     sudoku_update_candidates_all_cells(s);
 
     w_Sudoku_view Sudoku_view(s);
@@ -0,0 +1,424 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_canonical.h"
+#include "sudoku_solve.h"
+
+#include <algorithm>    // sort(), next_permutation()
+#include <array>
+#include <cstdint>
+#include <atomic>
+#include <numeric>    // iota()
+#include <thread>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// branch and bound search for the smallest arrangement
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// The grid is built row by row; the order of the cols is refined lazily. The cols of
+// each stack form an ordered partition (cells of cols whose order is not decided yet),
+// and so do the stacks. For each new row:
+//
+//   - the cols of a cell are sorted by value: empty first (they stay a cell, their
+//     order is decided by later rows), then digits already labelled (ascending labels),
+//     then new digits
+//   - the stacks of a cell are sorted by their (sorted) part of the row; stacks with
+//     equal parts stay a cell if these parts are empty
+//
+// New digits give the same row whatever their order, but different labels for later
+// rows, so the search branches on the orders of new digits within a cell of cols and
+// on the orders of equal stacks containing new digits. Rows are chosen eagerly.
+//
+class Sudoku_canonicalizer {
+
+  public:
+    static constexpr int max_size = 32;
+
+    // state of a partial arrangement (trivially copyable)
+    struct State {
+        // cols of source stack s in refined order at [s*cols_per_block, ...)
+        std::array<uint8_t, max_size> col{};
+        uint32_t cell_start{0};                 // bit of a col position: a cell starts
+        std::array<uint8_t, max_size> stack{};  // result stack -> source stack
+        uint32_t stack_cell_start{1};           // bit k: a cell starts at result stack k
+        std::array<uint8_t, max_size + 1> label{};    // source digit -> label (0: none)
+        int next_label{1};
+        std::array<int8_t, max_size> row{};    // result row -> source row
+        uint32_t rows_used{0};
+        uint32_t bands_used{0};
+        int band{-1};    // source band of the current result band
+    };
+
+    explicit Sudoku_canonicalizer(const Sudoku& s) :
+        m_n(s.region_size), m_rows_per_block(s.region_size / s.blocks_per_col),
+        m_cols_per_block(s.region_size / s.blocks_per_row),
+        m_num_stacks(s.blocks_per_row), m_best(s.total_size, UINT8_MAX),
+        m_cur(s.total_size, 0) {}
+
+    // search the arrangements of grid g (row major, transposed or not)
+    void search(const vector<uint8_t>& g, bool transposed) {
+        m_g          = &g;
+        m_transposed = transposed;
+
+        m_empty_rows  = 0;
+        m_empty_bands = 0;
+        for (int r = 0; r < m_n; ++r) {
+            if (all_of(g.begin() + r * m_n, g.begin() + (r + 1) * m_n,
+                       [](uint8_t v) { return v == 0; })) {
+                m_empty_rows |= uint32_t{1} << r;
+            }
+        }
+        const uint32_t band_mask = (uint32_t{1} << m_rows_per_block) - 1;
+        for (int b = 0; b < m_n / m_rows_per_block; ++b) {
+            const uint32_t rows = band_mask << (b * m_rows_per_block);
+            if ((m_empty_rows & rows) == rows) m_empty_bands |= uint32_t{1} << b;
+        }
+
+        State st;
+        iota(st.col.begin(), st.col.begin() + m_n, 0);
+        iota(st.stack.begin(), st.stack.begin() + m_num_stacks, 0);
+        for (int k = 0; k < m_num_stacks; ++k) {
+            st.cell_start |= uint32_t{1} << (k * m_cols_per_block);
+        }
+        m_diverge = s_none;
+        next_row(st, 0);
+    }
+
+    Sudoku_transform transform() const {
+        Sudoku_transform tr;
+        tr.transpose = m_best_transposed;
+        tr.row.assign(m_best_state.row.begin(), m_best_state.row.begin() + m_n);
+        for (int k = 0; k < m_num_stacks; ++k) {
+            const int first = m_best_state.stack[k] * m_cols_per_block;
+            for (int l = 0; l < m_cols_per_block; ++l) {
+                tr.col.push_back(m_best_state.col[first + l]);
+            }
+        }
+        tr.digit.assign(m_best_state.label.begin(), m_best_state.label.begin() + m_n + 1);
+        return tr;
+    }
+
+  private:
+    static constexpr int s_none        = INT32_MAX;
+    static constexpr uint8_t s_new_tok = UINT8_MAX;    // token of a new digit
+
+    const int m_n;
+    const int m_rows_per_block;
+    const int m_cols_per_block;
+    const int m_num_stacks;
+    const vector<uint8_t>* m_g{nullptr};
+    bool m_transposed{false};
+    uint32_t m_empty_rows{0};     // bit r: source row r is empty
+    uint32_t m_empty_bands{0};    // bit b: all rows of source band b are empty
+
+    vector<uint8_t> m_best;    // smallest grid found so far (UINT8_MAX: none yet)
+    vector<uint8_t> m_cur;     // grid of the current partial arrangement
+    int m_diverge{s_none};     // first row with m_cur < m_best (s_none: equal so far)
+
+    bool m_best_transposed{false};
+    State m_best_state;
+
+    // ranges [first, last) to branch on: col positions or result stacks
+    struct Branch {
+        bool stacks;
+        int first;
+        int last;
+    };
+
+    // choose the source row of result row i
+    void next_row(State& st, int i) {
+        if (i == m_n) {
+            if (m_diverge != s_none) {    // smaller than the best arrangement so far
+                m_best            = m_cur;
+                m_best_transposed = m_transposed;
+                m_best_state      = st;
+            }
+            m_diverge = s_none;    // m_cur equals m_best now
+            return;
+        }
+
+        // empty rows of one band and empty bands can be swapped without changing the
+        // grid: try only the first of them
+        uint32_t empty_tried      = 0;    // bit b: an empty row of band b was tried
+        bool empty_band_tried     = false;
+        const bool new_band = (i % m_rows_per_block == 0);
+        for (int r = 0; r < m_n; ++r) {
+            if (st.rows_used & (uint32_t{1} << r)) continue;
+            const int src_band = r / m_rows_per_block;
+            if (new_band ? (st.bands_used & (uint32_t{1} << src_band)) != 0
+                         : src_band != st.band) {
+                continue;
+            }
+            if (m_empty_rows & (uint32_t{1} << r)) {
+                const bool empty_band = (m_empty_bands & (uint32_t{1} << src_band)) != 0;
+                if ((empty_tried & (uint32_t{1} << src_band)) ||
+                    (empty_band && empty_band_tried)) {
+                    continue;
+                }
+                empty_tried |= uint32_t{1} << src_band;
+                empty_band_tried |= empty_band;
+            }
+            place_row(st, i, r);
+            if (m_diverge >= i) m_diverge = s_none;    // row i is chosen anew
+        }
+    }
+
+    // enter source row r as result row i: refine the order of cols and stacks, compare
+    // with the best arrangement and branch on the orders involving new digits
+    void place_row(const State& st, int i, int r) {
+        const uint8_t* src = m_g->data() + r * m_n;
+        const int cpb      = m_cols_per_block;
+
+        State ns = st;
+        std::array<uint8_t, max_size> tok;    // sorted tokens of each source stack
+        std::array<Branch, max_size> branch;
+        int num_branch = 0;
+
+        // sort the cols within their cells (per source stack)
+        for (int a = 0; a < m_n;) {
+            int b = a + 1;
+            while (b < m_n && !(st.cell_start & (uint32_t{1} << b))) ++b;
+
+            int k          = a;
+            int num_fresh  = 0;
+            std::array<uint8_t, max_size> fresh;
+            for (int l = a; l < b; ++l) {
+                if (src[st.col[l]] == 0) {
+                    ns.col[k] = st.col[l];
+                    tok[k++]  = 0;
+                }
+            }
+            const int first_seen = k;
+            for (int l = a; l < b; ++l) {
+                const int v = src[st.col[l]];
+                if (v == 0) continue;
+                if (st.label[v] == 0) {
+                    fresh[num_fresh++] = st.col[l];
+                    continue;
+                }
+                int m = k++;    // insertion sort by label
+                while (m > first_seen && tok[m - 1] > st.label[v]) {
+                    ns.col[m] = ns.col[m - 1];
+                    tok[m]    = tok[m - 1];
+                    --m;
+                }
+                ns.col[m] = st.col[l];
+                tok[m]    = st.label[v];
+            }
+            for (int m = first_seen; m < k; ++m) ns.cell_start |= uint32_t{1} << m;
+            if (num_fresh >= 2) branch[num_branch++] = {false, k, k + num_fresh};
+            for (int e = 0; e < num_fresh; ++e, ++k) {
+                ns.col[k] = fresh[e];
+                tok[k]    = s_new_tok;
+                ns.cell_start |= uint32_t{1} << k;
+            }
+            a = b;
+        }
+
+        // sort the stacks within their cells by their tokens
+        auto tokens_less = [&](uint8_t x, uint8_t y) {
+            const uint8_t* tx = tok.data() + x * cpb;
+            const uint8_t* ty = tok.data() + y * cpb;
+            return lexicographical_compare(tx, tx + cpb, ty, ty + cpb);
+        };
+        auto tokens_equal = [&](uint8_t x, uint8_t y) {
+            const uint8_t* tx = tok.data() + x * cpb;
+            return equal(tx, tx + cpb, tok.data() + y * cpb);
+        };
+        for (int a = 0; a < m_num_stacks;) {
+            int b = a + 1;
+            while (b < m_num_stacks && !(st.stack_cell_start & (uint32_t{1} << b))) ++b;
+            if (b - a > 1) {
+                stable_sort(ns.stack.begin() + a, ns.stack.begin() + b, tokens_less);
+                for (int k = a; k < b;) {
+                    int e = k + 1;
+                    while (e < b && tokens_equal(ns.stack[k], ns.stack[e])) ++e;
+                    const bool empty = (tok[ns.stack[k] * cpb + cpb - 1] == 0);
+                    if (empty) {
+                        ns.stack_cell_start |= uint32_t{1} << k;    // stays a cell
+                    }
+                    else {
+                        for (int m = k; m < e; ++m) {
+                            ns.stack_cell_start |= uint32_t{1} << m;
+                        }
+                        if (e - k >= 2) branch[num_branch++] = {true, k, e};
+                    }
+                    k = e;
+                }
+            }
+            a = b;
+        }
+
+        // row i of the arrangement (new digits labelled in col order)
+        uint8_t* out = m_cur.data() + i * m_n;
+        int label    = st.next_label;
+        for (int k = 0; k < m_num_stacks; ++k) {
+            for (int l = 0; l < cpb; ++l) {
+                const uint8_t t = tok[ns.stack[k] * cpb + l];
+                *out++          = (t == s_new_tok) ? static_cast<uint8_t>(label++) : t;
+            }
+        }
+
+        // compare row i with the best arrangement
+        if (m_diverge > i) {
+            const uint8_t* cur  = m_cur.data() + i * m_n;
+            const uint8_t* best = m_best.data() + i * m_n;
+            int j               = 0;
+            while (j < m_n && cur[j] == best[j]) ++j;
+            if (j < m_n) {
+                if (cur[j] > best[j]) return;    // larger: prune
+                m_diverge = i;
+            }
+        }
+
+        ns.row[i] = static_cast<int8_t>(r);
+        ns.rows_used |= uint32_t{1} << r;
+        if (i % m_rows_per_block == 0) {
+            ns.band = r / m_rows_per_block;
+            ns.bands_used |= uint32_t{1} << ns.band;
+        }
+        branch_fresh(ns, i, r, branch, 0, num_branch);
+    }
+
+    // all orders within the ranges branch[k..num_branch)
+    void branch_fresh(State& st, int i, int r, std::array<Branch, max_size>& branch,
+                      int k, int num_branch) {
+        if (k == num_branch) {
+            // label the new digits in col order (undone afterwards)
+            const uint8_t* src    = m_g->data() + r * m_n;
+            const int first_label = st.next_label;
+            for (int s = 0; s < m_num_stacks; ++s) {
+                const int first = st.stack[s] * m_cols_per_block;
+                for (int l = first; l < first + m_cols_per_block; ++l) {
+                    const int v = src[st.col[l]];
+                    if (v != 0 && st.label[v] == 0) st.label[v] = st.next_label++;
+                }
+            }
+            next_row(st, i + 1);
+            for (int l = 0; l < m_n; ++l) {
+                const int v = src[l];
+                if (v != 0 && st.label[v] >= first_label) st.label[v] = 0;
+            }
+            st.next_label = first_label;
+            return;
+        }
+        auto& seq = branch[k].stacks ? st.stack : st.col;
+        auto [stacks, first, last] = branch[k];
+        sort(seq.begin() + first, seq.begin() + last);
+        do {
+            branch_fresh(st, i, r, branch, k + 1, num_branch);
+        } while (next_permutation(seq.begin() + first, seq.begin() + last));
+    }
+};
+
+Sudoku_canonical sudoku_canonicalize(const Sudoku& s) {
+
+    const int n = s.region_size;
+    vector<uint8_t> g(s.values(), s.values() + s.total_size);
+
+    Sudoku_canonicalizer canon(s);
+    canon.search(g, false);
+    if (s.blocks_per_row == s.blocks_per_col) {
+        vector<uint8_t> gt(s.total_size);
+        for (int r = 0; r < n; ++r) {
+            for (int c = 0; c < n; ++c) gt[c * n + r] = g[r * n + c];
+        }
+        canon.search(gt, true);
+    }
+
+    Sudoku_canonical res;
+    res.transform = canon.transform();
+    // digits not used in s: label them in ascending order after the used ones
+    int next = 1;
+    for (int v = 1; v <= n; ++v) next = max(next, res.transform.digit[v] + 1);
+    for (int v = 1; v <= n; ++v) {
+        if (res.transform.digit[v] == 0) res.transform.digit[v] = next++;
+    }
+    res.key = sudoku_canonical_key(sudoku_apply_transform(s, res.transform));
+    return res;
+}
+
+vector<Sudoku_canonical> sudoku_canonicalize_all(const vector<Sudoku>& v, int threads) {
+
+    const int num_threads =
+        threads > 0 ? threads : max(1, static_cast<int>(thread::hardware_concurrency()));
+
+    vector<Sudoku_canonical> res(v.size());
+    atomic<size_t> next{0};    // next sudoku to canonicalize (handed out one by one)
+    auto worker = [&]() {
+        for (size_t k = next++; k < v.size(); k = next++) {
+            res[k] = sudoku_canonicalize(v[k]);
+        }
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < num_threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    return res;
+}
+
+std::string sudoku_canonical_key(const Sudoku& s) {
+
+    std::string key = std::to_string(s.region_size) + ':' +
+                      std::to_string(s.blocks_per_row) + ':' +
+                      std::to_string(s.blocks_per_col) + ':';
+    key.reserve(key.size() + s.total_size);
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        const int v = s(cnt).val;
+        key += static_cast<char>(v < 10 ? '0' + v : 'A' + v - 10);
+    }
+    return key;
+}
+
+Sudoku_transform sudoku_identity_transform(const Sudoku& s) {
+
+    Sudoku_transform tr;
+    tr.row.resize(s.region_size);
+    tr.col.resize(s.region_size);
+    tr.digit.resize(s.region_size + 1);
+    iota(tr.row.begin(), tr.row.end(), 0);
+    iota(tr.col.begin(), tr.col.end(), 0);
+    iota(tr.digit.begin(), tr.digit.end(), 0);
+    return tr;
+}
+
+Sudoku_transform sudoku_inverse_transform(const Sudoku_transform& tr) {
+
+    // t(i, j) = d[s'(row[i], col[j])]  <=>  s'(r, c) = d^-1[t(row^-1[r], col^-1[c])],
+    // and with transposition s(r, c) = s'(c, r) = d^-1[t^T(row^-1[r], col^-1[c])]
+    // with rows and cols of the inverse swapped
+    const int n = static_cast<int>(tr.row.size());
+    vector<int> row_inv(n), col_inv(n);
+    for (int k = 0; k < n; ++k) {
+        row_inv[tr.row[k]] = k;
+        col_inv[tr.col[k]] = k;
+    }
+
+    Sudoku_transform inv;
+    inv.transpose = tr.transpose;
+    inv.row       = tr.transpose ? col_inv : row_inv;
+    inv.col       = tr.transpose ? row_inv : col_inv;
+    inv.digit.assign(tr.digit.size(), 0);
+    for (size_t v = 0; v < tr.digit.size(); ++v) {
+        inv.digit[tr.digit[v]] = static_cast<int>(v);
+    }
+    return inv;
+}
+
+Sudoku sudoku_apply_transform(const Sudoku& s, const Sudoku_transform& tr) {
+
+    const int n = s.region_size;
+    Sudoku t(s.region_size, s.blocks_per_row, s.blocks_per_col);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            const int r = tr.row[i];
+            const int c = tr.col[j];
+            const int v      = tr.transpose ? s(c * n + r).val : s(r * n + c).val;
+            t.set_value(i * n + j, tr.digit[v]);
+        }
+    }
+    sudoku_update_candidates_all_cells(t);
+    return t;
+}
@@ -0,0 +1,65 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_check_pool.h"
+
+using namespace std;
+
+Sudoku_check_pool::Sudoku_check_pool(int t_threads) :
+    m_threads(t_threads > 0 ? t_threads
+                            : max(1, static_cast<int>(thread::hardware_concurrency()))) {
+
+    for (int t = 1; t < m_threads; ++t) m_workers.emplace_back([this] { work(); });
+}
+
+Sudoku_check_pool::~Sudoku_check_pool() {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_workers) t.join();
+}
+
+void Sudoku_check_pool::run(int n, const std::function<void(int)>& task) {
+
+    if (m_workers.empty() || n <= 1) {    // nothing to share
+        for (int k = 0; k < n; ++k) task(k);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_task      = &task;
+        m_num_tasks = n;
+        m_next      = 0;
+        m_busy      = static_cast<int>(m_workers.size());
+        ++m_batch;
+    }
+    m_wake.notify_all();
+
+    for (int k = m_next++; k < n; k = m_next++) task(k);
+
+    // task must stay alive until every worker is done with it
+    unique_lock<mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busy == 0; });
+    m_task = nullptr;
+}
+
+void Sudoku_check_pool::work() {
+
+    long seen = 0;    // last batch taken part in
+    unique_lock<mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [&] { return m_stop || m_batch != seen; });
+        if (m_stop) return;
+        seen                                 = m_batch;
+        const std::function<void(int)>& task = *m_task;
+        const int n                          = m_num_tasks;
+
+        lock.unlock();
+        for (int k = m_next++; k < n; k = m_next++) task(k);
+        lock.lock();
+
+        if (--m_busy == 0) m_done.notify_one();
+    }
+}
@@ -0,0 +1,511 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_canonical.h"
+#include "sudoku_generate.h"
+#include "sudoku_line.h"
+#include "sudoku_metrics.h"
+#include "sudoku_minimize.h"
+#include "sudoku_service.h"
+#include "sudoku_solve_cache.h"
+#include "sudoku_stream.h"
+
+#include <atomic>
+#include <charconv>    // from_chars()
+#include <chrono>
+#include <cmath>    // isfinite()
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>    // strtol(), strtod()
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>     // open()
+#include <unistd.h>    // STDIN_FILENO, STDOUT_FILENO
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// command line front end without GUI
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static std::atomic<bool> stop_requested{false};
+
+extern "C" void on_signal(int) { stop_requested = true; }
+
+static void usage() {
+    std::cerr << "usage: sudoku_cli --serve <socket path> [--threads N] [--batch N]"
+                 " [--engine E]\n"
+                 "                  [--queue N] [--priority interactive|batch]"
+                 " [--deadline MS]\n"
+                 "                  [--interactive-burst N]\n"
+                 "       sudoku_cli --stream [--threads N] [--batch N] [--engine E]"
+                 " [--window N]\n"
+                 "                  [--input FILE] [--output FILE] [--checkpoint FILE]"
+                 " [--checkpoint-interval S]\n"
+                 "       sudoku_cli --generate <shape> [--clues N] [--tier T]"
+                 " [--max-technique M]\n"
+                 "                  [--symmetry Y] [--seed N] [--threads N]"
+                 " [--output FILE]\n"
+                 "       sudoku_cli --minimize [--shuffle] [--seed N] [--threads N]"
+                 " [--input FILE]\n"
+                 "                  [--output FILE]\n"
+                 "       sudoku_cli --canonical [--threads N] [--input FILE]"
+                 " [--output FILE]\n"
+                 "--serve, --stream: [--metrics FILE] [--report-interval S] [--cache N]"
+                 " [--cache-file FILE]\n"
+                 "with E one of recursive, mixed, sat, logic, portfolio, batch\n"
+                 "--stream: puzzles from stdin, one per line, results to stdout in input"
+                 " order\n"
+                 "--checkpoint: resume an interrupted run (output must be a file)\n"
+                 "--metrics: latency & throughput in the Prometheus text format\n"
+                 "--cache: solution cache of N puzzles (equivalent puzzles share an"
+                 " entry)\n"
+                 "--cache-file: warm the cache from FILE (if it exists), save it there"
+                 " at the end\n"
+                 "--generate: puzzle with a unique solution in the format of"
+                 " input/sudoku.in\n"
+                 "  shape: region size (4, 6, 9, 16, 25) or <size>:<blocks per row>:"
+                 "<blocks per col>\n"
+                 "  M: single, hidden-single, twin, ... (hardest logic technique"
+                 " allowed)\n"
+                 "  T: einsteiger, einfach, mittel, standard, hardest;"
+                 " Y: none, rotational, mirror\n"
+                 "--minimize: puzzles from stdin, one per line, minimal puzzles to"
+                 " stdout\n"
+                 "  (\"minimal <puzzle>\", \"nonunique -\" or \"invalid -\" per line;"
+                 " --shuffle: clues\n"
+                 "  tried in random order)\n"
+                 "--canonical: puzzles from stdin, one per line, their canonical keys"
+                 " to stdout\n"
+                 "  (\"invalid\" for lines that are no valid puzzle; equal keys:"
+                 " equivalent puzzles)\n";
+}
+
+static bool parse_engine(std::string_view name, Sudoku_engine_t& engine) {
+    if (name == "recursive") engine = Sudoku_engine_t::recursive;
+    else if (name == "mixed") engine = Sudoku_engine_t::mixed;
+    else if (name == "sat") engine = Sudoku_engine_t::sat;
+    else if (name == "logic") engine = Sudoku_engine_t::logic;
+    else if (name == "portfolio") engine = Sudoku_engine_t::portfolio;
+    else if (name == "batch") engine = Sudoku_engine_t::batch;
+    else return false;
+    return true;
+}
+
+// positive number of arg, or 0 if arg isn't one
+static long parse_count(const char* arg) {
+    char* end    = nullptr;
+    const long n = std::strtol(arg, &end, 10);
+    return (end != arg && *end == '\0' && n > 0) ? n : 0;
+}
+
+// positive, finite number of seconds, e.g. "0.5"
+static bool parse_seconds(const char* arg, double& seconds) {
+    char* end      = nullptr;
+    const double s = std::strtod(arg, &end);
+    if (end == arg || *end != '\0' || !std::isfinite(s) || s <= 0.0) return false;
+    seconds = s;
+    return true;
+}
+
+// shape "<region_size>" (default blocks: 2x2, 2x3, 3x3, 4x4, 5x5) or
+// "<region_size>:<blocks_per_row>:<blocks_per_col>"
+static bool parse_shape(std::string_view arg, int shape[3]) {
+    const char* first = arg.data();
+    const char* last  = arg.data() + arg.size();
+    int n             = 0;    // numbers read
+    while (n < 3) {
+        const auto [ptr, ec] = std::from_chars(first, last, shape[n++]);
+        if (ec != std::errc() || ptr == last) {
+            first = ptr;
+            break;
+        }
+        if (*ptr != ':' || n == 3) return false;
+        first = ptr + 1;
+    }
+    if (first != last || (n != 1 && n != 3)) return false;
+
+    if (n == 1) {
+        switch (shape[0]) {
+            case 4: shape[1] = shape[2] = 2; break;
+            case 6:
+                shape[1] = 2;
+                shape[2] = 3;
+                break;
+            case 9: shape[1] = shape[2] = 3; break;
+            case 16: shape[1] = shape[2] = 4; break;
+            case 25: shape[1] = shape[2] = 5; break;
+            default: return false;
+        }
+    }
+    return shape[0] > 0 && shape[0] <= sudoku_max_region_size && shape[1] > 0 &&
+           shape[0] % shape[1] == 0 && shape[0] / shape[1] == shape[2];
+}
+
+// name of Sudoku_solution_type with '-' for blanks, e.g. "hidden-single"
+static bool parse_technique(std::string_view name, Sudoku_solution_t& technique) {
+    for (const auto& [t, type_name] : Sudoku_solution_type) {
+        std::string dashed = type_name;
+        for (char& c : dashed) {
+            if (c == ' ') c = '-';
+        }
+        if (name == dashed) {
+            technique = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_tier(std::string_view name, Sudoku_generate_options& opt) {
+    for (auto tier : {Sudoku_tier_t::einsteiger, Sudoku_tier_t::einfach,
+                      Sudoku_tier_t::mittel, Sudoku_tier_t::standard,
+                      Sudoku_tier_t::hardest}) {
+        if (name == sudoku_tier_name(tier)) {
+            opt.tier = tier;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_symmetry(std::string_view name, Sudoku_symmetry_t& symmetry) {
+    if (name == "none") symmetry = Sudoku_symmetry_t::none;
+    else if (name == "rotational") symmetry = Sudoku_symmetry_t::rotational;
+    else if (name == "mirror") symmetry = Sudoku_symmetry_t::mirror;
+    else return false;
+    return true;
+}
+
+// any number (0 included) for seeds
+static bool parse_seed(std::string_view arg, std::uint64_t& seed) {
+    const auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), seed);
+    return ec == std::errc() && ptr == arg.data() + arg.size();
+}
+
+static int serve(const Sudoku_service_options& opt) {
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    Sudoku_service service(opt);
+    if (!service.start()) {
+        std::cerr << "sudoku_cli: " << service.error() << '\n';
+        return 1;
+    }
+    while (!stop_requested) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    service.stop();
+
+    const auto st = service.stats();
+    std::cerr << "connections: " << st.connections << " (rejected: " << st.rejected
+              << "), requests: " << st.requests << " (solved: " << st.solved
+              << ", unsolvable: " << st.unsolvable << ", unsolved: " << st.unsolved
+              << ", invalid: " << st.invalid << ", expired: " << st.expired
+              << ", dropped: " << st.dropped << "), batches: " << st.batches << '\n';
+    static const char* const class_name[] = {"interactive", "batch"};
+    for (int c = 0; c < sudoku_num_priorities; ++c) {
+        const auto& cs = st.scheduler.cls[c];
+        std::cerr << class_name[c] << ": queued: " << cs.queued
+                  << ", dispatched: " << cs.dispatched
+                  << ", deadline misses in queue: " << cs.expired
+                  << ", wait mean: " << cs.wait_us_mean()
+                  << " us, max: " << cs.wait_us_max << " us\n";
+    }
+    return 0;
+}
+
+static int stream(const Sudoku_stream_options& opt, const std::string& input,
+                  const std::string& output) {
+
+    // with checkpoints the output is cut back to the checkpoint instead of truncated
+    const int in_fd = input.empty() ? STDIN_FILENO : ::open(input.c_str(), O_RDONLY);
+    const int out_fd =
+        output.empty()
+            ? STDOUT_FILENO
+            : ::open(output.c_str(),
+                     O_WRONLY | O_CREAT | (opt.checkpoint_path.empty() ? O_TRUNC : 0),
+                     0644);
+    if (in_fd < 0 || out_fd < 0) {
+        std::cerr << "sudoku_cli: can't open " << (in_fd < 0 ? input : output) << '\n';
+        return 1;
+    }
+
+    Sudoku_stream_stats st;
+    const bool ok = sudoku_solve_stream(in_fd, out_fd, opt, st);
+    if (!ok) std::cerr << "sudoku_cli: reading, writing or checkpoint failed\n";
+    std::cerr << "records: " << st.records << " (solved: " << st.solved
+              << ", unsolvable: " << st.unsolvable << ", unsolved: " << st.unsolved
+              << ", invalid: " << st.invalid << "), resumed after: " << st.resumed
+              << ", checkpoints: " << st.checkpoints << '\n';
+    return ok ? 0 : 1;
+}
+
+static int generate(const int shape[3], const Sudoku_generate_options& opt,
+                    const std::string& output) {
+
+    Sudoku_generate_stats st;
+    const auto p = sudoku_generate(shape[0], shape[1], shape[2], opt, st);
+    if (!p) {
+        std::cerr << "sudoku_cli: no puzzle meeting the limits in " << st.attempts
+                  << " attempts\n";
+        return 1;
+    }
+
+    if (output.empty()) sudoku_write(std::cout, *p);
+    else {
+        std::ofstream os(output, std::ios::trunc);
+        sudoku_write(os, *p);
+        os.flush();
+        if (!os) {
+            std::cerr << "sudoku_cli: can't write " << output << '\n';
+            return 1;
+        }
+    }
+    std::cerr << "clues: " << sudoku_num_entries(*p)
+              << ", tier: " << sudoku_tier_name(sudoku_rate(*p).tier)
+              << ", attempts: " << st.attempts << ", checks: " << st.checks << '\n';
+    return 0;
+}
+
+// run convert on chunks of the puzzles read from input (stdin if empty), one per line
+// (empty optional: not in the format of sudoku_line.h), appending its output lines to
+// out, which is written to output (stdout if empty)
+template <typename F>
+static int convert_lines(const std::string& input, const std::string& output,
+                         F&& convert) {
+
+    constexpr std::size_t chunk_size = 1024;    // puzzles converted at once
+
+    std::ifstream in_file;
+    std::ofstream out_file;
+    if (!input.empty()) in_file.open(input);
+    if (!output.empty()) out_file.open(output, std::ios::trunc);
+    if ((!input.empty() && !in_file) || (!output.empty() && !out_file)) {
+        std::cerr << "sudoku_cli: can't open " << (!in_file ? input : output) << '\n';
+        return 1;
+    }
+    std::istream& is = input.empty() ? std::cin : in_file;
+    std::ostream& os = output.empty() ? std::cout : out_file;
+
+    std::vector<std::optional<Sudoku>> puzzles;
+    std::string line, out;
+    bool more = true;
+    while (more) {
+        more = static_cast<bool>(std::getline(is, line));
+        if (more) puzzles.push_back(sudoku_from_line(line));
+        if (puzzles.size() == chunk_size || (!more && !puzzles.empty())) {
+            convert(puzzles, out);
+            os << out;
+            out.clear();
+            puzzles.clear();
+        }
+    }
+    os.flush();
+    if (is.bad() || !os) {
+        std::cerr << "sudoku_cli: reading or writing failed\n";
+        return 1;
+    }
+    return 0;
+}
+
+static int minimize(const Sudoku_minimize_options& opt, const std::string& input,
+                    const std::string& output) {
+
+    Sudoku_minimize_stats st;
+    long records = 0, minimal = 0, nonunique = 0, invalid = 0;
+    std::vector<Sudoku> valid;
+    const int rc = convert_lines(input, output, [&](auto& puzzles, std::string& out) {
+        valid.clear();
+        for (const auto& p : puzzles) {
+            if (p && sudoku_is_valid(*p)) valid.push_back(*p);
+        }
+        const auto minimized = sudoku_minimize_all(valid, opt, st);
+        std::size_t k        = 0;
+        for (const auto& p : puzzles) {
+            ++records;
+            if (!p || !sudoku_is_valid(*p)) {
+                out += "invalid -\n";
+                ++invalid;
+            }
+            else if (const auto& m = minimized[k++]) {
+                out += "minimal ";
+                sudoku_append_line(out, *m);
+                out += '\n';
+                ++minimal;
+            }
+            else {    // no solution or several
+                out += "nonunique -\n";
+                ++nonunique;
+            }
+        }
+    });
+    std::cerr << "records: " << records << " (minimal: " << minimal
+              << ", nonunique: " << nonunique << ", invalid: " << invalid
+              << "), clues removed: " << st.removals << ", checks: " << st.checks
+              << '\n';
+    return rc;
+}
+
+static int canonical(int threads, const std::string& input, const std::string& output) {
+
+    long records = 0, invalid = 0;
+    std::vector<Sudoku> valid;
+    const int rc = convert_lines(input, output, [&](auto& puzzles, std::string& out) {
+        valid.clear();
+        for (const auto& p : puzzles) {
+            if (p && sudoku_is_valid(*p)) valid.push_back(*p);
+        }
+        const auto canon = sudoku_canonicalize_all(valid, threads);
+        std::size_t k    = 0;
+        for (const auto& p : puzzles) {
+            ++records;
+            if (p && sudoku_is_valid(*p)) out += canon[k++].key;
+            else {
+                out += "invalid";
+                ++invalid;
+            }
+            out += '\n';
+        }
+    });
+    std::cerr << "records: " << records << " (invalid: " << invalid << ")\n";
+    return rc;
+}
+
+int main(int argc, char* argv[]) {
+
+    Sudoku_service_options serve_opt;
+    Sudoku_stream_options stream_opt;
+    Sudoku_generate_options generate_opt;
+    Sudoku_minimize_options minimize_opt;
+    bool streaming      = false;
+    bool minimizing     = false;
+    bool canonical_keys = false;
+    int threads         = 0;    // of --canonical (0: all cores)
+    int shape[3]        = {0, 0, 0};    // of --generate (0: not generating)
+    std::string input, output;    // files of the modes (default: stdin, stdout)
+    std::string metrics_path;     // Prometheus text file
+    long report_interval = 10;    // seconds
+    long cache_capacity  = 0;     // entries of the solution cache (0: none)
+    std::string cache_path;       // cache file (load at start, save at end)
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--stream" || arg == "--minimize" || arg == "--canonical" ||
+            arg == "--shuffle") {    // flags
+            if (arg == "--stream") streaming = true;
+            else if (arg == "--minimize") minimizing = true;
+            else if (arg == "--canonical") canonical_keys = true;
+            else minimize_opt.shuffle = true;
+            continue;
+        }
+        if (i + 1 == argc) {
+            usage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        long n            = 0;
+        if (arg == "--serve") serve_opt.socket_path = value;
+        else if (arg == "--generate" && parse_shape(value, shape)) {}
+        else if (arg == "--threads" && (n = parse_count(value)) > 0) {
+            serve_opt.threads = stream_opt.threads = n;
+            generate_opt.threads = minimize_opt.threads = threads = n;
+        }
+        else if (arg == "--batch" && (n = parse_count(value)) > 0) {
+            serve_opt.batch_size = stream_opt.batch_size = n;
+        }
+        else if (arg == "--engine" && parse_engine(value, serve_opt.engine)) {
+            stream_opt.engine = serve_opt.engine;
+        }
+        else if (arg == "--window" && (n = parse_count(value)) > 0) stream_opt.window = n;
+        else if (arg == "--input") input = value;
+        else if (arg == "--output") output = value;
+        else if (arg == "--checkpoint") stream_opt.checkpoint_path = value;
+        else if (arg == "--metrics") metrics_path = value;
+        else if (arg == "--cache" && (n = parse_count(value)) > 0) cache_capacity = n;
+        else if (arg == "--cache-file") cache_path = value;
+        else if (arg == "--report-interval" && (n = parse_count(value)) > 0) {
+            report_interval = n;
+        }
+        else if (arg == "--checkpoint-interval" &&
+                 parse_seconds(value, stream_opt.checkpoint_interval)) {}
+        else if (arg == "--queue" && (n = parse_count(value)) > 0) {
+            serve_opt.queue_capacity = n;
+        }
+        else if (arg == "--priority" && std::string_view(value) == "interactive") {
+            serve_opt.priority = Sudoku_priority_t::interactive;
+        }
+        else if (arg == "--priority" && std::string_view(value) == "batch") {
+            serve_opt.priority = Sudoku_priority_t::batch;
+        }
+        else if (arg == "--deadline" && (n = parse_count(value)) > 0) {
+            serve_opt.deadline_ms = n;
+        }
+        else if (arg == "--interactive-burst" && (n = parse_count(value)) > 0) {
+            serve_opt.interactive_burst = n;
+        }
+        else if (arg == "--clues" && (n = parse_count(value)) > 0) {
+            generate_opt.target_clues = n;
+        }
+        else if (arg == "--tier" && parse_tier(value, generate_opt)) {}
+        else if (arg == "--max-technique" &&
+                 parse_technique(value, generate_opt.max_technique)) {}
+        else if (arg == "--symmetry" && parse_symmetry(value, generate_opt.symmetry)) {}
+        else if (arg == "--seed" && parse_seed(value, generate_opt.seed)) {
+            minimize_opt.seed = generate_opt.seed;
+        }
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    // exactly one mode
+    const int modes = int(streaming) + int(!serve_opt.socket_path.empty()) +
+                      int(shape[0] > 0) + int(minimizing) + int(canonical_keys);
+    if (modes != 1) {
+        usage();
+        return 1;
+    }
+    if (shape[0] > 0) return generate(shape, generate_opt, output);
+    if (minimizing) return minimize(minimize_opt, input, output);
+    if (canonical_keys) return canonical(threads, input, output);
+
+    // solution cache of both modes (a cache file alone: default capacity)
+    std::optional<Sudoku_solution_cache> cache;
+    if (cache_capacity > 0) cache.emplace(static_cast<std::size_t>(cache_capacity));
+    else if (!cache_path.empty()) cache.emplace();
+    if (cache) {
+        serve_opt.cache = stream_opt.cache = &*cache;
+        if (!cache_path.empty()) {
+            const int loaded = cache->load(cache_path);
+            std::cerr << "cache: " << (loaded < 0 ? 0 : loaded) << " entries loaded\n";
+        }
+    }
+
+    // solve latencies of both modes, reported to stderr and metrics_path
+    Sudoku_metrics metrics;
+    serve_opt.metrics  = &metrics;
+    stream_opt.metrics = &metrics;
+    Sudoku_metrics_reporter reporter(metrics, std::cerr, metrics_path,
+                                     std::chrono::seconds(report_interval));
+
+    int rc = streaming ? stream(stream_opt, input, output) : serve(serve_opt);
+    if (!reporter.stop()) {
+        std::cerr << "sudoku_cli: can't write " << metrics_path << '\n';
+        rc = 1;
+    }
+    if (cache) {
+        const auto cs = cache->stats();
+        std::cerr << "cache: " << cache->size() << " entries, hits: " << cs.hits
+                  << ", misses: " << cs.misses << " (rejected entries: " << cs.rejected
+                  << "), evictions: " << cs.evictions << '\n';
+        if (!cache_path.empty() && !cache->save(cache_path)) {
+            std::cerr << "sudoku_cli: can't write " << cache_path << '\n';
+            rc = 1;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,70 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_file.h"
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#if defined(_WIN32)
+
+bool sudoku_replace_file(const std::string& path, std::string_view data) {
+
+    // write to a temporary file first: a crash while writing leaves the old file
+    const string tmp_path = path + ".tmp";
+    {
+        ofstream os(tmp_path, ios::binary | ios::trunc);
+        os.write(data.data(), static_cast<streamsize>(data.size()));
+        if (!os.flush()) return false;
+    }
+    error_code ec;
+    filesystem::rename(tmp_path, path, ec);    // replaces an existing file
+    return !ec;
+}
+
+#else
+
+static bool write_all(int fd, string_view data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool sudoku_replace_file(const std::string& path, std::string_view data) {
+
+    // write to a temporary file first: a crash while writing leaves the old file
+    const string tmp_path = path + ".tmp";
+    const int fd =
+        ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    const bool ok = write_all(fd, data) && ::fsync(fd) == 0;
+    if (::close(fd) != 0 || !ok) return false;
+
+    if (::rename(tmp_path.c_str(), path.c_str()) != 0) return false;
+
+    // make the rename itself durable
+    const string dir = filesystem::path(path).parent_path().string();
+    const int dir_fd = ::open(dir.empty() ? "." : dir.c_str(),
+                              O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) return false;
+    const bool synced = ::fsync(dir_fd) == 0;
+    ::close(dir_fd);
+    return synced;
+}
+
+#endif
@@ -0,0 +1,191 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_generate.h"
+#include "sudoku_check_pool.h"
+#include "sudoku_rate.h"
+
+#include <algorithm>    // shuffle()
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// random full solution
+//////////////////////////////////////////////////////////////////////////////////////////
+// depth first search with randomized value order; gives up after node_limit nodes
+static bool fill_random(Sudoku& s, mt19937_64& rng, long& nodes, long node_limit) {
+
+    if (++nodes > node_limit) return false;
+
+    // branch on the empty cell with the fewest candidates
+    int cnt      = -1;
+    int min_cand = s.region_size + 1;
+    for (int c = 0; c < s.total_size; ++c) {
+        if (s(c).val != 0) continue;
+        const int num_cand = s(c).cand.size();
+        if (num_cand < min_cand) {
+            min_cand = num_cand;
+            cnt      = c;
+        }
+    }
+    if (cnt < 0) return true;    // all cells filled
+
+    vector<int> values(s(cnt).cand.begin(), s(cnt).cand.end());
+    shuffle(values.begin(), values.end(), rng);
+
+    for (int v : values) {
+        Sudoku s_try   = s;
+        s_try.set_value(cnt, v);
+        sudoku_update_candidates_peers_of_cell(s_try, cnt);
+        if (fill_random(s_try, rng, nodes, node_limit)) {
+            s = std::move(s_try);
+            return true;
+        }
+        if (nodes > node_limit) return false;
+    }
+    return false;
+}
+
+Sudoku sudoku_generate_solution(int region_size, int blocks_per_row, int blocks_per_col,
+                                std::mt19937_64& rng) {
+
+    // rare unlucky runs of the search on large shapes are restarted with a growing
+    // node limit instead of exploring a dead subtree exhaustively
+    for (long node_limit = 16L * region_size * region_size;; node_limit *= 2) {
+        Sudoku s(region_size, blocks_per_row, blocks_per_col);
+        long nodes = 0;
+        if (fill_random(s, rng, nodes, node_limit)) return s;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// generate puzzle
+//////////////////////////////////////////////////////////////////////////////////////////
+// groups of cells removed together (in random order)
+static vector<vector<int>> removal_groups(const Sudoku& s, Sudoku_symmetry_t symmetry,
+                                          mt19937_64& rng) {
+
+    const int rs = s.region_size;
+    vector<vector<int>> groups;
+    vector<bool> grouped(s.total_size, false);
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        if (grouped[cnt]) continue;
+        int partner = cnt;
+        switch (symmetry) {
+            case Sudoku_symmetry_t::none:
+                break;
+            case Sudoku_symmetry_t::rotational:
+                partner = s.total_size - 1 - cnt;
+                break;
+            case Sudoku_symmetry_t::mirror:
+                partner = (cnt / rs) * rs + rs - 1 - cnt % rs;
+                break;
+        }
+        grouped[cnt] = grouped[partner] = true;
+        if (partner == cnt)
+            groups.push_back({cnt});
+        else
+            groups.push_back({cnt, partner});
+    }
+    shuffle(groups.begin(), groups.end(), rng);
+    return groups;
+}
+
+// puzzle p is acceptable during clue removal (rating first, it is much cheaper)
+static bool acceptable(const Sudoku& p, const Sudoku_generate_options& opt) {
+    if (opt.max_technique != Sudoku_solution_t::enum_count || opt.tier) {
+        const Sudoku_rating rating = sudoku_rate(p);
+        if (rating.hardest > opt.max_technique) return false;
+        if (opt.tier && rating.tier > *opt.tier) return false;
+    }
+    return sudoku_count_solutions(p, 2) == 1;
+}
+
+// remove clues from solution s as long as the puzzle stays acceptable
+static Sudoku remove_clues(Sudoku s, const Sudoku_generate_options& opt,
+                           Sudoku_check_pool& pool, mt19937_64& rng,
+                           Sudoku_generate_stats& stats) {
+
+    vector<vector<int>> pending = removal_groups(s, opt.symmetry, rng);
+    int clues                   = s.total_size;
+
+    auto remove_group = [](Sudoku& p, const vector<int>& group) {
+        for (int cnt : group) p.set_value(cnt, 0);
+        sudoku_reset_candidates_all_cells(p);
+    };
+
+    while (!pending.empty() && clues > opt.target_clues) {
+
+        // removals that would go below target_clues are dropped
+        const int max_removal = clues - opt.target_clues;
+        erase_if(pending, [&](const vector<int>& g) {
+            return static_cast<int>(g.size()) > max_removal;
+        });
+        if (pending.empty()) break;
+
+        // check the next removals in parallel (each against the current puzzle), keep
+        // the first one passing its check
+        stats.checks += sudoku_check_keep_first(
+            pool, pending,
+            [&](const vector<int>& group) {
+                Sudoku p = s;
+                remove_group(p, group);
+                return acceptable(p, opt);
+            },
+            [&](const vector<int>& group) {
+                remove_group(s, group);
+                clues -= static_cast<int>(group.size());
+                ++stats.removals;
+            });
+        ++stats.batches;
+    }
+
+    return s;
+}
+
+std::optional<Sudoku> sudoku_generate(int region_size, int blocks_per_row,
+                                      int blocks_per_col,
+                                      const Sudoku_generate_options& opt,
+                                      Sudoku_generate_stats& stats) {
+
+    Sudoku_check_pool pool(opt.threads);    // removal checks of all attempts
+    mt19937_64 rng(opt.seed);
+
+    for (int attempt = 0; attempt < opt.max_attempts; ++attempt) {
+        ++stats.attempts;
+        Sudoku solution =
+            sudoku_generate_solution(region_size, blocks_per_row, blocks_per_col, rng);
+        Sudoku puzzle = remove_clues(std::move(solution), opt, pool, rng, stats);
+
+        if (opt.target_clues > 0 && sudoku_num_entries(puzzle) > opt.target_clues) {
+            continue;    // target clue count not reached
+        }
+        const Sudoku_rating rating = sudoku_rate(puzzle);
+        if (rating.hardest < opt.min_technique) continue;    // too easy
+        if (opt.tier && rating.tier != *opt.tier) continue;
+        return puzzle;
+    }
+
+    return nullopt;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// write in input file format
+//////////////////////////////////////////////////////////////////////////////////////////
+void sudoku_write(std::ostream& os, const Sudoku& s) {
+
+    const int width = (s.region_size < 10) ? 1 : 2;
+
+    os << "### region size, blocks per row and blocks per col\n";
+    os << s.region_size << ' ' << s.blocks_per_row << ' ' << s.blocks_per_col << '\n';
+    os << "### rows (empty cells are 0)\n";
+    for (int i = 0; i < s.region_size; ++i) {
+        for (int j = 0; j < s.region_size; ++j) {
+            const int val = s(i * s.region_size + j).val;
+            if (j > 0) os << ' ';
+            if (width == 2 && val < 10) os << ' ';
+            os << val;
+        }
+        os << '\n';
+    }
+}
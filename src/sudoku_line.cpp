@@ -0,0 +1,93 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_line.h"
+#include "sudoku_solve.h"
+
+#include <charconv>    // from_chars()
+#include <tuple>
+
+using namespace std;
+
+// default shape for a no. of cells: (region_size, blocks_per_row, blocks_per_col)
+static optional<tuple<int, int, int>> default_shape(size_t num_cells) {
+    switch (num_cells) {
+        case 16: return make_tuple(4, 2, 2);
+        case 36: return make_tuple(6, 2, 3);
+        case 81: return make_tuple(9, 3, 3);
+        case 256: return make_tuple(16, 4, 4);
+        case 625: return make_tuple(25, 5, 5);
+        default: return nullopt;
+    }
+}
+
+// value of cell character c (0: empty), or -1 if c is no cell character
+static int cell_value(char c) {
+    if (c == '.' || c == '0') return 0;
+    if (c >= '1' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'P') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'p') return c - 'a' + 10;
+    return -1;
+}
+
+std::optional<Sudoku> sudoku_from_line(std::string_view line) {
+
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+        line.remove_suffix(1);
+    }
+
+    // optional shape prefix
+    int shape[3] = {0, 0, 0};
+    if (line.find(':') != string_view::npos) {
+        for (int k = 0; k < 3; ++k) {
+            const auto [ptr, ec] =
+                from_chars(line.data(), line.data() + line.size(), shape[k]);
+            if (ec != errc() || ptr == line.data() + line.size() || *ptr != ':') {
+                return nullopt;
+            }
+            line.remove_prefix(ptr - line.data() + 1);
+        }
+    }
+    else if (auto sh = default_shape(line.size())) {
+        tie(shape[0], shape[1], shape[2]) = *sh;
+    }
+    else {
+        return nullopt;
+    }
+
+    const auto [region_size, blocks_per_row, blocks_per_col] = shape;
+    if (region_size <= 0 || region_size > sudoku_max_region_size || blocks_per_row <= 0 ||
+        region_size % blocks_per_row != 0 ||
+        region_size / blocks_per_row != blocks_per_col ||
+        line.size() != static_cast<size_t>(region_size * region_size)) {
+        return nullopt;
+    }
+
+    Sudoku s(region_size, blocks_per_row, blocks_per_col);
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        const int v = cell_value(line[cnt]);
+        if (v < 0 || v > region_size) return nullopt;
+        s.set_value(cnt, v);
+    }
+    sudoku_update_candidates_all_cells(s);
+    return s;
+}
+
+void sudoku_append_line(std::string& out, const Sudoku& s) {
+
+    if (default_shape(s.total_size) !=
+        make_tuple(s.region_size, s.blocks_per_row, s.blocks_per_col)) {
+        out += to_string(s.region_size) + ':' + to_string(s.blocks_per_row) + ':' +
+               to_string(s.blocks_per_col) + ':';
+    }
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        const int v = s(cnt).val;
+        out += static_cast<char>(v < 10 ? '0' + v : 'A' + v - 10);
+    }
+}
+
+std::string sudoku_to_line(const Sudoku& s) {
+    string out;
+    out.reserve(s.total_size + 12);
+    sudoku_append_line(out, s);
+    return out;
+}
@@ -0,0 +1,253 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_metrics.h"
+#include "sudoku_file.h"
+
+#include <algorithm>    // max()
+#include <bit>          // bit_width()
+#include <cmath>        // ceil()
+
+#include <fmt/format.h>
+
+using namespace std;
+
+const char* sudoku_engine_name(Sudoku_engine_t engine) {
+    switch (engine) {
+        case Sudoku_engine_t::recursive: return "recursive";
+        case Sudoku_engine_t::mixed: return "mixed";
+        case Sudoku_engine_t::sat: return "sat";
+        case Sudoku_engine_t::logic: return "logic";
+        case Sudoku_engine_t::portfolio: return "portfolio";
+        case Sudoku_engine_t::batch: return "batch";
+    }
+    return "unknown";
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Sudoku_latency_histogram
+//////////////////////////////////////////////////////////////////////////////////////////
+
+int Sudoku_latency_histogram::bucket_of(std::uint64_t ns) {
+    if (ns < sub_buckets) return static_cast<int>(ns);
+    const int msb   = static_cast<int>(bit_width(ns)) - 1;    // >= sub_bucket_bits
+    const int shift = msb - sub_bucket_bits;
+    return (shift + 1) * sub_buckets + static_cast<int>(ns >> shift) - sub_buckets;
+}
+
+std::uint64_t Sudoku_latency_histogram::bucket_max(int b) {
+    if (b < sub_buckets) return static_cast<uint64_t>(b);
+    const int shift    = b / sub_buckets - 1;
+    const uint64_t low = static_cast<uint64_t>(sub_buckets + b % sub_buckets) << shift;
+    return low + ((uint64_t{1} << shift) - 1);
+}
+
+void Sudoku_latency_histogram::record(std::uint64_t ns) {
+    m_counts[bucket_of(ns)].fetch_add(1, memory_order_relaxed);
+    m_count.fetch_add(1, memory_order_relaxed);
+    m_sum_ns.fetch_add(ns, memory_order_relaxed);
+    uint64_t max_ns = m_max_ns.load(memory_order_relaxed);
+    while (ns > max_ns &&
+           !m_max_ns.compare_exchange_weak(max_ns, ns, memory_order_relaxed)) {}
+}
+
+Sudoku_latency_snapshot Sudoku_latency_histogram::snapshot() const {
+    Sudoku_latency_snapshot snap;
+    snap.counts.resize(num_buckets);
+    for (int b = 0; b < num_buckets; ++b) {
+        snap.counts[b] = m_counts[b].load(memory_order_relaxed);
+    }
+    snap.count  = m_count.load(memory_order_relaxed);
+    snap.sum_ns = m_sum_ns.load(memory_order_relaxed);
+    snap.max_ns = m_max_ns.load(memory_order_relaxed);
+    return snap;
+}
+
+std::uint64_t Sudoku_latency_snapshot::percentile(double q) const {
+    uint64_t total = 0;
+    for (auto c : counts) total += c;    // not count: consistent with the buckets read
+    if (total == 0) return 0;
+
+    const auto rank = max<uint64_t>(1, static_cast<uint64_t>(ceil(q * double(total))));
+    uint64_t seen   = 0;
+    for (size_t b = 0; b < counts.size(); ++b) {
+        seen += counts[b];
+        if (seen >= rank) {
+            return min(Sudoku_latency_histogram::bucket_max(static_cast<int>(b)), max_ns);
+        }
+    }
+    return max_ns;
+}
+
+void Sudoku_latency_snapshot::merge(const Sudoku_latency_snapshot& other) {
+    if (counts.size() < other.counts.size()) counts.resize(other.counts.size());
+    for (size_t b = 0; b < other.counts.size(); ++b) counts[b] += other.counts[b];
+    count += other.count;
+    sum_ns += other.sum_ns;
+    max_ns = max(max_ns, other.max_ns);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Sudoku_metrics
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static constexpr double report_quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+Sudoku_metrics::Sudoku_metrics() :
+    m_start(chrono::steady_clock::now()), m_interval_start(m_start) {}
+
+void Sudoku_metrics::print(std::ostream& os) const {
+
+    const double secs =
+        chrono::duration<double>(chrono::steady_clock::now() - m_start).count();
+
+    Sudoku_latency_snapshot all;
+    array<Sudoku_latency_snapshot, sudoku_num_engines> per_engine;
+    for (int e = 0; e < sudoku_num_engines; ++e) {
+        per_engine[e] = m_hist[e].snapshot();
+        all.merge(per_engine[e]);
+    }
+
+    os << fmt::format("puzzles: {} in {:.1f} s ({:.1f}/s)\n", all.count, secs,
+                      secs > 0 ? double(all.count) / secs : 0.0);
+    os << fmt::format("{:<10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}\n",
+                      "latency us", "count", "mean", "p50", "p90", "p99", "p999", "max");
+    auto line = [&](const char* name, const Sudoku_latency_snapshot& snap) {
+        os << fmt::format("{:<10} {:>10} {:>10.1f}", name, snap.count,
+                          snap.mean_ns() / 1e3);
+        for (double q : report_quantiles) {
+            os << fmt::format(" {:>10.1f}", double(snap.percentile(q)) / 1e3);
+        }
+        os << fmt::format(" {:>10.1f}\n", double(snap.max_ns) / 1e3);
+    };
+    line("all", all);
+    for (int e = 0; e < sudoku_num_engines; ++e) {
+        if (per_engine[e].count > 0) {
+            line(sudoku_engine_name(static_cast<Sudoku_engine_t>(e)), per_engine[e]);
+        }
+    }
+}
+
+void Sudoku_metrics::print_interval(std::ostream& os) {
+
+    Sudoku_latency_snapshot all;
+    for (const auto& h : m_hist) all.merge(h.snapshot());
+
+    const auto now = chrono::steady_clock::now();
+    lock_guard<mutex> lock(m_interval_mutex);
+    const double secs = chrono::duration<double>(now - m_interval_start).count();
+    const uint64_t n  = all.count - m_interval_count;
+    os << fmt::format("puzzles: {} (+{}, {:.1f}/s), latency us", all.count, n,
+                      secs > 0 ? double(n) / secs : 0.0);
+    static const char* const quantile_name[] = {"p50", "p90", "p99", "p999"};
+    for (int k = 0; k < 4; ++k) {
+        os << fmt::format(" {} {:.1f}", quantile_name[k],
+                          double(all.percentile(report_quantiles[k])) / 1e3);
+    }
+    os << fmt::format(" max {:.1f}\n", double(all.max_ns) / 1e3);
+    m_interval_start = now;
+    m_interval_count = all.count;
+}
+
+std::string Sudoku_metrics::prometheus_text() const {
+
+    const double secs =
+        chrono::duration<double>(chrono::steady_clock::now() - m_start).count();
+
+    array<Sudoku_latency_snapshot, sudoku_num_engines> per_engine;
+    uint64_t total = 0;
+    for (int e = 0; e < sudoku_num_engines; ++e) {
+        per_engine[e] = m_hist[e].snapshot();
+        total += per_engine[e].count;
+    }
+
+    string out;
+    out += "# HELP sudoku_uptime_seconds Time since the metrics were set up.\n"
+           "# TYPE sudoku_uptime_seconds gauge\n";
+    out += fmt::format("sudoku_uptime_seconds {:.3f}\n", secs);
+    out += "# HELP sudoku_puzzles_per_second Puzzles per second since the start.\n"
+           "# TYPE sudoku_puzzles_per_second gauge\n";
+    out += fmt::format("sudoku_puzzles_per_second {:.3f}\n",
+                       secs > 0 ? double(total) / secs : 0.0);
+
+    out += "# HELP sudoku_puzzles_total Puzzles solved or found unsolvable, per engine.\n"
+           "# TYPE sudoku_puzzles_total counter\n";
+    for (int e = 0; e < sudoku_num_engines; ++e) {
+        out += fmt::format("sudoku_puzzles_total{{engine=\"{}\"}} {}\n",
+                           sudoku_engine_name(static_cast<Sudoku_engine_t>(e)),
+                           per_engine[e].count);
+    }
+
+    out += "# HELP sudoku_solve_latency_seconds Solve latency per engine.\n"
+           "# TYPE sudoku_solve_latency_seconds summary\n";
+    for (int e = 0; e < sudoku_num_engines; ++e) {
+        const auto& snap = per_engine[e];
+        const char* name = sudoku_engine_name(static_cast<Sudoku_engine_t>(e));
+        for (double q : report_quantiles) {
+            // no records: no quantiles (NaN, as Prometheus client libraries do)
+            const string value = snap.count > 0
+                                     ? fmt::format("{:.9f}", double(snap.percentile(q)) / 1e9)
+                                     : string("NaN");
+            out += fmt::format(
+                "sudoku_solve_latency_seconds{{engine=\"{}\",quantile=\"{}\"}} {}\n", name,
+                q, value);
+        }
+        out += fmt::format("sudoku_solve_latency_seconds_sum{{engine=\"{}\"}} {:.9f}\n",
+                           name, double(snap.sum_ns) / 1e9);
+        out += fmt::format("sudoku_solve_latency_seconds_count{{engine=\"{}\"}} {}\n",
+                           name, snap.count);
+    }
+
+    out += "# HELP sudoku_solve_latency_max_seconds Largest solve latency per engine.\n"
+           "# TYPE sudoku_solve_latency_max_seconds gauge\n";
+    for (int e = 0; e < sudoku_num_engines; ++e) {
+        out += fmt::format("sudoku_solve_latency_max_seconds{{engine=\"{}\"}} {:.9f}\n",
+                           sudoku_engine_name(static_cast<Sudoku_engine_t>(e)),
+                           double(per_engine[e].max_ns) / 1e9);
+    }
+    return out;
+}
+
+bool Sudoku_metrics::write_prometheus(const std::string& path) const {
+
+    // atomically: a scraper never reads a partial file
+    return sudoku_replace_file(path, prometheus_text());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Sudoku_metrics_reporter
+//////////////////////////////////////////////////////////////////////////////////////////
+
+Sudoku_metrics_reporter::Sudoku_metrics_reporter(Sudoku_metrics& t_metrics,
+                                                 std::ostream& t_os, std::string t_path,
+                                                 std::chrono::milliseconds t_interval) :
+    m_metrics(t_metrics), m_os(t_os), m_path(std::move(t_path)), m_interval(t_interval),
+    m_thread([this] { run(); }) {}
+
+Sudoku_metrics_reporter::~Sudoku_metrics_reporter() { stop(); }
+
+bool Sudoku_metrics_reporter::stop() {
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_stop) return m_write_ok;    // stopped before
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+
+    m_metrics.print(m_os);
+    if (!m_path.empty()) m_write_ok = m_metrics.write_prometheus(m_path) && m_write_ok;
+    return m_write_ok;
+}
+
+void Sudoku_metrics_reporter::run() {
+
+    unique_lock<mutex> lock(m_mutex);
+    while (!m_wake.wait_for(lock, m_interval, [this] { return m_stop; })) {
+        lock.unlock();
+        m_metrics.print_interval(m_os);
+        const bool ok = m_path.empty() || m_metrics.write_prometheus(m_path);
+        lock.lock();
+        m_write_ok = m_write_ok && ok;
+    }
+}
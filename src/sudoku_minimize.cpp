@@ -0,0 +1,90 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_minimize.h"
+#include "sudoku_check_pool.h"
+#include "sudoku_solve.h"
+
+#include <algorithm>    // shuffle()
+#include <random>
+#include <vector>
+
+using namespace std;
+
+// clue cnt of puzzle p is needed for the unique solution (solution of p)
+static bool clue_needed(const Sudoku& p, const Sudoku& solution, int cnt) {
+    Sudoku p_try(p);
+    p_try.set_value(cnt, 0);
+    sudoku_reset_candidates_all_cells(p_try);
+    p_try(cnt).cand.erase(solution(cnt).val);    // search for another solution only
+    return sudoku_count_solutions_within_candidates(p_try, 1) > 0;
+}
+
+std::optional<Sudoku> sudoku_minimize(const Sudoku& s, const Sudoku_minimize_options& opt,
+                                      Sudoku_minimize_stats& stats) {
+
+    if (sudoku_count_solutions(s, 2) != 1) return nullopt;
+
+    Sudoku p(s);
+    sudoku_reset_candidates_all_cells(p);
+    const Sudoku solution =
+        (sudoku_num_empty(p) == 0) ? p : sudoku_remove_recursive(p).second;
+
+    vector<int> pending;    // clues not known to be needed
+    for (int cnt = 0; cnt < p.total_size; ++cnt) {
+        if (p(cnt).val != 0) pending.push_back(cnt);
+    }
+    if (opt.shuffle) {
+        mt19937_64 rng(opt.seed);
+        shuffle(pending.begin(), pending.end(), rng);
+    }
+
+    // check the next clues in parallel (each against the current puzzle), remove the
+    // first redundant one
+    Sudoku_check_pool pool(opt.threads);
+    while (!pending.empty()) {
+        stats.checks += sudoku_check_keep_first(
+            pool, pending,
+            [&](int cnt) { return !clue_needed(p, solution, cnt); },
+            [&](int cnt) {
+                p.set_value(cnt, 0);
+                ++stats.removals;
+            });
+        ++stats.batches;
+    }
+
+    sudoku_reset_candidates_all_cells(p);
+    return p;
+}
+
+std::vector<std::optional<Sudoku>> sudoku_minimize_all(const std::vector<Sudoku>& v,
+                                                       const Sudoku_minimize_options& opt,
+                                                       Sudoku_minimize_stats& stats) {
+
+    Sudoku_minimize_options one_opt = opt;
+    one_opt.threads                 = 1;    // the checks of a puzzle one by one
+
+    vector<optional<Sudoku>> res(v.size());
+    vector<Sudoku_minimize_stats> res_stats(v.size());
+    Sudoku_check_pool pool(opt.threads);
+    pool.run(static_cast<int>(v.size()),
+             [&](int k) { res[k] = sudoku_minimize(v[k], one_opt, res_stats[k]); });
+
+    for (const auto& st : res_stats) {
+        stats.checks += st.checks;
+        stats.removals += st.removals;
+        stats.batches += st.batches;
+    }
+    return res;
+}
+
+bool sudoku_is_minimal(const Sudoku& s) {
+
+    Sudoku p(s);
+    sudoku_reset_candidates_all_cells(p);
+    const Sudoku solution =
+        (sudoku_num_empty(p) == 0) ? p : sudoku_remove_recursive(p).second;
+    for (int cnt = 0; cnt < p.total_size; ++cnt) {
+        if (p(cnt).val != 0 && !clue_needed(p, solution, cnt)) return false;
+    }
+    return true;
+}
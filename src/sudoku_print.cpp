@@ -8,7 +8,7 @@ void sudoku_print(const Sudoku& s, const string msg) {
     cout << msg << ":";
     for (int cnt = 0; cnt < s.total_size; ++cnt) {
         if (cnt % s.region_size == 0) { cout << "\n" << cnt / s.region_size << ": "; }
-        cout << setw(2) << s(cnt).val;
+        cout << setw(2) << int(s(cnt).val);
         if ((cnt + 1) % s.region_size != 0) cout << ",";
     }
     cout << "\n";
@@ -19,7 +19,7 @@ void sudoku_print_regions(const Sudoku& s, const string msg) {
     for (int i = 0; i < s.region_size; ++i) {
         cout << i << ": ";
         for (int j = 0; j < s.region_size; ++j) {
-            cout << setw(2) << s.row(i, j).val;
+            cout << setw(2) << int(s.row(i, j).val);
             if (j < s.region_size - 1) cout << ", ";
         }
         cout << "\n";
@@ -30,7 +30,7 @@ void sudoku_print_regions(const Sudoku& s, const string msg) {
     for (int i = 0; i < s.region_size; ++i) {
         cout << i << ": ";
         for (int j = 0; j < s.region_size; ++j) {
-            cout << setw(2) << s.col(i, j).val;
+            cout << setw(2) << int(s.col(i, j).val);
             if (j < s.region_size - 1) cout << ", ";
         }
         cout << "\n";
@@ -41,7 +41,7 @@ void sudoku_print_regions(const Sudoku& s, const string msg) {
     for (int i = 0; i < s.region_size; ++i) {
         cout << i << ": ";
         for (int j = 0; j < s.region_size; ++j) {
-            cout << setw(2) << s.block(i, j).val;
+            cout << setw(2) << int(s.block(i, j).val);
             if (j < s.region_size - 1) cout << ", ";
         }
         cout << "\n";
@@ -0,0 +1,312 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_rate.h"
+
+#include <array>
+#include <bit>    // popcount(), countr_zero()
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// logic solver working on flat candidate masks (no copies of the Sudoku, no finder
+// result vectors): one pass per technique, applied at once where it is found
+//////////////////////////////////////////////////////////////////////////////////////////
+class Sudoku_rater {
+
+  public:
+    explicit Sudoku_rater(const Sudoku& s) :
+        m_rs(s.region_size), m_n(s.total_size), m_t(s.index_table()),
+        m_all(static_cast<cand_mask_t>((uint64_t{1} << s.region_size) - 1)),
+        m_val(s.values(), s.values() + s.total_size), m_cand(s.total_size, m_all) {
+
+        // candidates from the entries only
+        vector<cand_mask_t> used(3 * m_rs, 0);
+        for (int cnt = 0; cnt < m_n; ++cnt) {
+            if (m_val[cnt] == 0) continue;
+            ++m_filled;
+            for (int type = 0; type < 3; ++type) {
+                used[region_of(type, cnt)] |= bit(m_val[cnt]);
+            }
+        }
+        for (int cnt = 0; cnt < m_n; ++cnt) {
+            if (m_val[cnt] != 0) {
+                m_cand[cnt] = 0;
+                continue;
+            }
+            for (int type = 0; type < 3; ++type) {
+                m_cand[cnt] &= ~used[region_of(type, cnt)];
+            }
+            if (m_cand[cnt] == 0) m_dead = true;
+        }
+    }
+
+    bool solved() const { return !m_dead && m_filled == m_n; }
+    bool dead() const { return m_dead; }
+    int num_empty() const { return m_n - m_filled; }
+
+    // one pass of technique t; returns the no. of applications that changed something
+    int apply(Sudoku_solution_t t) {
+        switch (t) {
+            case Sudoku_solution_t::naked_single:
+                return naked_singles();
+            case Sudoku_solution_t::hidden_single:
+                return hidden_singles();
+            case Sudoku_solution_t::naked_twin:
+                return naked_subsets(2);
+            case Sudoku_solution_t::hidden_twin:
+                return hidden_subsets(2);
+            case Sudoku_solution_t::naked_triple:
+                return naked_subsets(3);
+            case Sudoku_solution_t::hidden_triple:
+                return hidden_subsets(3);
+            case Sudoku_solution_t::naked_quadruple:
+                return naked_subsets(4);
+            default:
+                return 0;
+        }
+    }
+
+  private:
+    const int m_rs;
+    const int m_n;
+    const Sudoku_index_table& m_t;
+    const cand_mask_t m_all;
+
+    vector<uint8_t> m_val;
+    vector<cand_mask_t> m_cand;    // candidates of empty cells (0 for filled cells)
+    int m_filled{0};
+    bool m_dead{false};    // contradiction: no solution
+
+    static cand_mask_t bit(int v) { return Sudoku_candidates::bit(v); }
+
+    // region no. (type*rs + i) of cell cnt for type row = 0, col = 1, block = 2
+    int region_of(int type, int cnt) const {
+        return type * m_rs + m_t.cnt_region[type * m_n + cnt];
+    }
+
+    const int* cells_of(int r) const { return m_t.region_cnt.data() + r * m_rs; }
+
+    void place(int cnt, int v) {
+        const cand_mask_t b = bit(v);
+        m_val[cnt]          = v;
+        m_cand[cnt]         = 0;
+        ++m_filled;
+        for (int type = 0; type < 3; ++type) {
+            const int* rc = cells_of(region_of(type, cnt));
+            for (int j = 0; j < m_rs; ++j) {
+                const int c = rc[j];
+                if (m_val[c] != 0 || (m_cand[c] & b) == 0) continue;
+                m_cand[c] &= ~b;
+                if (m_cand[c] == 0) m_dead = true;
+            }
+        }
+    }
+
+    int naked_singles() {
+        int num = 0;
+        for (int cnt = 0; cnt < m_n && !m_dead; ++cnt) {
+            const cand_mask_t m = m_cand[cnt];
+            if (m_val[cnt] != 0 || popcount(m) != 1) continue;
+            place(cnt, countr_zero(m) + 1);
+            ++num;
+        }
+        return num;
+    }
+
+    int hidden_singles() {
+        int num = 0;
+        for (int r = 0; r < 3 * m_rs && !m_dead; ++r) {
+            const int* rc      = cells_of(r);
+            cand_mask_t once   = 0;
+            cand_mask_t twice  = 0;
+            cand_mask_t placed = 0;
+            for (int j = 0; j < m_rs; ++j) {
+                const int c = rc[j];
+                if (m_val[c] != 0) {
+                    placed |= bit(m_val[c]);
+                }
+                else {
+                    twice |= once & m_cand[c];
+                    once |= m_cand[c];
+                }
+            }
+            if ((once | placed) != m_all) {
+                m_dead = true;    // value without a cell in this region
+                break;
+            }
+            for (cand_mask_t w = once & ~twice; w != 0; w &= w - 1) {
+                const cand_mask_t b = w & (~w + 1);
+                for (int j = 0; j < m_rs; ++j) {
+                    const int c = rc[j];
+                    if (m_val[c] == 0 && (m_cand[c] & b) != 0) {
+                        place(c, countr_zero(b) + 1);
+                        ++num;
+                        break;
+                    }
+                }
+            }
+        }
+        return num;
+    }
+
+    // k cells of a region with k candidates together: these candidates can be removed
+    // from all other cells of the region
+    int naked_subsets(int k) {
+        int num = 0;
+        array<int, 32> pos;    // positions j of the empty cells with 2..k candidates
+        for (int r = 0; r < 3 * m_rs && !m_dead; ++r) {
+            const int* rc = cells_of(r);
+            int np        = 0;
+            for (int j = 0; j < m_rs; ++j) {
+                const int size = popcount(m_cand[rc[j]]);
+                if (m_val[rc[j]] == 0 && size >= 2 && size <= k) pos[np++] = j;
+            }
+            for_each_subset(np, k, [&](const array<int, 4>& sel) {
+                cand_mask_t u        = 0;
+                cand_mask_t selected = 0;    // positions in region
+                for (int i = 0; i < k; ++i) {
+                    u |= m_cand[rc[pos[sel[i]]]];
+                    selected |= cand_mask_t{1} << pos[sel[i]];
+                }
+                if (popcount(u) != k) return;
+                bool changed = false;
+                for (int j = 0; j < m_rs; ++j) {
+                    const int c = rc[j];
+                    if (m_val[c] != 0 || ((selected >> j) & 1) != 0) continue;
+                    if ((m_cand[c] & u) == 0) continue;
+                    m_cand[c] &= ~u;
+                    if (m_cand[c] == 0) m_dead = true;
+                    changed = true;
+                }
+                if (changed) ++num;
+            });
+        }
+        return num;
+    }
+
+    // k values of a region possible in k cells only: all other candidates can be
+    // removed from these cells
+    int hidden_subsets(int k) {
+        int num = 0;
+        array<cand_mask_t, 32> where;    // [v-1]: positions j of value v in region
+        array<int, 32> vals;             // values (v-1) possible in 2..k cells
+        for (int r = 0; r < 3 * m_rs && !m_dead; ++r) {
+            const int* rc = cells_of(r);
+            where.fill(0);
+            for (int j = 0; j < m_rs; ++j) {
+                for (cand_mask_t w = m_cand[rc[j]]; w != 0; w &= w - 1) {
+                    where[countr_zero(w)] |= cand_mask_t{1} << j;
+                }
+            }
+            int nv = 0;
+            for (int v = 0; v < m_rs; ++v) {
+                const int size = popcount(where[v]);
+                if (size >= 2 && size <= k) vals[nv++] = v;
+            }
+            for_each_subset(nv, k, [&](const array<int, 4>& sel) {
+                cand_mask_t u    = 0;    // positions
+                cand_mask_t keep = 0;    // values
+                for (int i = 0; i < k; ++i) {
+                    u |= where[vals[sel[i]]];
+                    keep |= cand_mask_t{1} << vals[sel[i]];
+                }
+                if (popcount(u) != k) return;
+                bool changed = false;
+                for (cand_mask_t w = u; w != 0; w &= w - 1) {
+                    const int c = rc[countr_zero(w)];
+                    if ((m_cand[c] & ~keep) == 0) continue;
+                    m_cand[c] &= keep;
+                    changed = true;
+                }
+                if (changed) ++num;
+            });
+        }
+        return num;
+    }
+
+    // call f for each subset of k (<= 4) out of n elements (ascending indices)
+    template <typename F> static void for_each_subset(int n, int k, F&& f) {
+        if (n < k) return;
+        array<int, 4> sel{};
+        for (int i = 0; i < k; ++i) sel[i] = i;
+        while (true) {
+            f(sel);
+            int i = k - 1;
+            while (i >= 0 && sel[i] == n - k + i) --i;
+            if (i < 0) return;
+            ++sel[i];
+            for (int l = i + 1; l < k; ++l) sel[l] = sel[l - 1] + 1;
+        }
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// rating
+//////////////////////////////////////////////////////////////////////////////////////////
+// weight of one application of each technique (in the order of Sudoku_solution_t)
+static constexpr array<int, Sudoku_solution_t::enum_count> technique_weight = {
+    1, 2, 10, 15, 20, 25, 30};
+static constexpr int step_weight   = 10;
+static constexpr int search_weight = 20;    // per cell left for search
+
+// upper score limits of the tiers einsteiger ... standard (9x9)
+static constexpr array<int, 4> tier_limit = {30, 60, 300, 1000};
+
+Sudoku_rating sudoku_rate(const Sudoku& s) {
+
+    Sudoku_rating rating;
+    Sudoku_rater rater(s);
+
+    // always apply the simplest technique that makes progress
+    while (!rater.dead() && !rater.solved()) {
+        int t   = 0;
+        int num = 0;
+        while (t < Sudoku_solution_t::enum_count && !rater.dead() &&
+               (num = rater.apply(static_cast<Sudoku_solution_t>(t))) == 0) {
+            ++t;
+        }
+        if (num == 0) break;    // stuck
+        rating.count[t] += num;
+        ++rating.steps;
+        if (t > rating.hardest) rating.hardest = static_cast<Sudoku_solution_t>(t);
+    }
+
+    rating.valid     = !rater.dead();
+    rating.solved    = rater.solved();
+    rating.remaining = rater.num_empty();
+    if (!rating.solved) rating.hardest = Sudoku_solution_t::enum_count;
+
+    for (int t = 0; t < Sudoku_solution_t::enum_count; ++t) {
+        rating.score += technique_weight[t] * rating.count[t];
+    }
+    if (rating.steps > 1) rating.score += step_weight * (rating.steps - 1);
+    rating.score += search_weight * rating.remaining;
+
+    // limits scaled with the region size
+    int tier = 0;
+    while (tier < static_cast<int>(tier_limit.size()) &&
+           rating.score * 9 >= tier_limit[tier] * s.region_size) {
+        ++tier;
+    }
+    rating.tier = static_cast<Sudoku_tier_t>(tier);
+
+    return rating;
+}
+
+std::string_view sudoku_tier_name(Sudoku_tier_t tier) {
+    switch (tier) {
+        case Sudoku_tier_t::einsteiger:
+            return "einsteiger";
+        case Sudoku_tier_t::einfach:
+            return "einfach";
+        case Sudoku_tier_t::mittel:
+            return "mittel";
+        case Sudoku_tier_t::standard:
+            return "standard";
+        case Sudoku_tier_t::hardest:
+            return "hardest";
+    }
+    return "unknown";
+}
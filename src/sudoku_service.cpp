@@ -0,0 +1,442 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_service.h"
+#include "sudoku_line.h"
+#include "sudoku_metrics.h"
+#include "sudoku_solve_cache.h"
+
+#include <algorithm>    // stable_sort()
+#include <cerrno>
+#include <charconv>    // from_chars()
+#include <chrono>
+#include <cstring>    // memcpy(), strerror()
+#include <limits>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>    // timeval
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// connections and requests
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct Sudoku_service::Connection {
+    const int fd;
+    const chrono::milliseconds send_timeout;
+    mutex write_mutex;
+    atomic<bool> broken{false};    // write failed or timed out: drop further replies
+
+    // fd with SO_SNDTIMEO set to send_timeout, so a single ::send() can't block longer
+    Connection(int t_fd, chrono::milliseconds t_send_timeout) :
+        fd(t_fd), send_timeout(t_send_timeout) {}
+    ~Connection() { ::close(fd); }    // after the last reply (jobs keep a reference)
+
+    // all of data within send_timeout, else the connection is broken and shut down
+    // (which ends its reader as well)
+    void send(const string& data) {
+        lock_guard<mutex> lock(write_mutex);
+        const auto deadline = chrono::steady_clock::now() + send_timeout;
+        size_t done         = 0;
+        while (!broken && done < data.size()) {
+            const ssize_t n =
+                ::send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n > 0) done += static_cast<size_t>(n);
+            // n < 0 with EAGAIN: SO_SNDTIMEO passed without progress
+            if (n <= 0 ||
+                (done < data.size() && chrono::steady_clock::now() > deadline)) {
+                broken = true;
+                ::shutdown(fd, SHUT_RDWR);
+            }
+        }
+    }
+};
+
+struct Sudoku_service::Reader {
+    shared_ptr<Connection> conn;    // reset when done (protected by m_readers_mutex)
+    thread t;
+    atomic<bool> done{false};
+};
+
+// longer text lines: connection dropped
+static constexpr size_t max_line_length = 4096;
+
+static bool valid_shape(int region_size, int blocks_per_row, int blocks_per_col) {
+    return region_size > 0 && region_size <= sudoku_max_region_size && blocks_per_row > 0 &&
+           region_size % blocks_per_row == 0 &&
+           region_size / blocks_per_row == blocks_per_col;
+}
+
+// remove path if it is a socket; false if it is anything else (left alone)
+static bool remove_socket(const string& path) {
+    struct stat st;
+    if (::lstat(path.c_str(), &st) != 0) return errno == ENOENT;
+    if (!S_ISSOCK(st.st_mode)) return false;
+    ::unlink(path.c_str());
+    return true;
+}
+
+static void append_uint32(string& out, uint32_t v) {
+    for (int k = 0; k < 4; ++k) out += static_cast<char>((v >> (8 * k)) & 0xff);
+}
+
+// whole field as a number
+template <typename T> static bool parse_number(string_view field, T& value) {
+    const auto [ptr, ec] = from_chars(field.data(), field.data() + field.size(), value);
+    return ec == errc() && ptr == field.data() + field.size();
+}
+
+static uint32_t read_uint32(const char* p) {
+    uint32_t v = 0;
+    for (int k = 3; k >= 0; --k) v = (v << 8) | static_cast<unsigned char>(p[k]);
+    return v;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Sudoku_service
+//////////////////////////////////////////////////////////////////////////////////////////
+
+Sudoku_service::Sudoku_service(Sudoku_service_options t_opt) :
+    m_opt(std::move(t_opt)), m_queue(m_opt.queue_capacity, m_opt.interactive_burst) {}
+
+Sudoku_service::~Sudoku_service() { stop(); }
+
+bool Sudoku_service::start() {
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (m_opt.socket_path.empty() || m_opt.socket_path.size() >= sizeof(addr.sun_path)) {
+        m_error = "invalid socket path '" + m_opt.socket_path + "'";
+        return false;
+    }
+    memcpy(addr.sun_path, m_opt.socket_path.c_str(), m_opt.socket_path.size() + 1);
+
+    m_listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listen_fd < 0) {
+        m_error = string("socket: ") + strerror(errno);
+        return false;
+    }
+    if (!remove_socket(m_opt.socket_path)) {    // stale socket of an earlier run
+        m_error = m_opt.socket_path + ": exists and is not a socket";
+        ::close(m_listen_fd);
+        m_listen_fd = -1;
+        return false;
+    }
+    if (::bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(m_listen_fd, SOMAXCONN) < 0) {
+        m_error = m_opt.socket_path + ": " + strerror(errno);
+        ::close(m_listen_fd);
+        m_listen_fd = -1;
+        return false;
+    }
+
+    const int num_threads =
+        m_opt.threads > 0 ? m_opt.threads
+                          : max(1, static_cast<int>(thread::hardware_concurrency()));
+    for (int t = 0; t < num_threads; ++t) m_workers.emplace_back([this] { work_loop(); });
+    m_accept_thread = thread([this] { accept_loop(); });
+    return true;
+}
+
+void Sudoku_service::stop() {
+
+    if (m_listen_fd < 0) return;    // not started or already stopped
+
+    m_stop = true;
+    m_accept_thread.join();
+    ::close(m_listen_fd);
+    m_listen_fd = -1;
+    remove_socket(m_opt.socket_path);
+
+    // wake up the readers blocked in recv(), requests already queued are still served
+    {
+        lock_guard<mutex> lock(m_readers_mutex);
+        for (auto& r : m_readers) {
+            if (r.conn) ::shutdown(r.conn->fd, SHUT_RD);
+        }
+    }
+    for (auto& r : m_readers) r.t.join();
+    m_readers.clear();
+
+    m_queue.close();
+    for (auto& t : m_workers) t.join();
+    m_workers.clear();
+}
+
+Sudoku_service_stats Sudoku_service::stats() const {
+
+    Sudoku_service_stats st;
+    st.connections = m_connections;
+    st.rejected    = m_rejected;
+    st.requests    = m_requests;
+    st.solved      = m_solved;
+    st.unsolvable  = m_unsolvable;
+    st.unsolved    = m_unsolved;
+    st.invalid     = m_invalid;
+    st.expired     = m_expired;
+    st.dropped     = m_dropped;
+    st.batches     = m_batches;
+    st.scheduler   = m_queue.stats();
+    return st;
+}
+
+void Sudoku_service::accept_loop() {
+
+    while (!m_stop) {
+        pollfd pfd{m_listen_fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 100) <= 0) continue;    // timeout: check m_stop again
+
+        const int fd = ::accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+        const int timeout_ms = max(m_opt.send_timeout_ms, 1);
+        const timeval tv{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+        lock_guard<mutex> lock(m_readers_mutex);
+        // join the readers of closed connections
+        for (auto it = m_readers.begin(); it != m_readers.end();) {
+            if (it->done) {
+                it->t.join();
+                it = m_readers.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        if (static_cast<int>(m_readers.size()) >= m_opt.max_connections) {
+            ::close(fd);
+            ++m_rejected;
+            continue;
+        }
+        ++m_connections;
+        auto& r = m_readers.emplace_back();
+        r.conn  = make_shared<Connection>(fd, chrono::milliseconds(timeout_ms));
+        r.t     = thread([this, &r] {
+            read_loop(r.conn);
+            // the socket is closed, once the replies to the requests queued are sent
+            lock_guard<mutex> lock(m_readers_mutex);
+            r.conn.reset();
+            r.done = true;
+        });
+    }
+}
+
+void Sudoku_service::read_loop(std::shared_ptr<Connection> conn) {
+
+    string buf;
+    size_t pos       = 0;    // start of the first request not parsed yet
+    uint32_t next_id = 0;    // id of text requests without id
+    char chunk[1 << 16];
+
+    for (;;) {
+        const ssize_t n = ::recv(conn->fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;    // closed by the client or by stop()
+        buf.append(chunk, static_cast<size_t>(n));
+
+        // parse all complete requests in buf
+        for (;;) {
+            Job job;
+            job.conn = conn;
+
+            job.priority    = m_opt.priority;
+            int deadline_ms = m_opt.deadline_ms;
+
+            if (pos < buf.size() && (buf[pos] == '\0' || buf[pos] == '\1')) {    // binary
+                const bool scheduled = buf[pos] == '\1';
+                const size_t head    = scheduled ? 13 : 8;    // size without values
+                if (buf.size() - pos < head) break;
+                const char* p = buf.data() + pos;
+                const int rs  = static_cast<unsigned char>(p[head - 3]);
+                const int bpr = static_cast<unsigned char>(p[head - 2]);
+                const int bpc = static_cast<unsigned char>(p[head - 1]);
+                const size_t size = head + static_cast<size_t>(rs * rs);
+                if (buf.size() - pos < size) break;
+
+                job.binary = true;
+                job.id     = read_uint32(p + 1);
+                bool ok    = valid_shape(rs, bpr, bpc);
+                if (scheduled) {
+                    ok           = ok && static_cast<unsigned char>(p[5]) < 2;
+                    job.priority = static_cast<Sudoku_priority_t>(p[5] == 1);
+                    deadline_ms  = static_cast<int>(
+                        min<uint32_t>(read_uint32(p + 6), numeric_limits<int>::max()));
+                }
+                if (ok) {
+                    Sudoku s(rs, bpr, bpc);
+                    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+                        const int v = static_cast<unsigned char>(p[head + cnt]);
+                        ok          = ok && v <= rs;
+                        s.set_value(cnt, ok ? v : 0);
+                    }
+                    if (ok) {
+                        sudoku_update_candidates_all_cells(s);
+                        job.puzzle = std::move(s);
+                    }
+                }
+                pos += size;
+            }
+            else {    // text request
+                const size_t end = buf.find('\n', pos);
+                if (end == string::npos) {
+                    if (buf.size() - pos > max_line_length) return;    // garbage
+                    break;
+                }
+                string_view line(buf.data() + pos, end - pos);
+                pos = end + 1;
+                while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+                    line.remove_suffix(1);
+                }
+                if (line.empty()) continue;
+
+                // fields before the puzzle: id, priority, deadline
+                job.id  = next_id++;
+                bool ok = true;
+                for (size_t blank; ok && (blank = line.find(' ')) != string_view::npos;) {
+                    const string_view field = line.substr(0, blank);
+                    line.remove_prefix(blank + 1);
+                    if (field == "p=i" || field == "p=b") {
+                        job.priority = field == "p=i" ? Sudoku_priority_t::interactive
+                                                      : Sudoku_priority_t::batch;
+                    }
+                    else if (field.starts_with("d=")) {
+                        ok = parse_number(field.substr(2), deadline_ms);
+                    }
+                    else {
+                        ok = parse_number(field, job.id);
+                    }
+                }
+                if (ok) job.puzzle = sudoku_from_line(line);
+            }
+
+            if (deadline_ms > 0) {
+                job.deadline =
+                    chrono::steady_clock::now() + chrono::milliseconds(deadline_ms);
+            }
+            ++m_requests;
+            const auto priority = job.priority;
+            const auto deadline = job.deadline;
+            if (!m_queue.push(std::move(job), priority, deadline)) return;    // stopped
+        }
+
+        // drop the parsed part of the buffer
+        if (pos > 0) {
+            buf.erase(0, pos);
+            pos = 0;
+        }
+    }
+}
+
+void Sudoku_service::work_loop() {
+
+    // per-thread state, allocated once: the batch taken and the replies of a connection
+    vector<Job> batch, expired;
+    batch.reserve(m_opt.batch_size);
+    string out;
+    out.reserve(1 << 16);
+    Sudoku_search_stats search_stats;
+
+    while (m_queue.pop_batch(batch, m_opt.batch_size, expired) > 0) {
+        ++m_batches;
+        for (auto& job : expired) {
+            job.expired = true;
+            batch.push_back(std::move(job));
+        }
+        expired.clear();
+
+        // in dispatch order; consecutive replies to the same connection in one write,
+        // except for interactive requests (replied at once)
+        for (size_t k = 0; k < batch.size(); ++k) {
+            Job& job = batch[k];
+
+            if (job.conn->broken) {    // nobody to reply to: don't solve
+                ++m_dropped;
+                out.clear();
+                continue;
+            }
+
+            // 0: solved, 1: unsolvable, 2: invalid, 3: expired, 4: unsolved
+            int status = 2;
+            uint32_t us = 0;
+            optional<Sudoku> result;
+            if (job.puzzle &&
+                (job.expired || chrono::steady_clock::now() > job.deadline)) {
+                status = 3;
+                result = std::move(job.puzzle);
+            }
+            else if (job.puzzle && sudoku_is_valid(*job.puzzle)) {
+                const auto start = chrono::steady_clock::now();
+                auto res = m_opt.cache
+                               ? sudoku_remove_cached(*job.puzzle, *m_opt.cache,
+                                                      m_opt.engine, m_opt.search,
+                                                      search_stats)
+                               : sudoku_remove_engine(*job.puzzle, m_opt.engine,
+                                                      m_opt.search, search_stats);
+                const auto elapsed = chrono::steady_clock::now() - start;
+                if (m_opt.metrics) m_opt.metrics->record(m_opt.engine, elapsed);
+                us = static_cast<uint32_t>(
+                    chrono::duration_cast<chrono::microseconds>(elapsed).count());
+                if (sudoku_num_empty(res.second) == 0 && sudoku_is_valid(res.second)) {
+                    status = 0;
+                }
+                else {    // the logic engine may stop without proving anything
+                    status = m_opt.engine == Sudoku_engine_t::logic ? 4 : 1;
+                }
+                result = std::move(res.second);
+            }
+            switch (status) {
+                case 0: ++m_solved; break;
+                case 1: ++m_unsolvable; break;
+                case 2: ++m_invalid; break;
+                case 3: ++m_expired; break;
+                default: ++m_unsolved; break;
+            }
+
+            if (job.binary) {
+                out += '\0';
+                append_uint32(out, job.id);
+                out += static_cast<char>(status);
+                if (result) {
+                    out += static_cast<char>(result->region_size);
+                    out += static_cast<char>(result->blocks_per_row);
+                    out += static_cast<char>(result->blocks_per_col);
+                    out.append(reinterpret_cast<const char*>(result->values()),
+                               result->total_size);
+                }
+                else {
+                    out.append(3, '\0');    // no shape, no values
+                }
+                append_uint32(out, us);
+            }
+            else {
+                static const char* const status_name[] = {
+                    "solved", "unsolvable", "invalid", "expired", "unsolved"};
+                out += to_string(job.id);
+                out += ' ';
+                out += status_name[status];
+                out += ' ';
+                if (status == 0 || status == 4) {
+                    sudoku_append_line(out, *result);
+                }
+                else {
+                    out += '-';
+                }
+                out += ' ';
+                out += to_string(us);
+                out += '\n';
+            }
+
+            if (k + 1 == batch.size() || batch[k + 1].conn != job.conn ||
+                job.priority == Sudoku_priority_t::interactive) {
+                job.conn->send(out);
+                out.clear();
+            }
+        }
+        batch.clear();    // releases the connections of the batch
+    }
+}
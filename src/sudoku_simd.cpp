@@ -0,0 +1,314 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_simd.h"
+
+#include <bit>    // popcount(), countr_zero()
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SUDOKU_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// scalar kernels (reference implementation)
+//
+// the *_range() versions process cells [first, last) and are used for the tails of the
+// vector loops as well
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static int num_empty_range(const uint8_t* val, int first, int last) {
+    int count = 0;
+    for (int i = first; i < last; ++i) {
+        if (val[i] == 0) ++count;
+    }
+    return count;
+}
+
+static int num_candidates_range(const uint8_t* val, const Sudoku_candidates* cand,
+                                int first, int last) {
+    int count = 0;
+    for (int i = first; i < last; ++i) {
+        if (val[i] != 0) continue;
+        if (cand[i].empty()) return -1;
+        count += cand[i].size();
+    }
+    return count;
+}
+
+static int naked_single_cells_range(const uint8_t* val, const Sudoku_candidates* cand,
+                                    int first, int last, int* cells) {
+    int num_cells = 0;
+    for (int i = first; i < last; ++i) {
+        if (val[i] == 0 && cand[i].size() == 1) cells[num_cells++] = i;
+    }
+    return num_cells;
+}
+
+static void filter_candidates_range(const uint8_t* val, Sudoku_candidates* cand,
+                                    int first, int last, cand_mask_t common_used,
+                                    const cand_mask_t* used) {
+    for (int i = first; i < last; ++i) {
+        if (val[i] != 0) {
+            cand[i].clear();
+        } else {
+            cand[i] &= ~(common_used | used[i]);
+        }
+    }
+}
+
+static int num_empty_scalar(const uint8_t* val, int n) {
+    return num_empty_range(val, 0, n);
+}
+
+static int num_candidates_scalar(const uint8_t* val, const Sudoku_candidates* cand,
+                                 int n) {
+    return num_candidates_range(val, cand, 0, n);
+}
+
+static int naked_single_cells_scalar(const uint8_t* val, const Sudoku_candidates* cand,
+                                     int n, int* cells) {
+    return naked_single_cells_range(val, cand, 0, n, cells);
+}
+
+static void filter_candidates_scalar(const uint8_t* val, Sudoku_candidates* cand, int n,
+                                     cand_mask_t common_used, const cand_mask_t* used) {
+    filter_candidates_range(val, cand, 0, n, common_used, used);
+}
+
+#if defined(SUDOKU_SIMD_X86)
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SSE4.1 kernels (16 values or 4 candidate masks per step)
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define SUDOKU_TARGET_SSE4 __attribute__((target("sse4.1")))
+
+// 32 bit lanes set for cells val[0..3] == 0
+SUDOKU_TARGET_SSE4 static inline __m128i empty_lanes_sse4(const uint8_t* val) {
+    int32_t v4;
+    __builtin_memcpy(&v4, val, sizeof(v4));
+    __m128i v = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(v4));
+    return _mm_cmpeq_epi32(v, _mm_setzero_si128());
+}
+
+// popcount of each byte (nibble lookup)
+SUDOKU_TARGET_SSE4 static inline __m128i popcount_bytes_sse4(__m128i x) {
+    const __m128i lut    = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    __m128i lo           = _mm_shuffle_epi8(lut, _mm_and_si128(x, nibble));
+    __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(x, 4), nibble));
+    return _mm_add_epi8(lo, hi);
+}
+
+SUDOKU_TARGET_SSE4 static int num_empty_sse4(const uint8_t* val, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    int count          = 0;
+    int i              = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(val + i));
+        unsigned m = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)));
+        count += popcount(m);
+    }
+    return count + num_empty_range(val, i, n);
+}
+
+SUDOKU_TARGET_SSE4 static int num_candidates_sse4(const uint8_t* val,
+                                                  const Sudoku_candidates* cand, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum        = zero;    // 2 x 64 bit partial sums
+    int dead           = 0;       // != 0: empty cell without candidates found
+    int i              = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cand + i));
+        __m128i e = empty_lanes_sse4(val + i);
+        __m128i d = _mm_and_si128(e, _mm_cmpeq_epi32(c, zero));
+        dead |= _mm_movemask_ps(_mm_castsi128_ps(d));
+        __m128i p = popcount_bytes_sse4(_mm_and_si128(c, e));
+        sum       = _mm_add_epi64(sum, _mm_sad_epu8(p, zero));
+    }
+    int tail = num_candidates_range(val, cand, i, n);
+    if (dead != 0 || tail < 0) return -1;
+    return static_cast<int>(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1)) + tail;
+}
+
+SUDOKU_TARGET_SSE4 static int
+naked_single_cells_sse4(const uint8_t* val, const Sudoku_candidates* cand, int n,
+                        int* cells) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one  = _mm_set1_epi32(1);
+    int num_cells      = 0;
+    int i              = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cand + i));
+        // exactly one candidate: c != 0 && (c & (c-1)) == 0
+        __m128i pow2   = _mm_cmpeq_epi32(_mm_and_si128(c, _mm_sub_epi32(c, one)), zero);
+        __m128i single = _mm_andnot_si128(_mm_cmpeq_epi32(c, zero), pow2);
+        single         = _mm_and_si128(single, empty_lanes_sse4(val + i));
+        unsigned m     = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(single)));
+        for (; m != 0; m &= m - 1) cells[num_cells++] = i + countr_zero(m);
+    }
+    return num_cells + naked_single_cells_range(val, cand, i, n, cells + num_cells);
+}
+
+SUDOKU_TARGET_SSE4 static void filter_candidates_sse4(const uint8_t* val,
+                                                      Sudoku_candidates* cand, int n,
+                                                      cand_mask_t common_used,
+                                                      const cand_mask_t* used) {
+    const __m128i common = _mm_set1_epi32(static_cast<int>(common_used));
+    int i                = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(cand + i);
+        __m128i u  = _mm_or_si128(
+            common, _mm_loadu_si128(reinterpret_cast<const __m128i*>(used + i)));
+        __m128i c = _mm_andnot_si128(u, _mm_loadu_si128(p));
+        _mm_storeu_si128(p, _mm_and_si128(c, empty_lanes_sse4(val + i)));
+    }
+    filter_candidates_range(val, cand, i, n, common_used, used);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// AVX2 kernels (32 values or 8 candidate masks per step)
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define SUDOKU_TARGET_AVX2 __attribute__((target("avx2")))
+
+// 32 bit lanes set for cells val[0..7] == 0
+SUDOKU_TARGET_AVX2 static inline __m256i empty_lanes_avx2(const uint8_t* val) {
+    __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(val));
+    return _mm256_cmpeq_epi32(_mm256_cvtepu8_epi32(v8), _mm256_setzero_si256());
+}
+
+// popcount of each byte (nibble lookup)
+SUDOKU_TARGET_AVX2 static inline __m256i popcount_bytes_avx2(__m256i x) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    __m256i lo           = _mm256_shuffle_epi8(lut, _mm256_and_si256(x, nibble));
+    __m256i hi =
+        _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+    return _mm256_add_epi8(lo, hi);
+}
+
+SUDOKU_TARGET_AVX2 static int num_empty_avx2(const uint8_t* val, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    int count          = 0;
+    int i              = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(val + i));
+        unsigned m =
+            static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero)));
+        count += popcount(m);
+    }
+    return count + num_empty_range(val, i, n);
+}
+
+SUDOKU_TARGET_AVX2 static int num_candidates_avx2(const uint8_t* val,
+                                                  const Sudoku_candidates* cand, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sum        = zero;    // 4 x 64 bit partial sums
+    int dead           = 0;       // != 0: empty cell without candidates found
+    int i              = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cand + i));
+        __m256i e = empty_lanes_avx2(val + i);
+        __m256i d = _mm256_and_si256(e, _mm256_cmpeq_epi32(c, zero));
+        dead |= _mm256_movemask_ps(_mm256_castsi256_ps(d));
+        __m256i p = popcount_bytes_avx2(_mm256_and_si256(c, e));
+        sum       = _mm256_add_epi64(sum, _mm256_sad_epu8(p, zero));
+    }
+    int tail = num_candidates_range(val, cand, i, n);
+    if (dead != 0 || tail < 0) return -1;
+    __m128i s2 =
+        _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    return static_cast<int>(_mm_cvtsi128_si64(s2) + _mm_extract_epi64(s2, 1)) + tail;
+}
+
+SUDOKU_TARGET_AVX2 static int
+naked_single_cells_avx2(const uint8_t* val, const Sudoku_candidates* cand, int n,
+                        int* cells) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one  = _mm256_set1_epi32(1);
+    int num_cells      = 0;
+    int i              = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cand + i));
+        // exactly one candidate: c != 0 && (c & (c-1)) == 0
+        __m256i pow2 =
+            _mm256_cmpeq_epi32(_mm256_and_si256(c, _mm256_sub_epi32(c, one)), zero);
+        __m256i single = _mm256_andnot_si256(_mm256_cmpeq_epi32(c, zero), pow2);
+        single         = _mm256_and_si256(single, empty_lanes_avx2(val + i));
+        unsigned m =
+            static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(single)));
+        for (; m != 0; m &= m - 1) cells[num_cells++] = i + countr_zero(m);
+    }
+    return num_cells + naked_single_cells_range(val, cand, i, n, cells + num_cells);
+}
+
+SUDOKU_TARGET_AVX2 static void filter_candidates_avx2(const uint8_t* val,
+                                                      Sudoku_candidates* cand, int n,
+                                                      cand_mask_t common_used,
+                                                      const cand_mask_t* used) {
+    const __m256i common = _mm256_set1_epi32(static_cast<int>(common_used));
+    int i                = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(cand + i);
+        __m256i u  = _mm256_or_si256(
+            common, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(used + i)));
+        __m256i c = _mm256_andnot_si256(u, _mm256_loadu_si256(p));
+        _mm256_storeu_si256(p, _mm256_and_si256(c, empty_lanes_avx2(val + i)));
+    }
+    filter_candidates_range(val, cand, i, n, common_used, used);
+}
+
+#endif    // SUDOKU_SIMD_X86
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// runtime dispatch
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// the vector kernels load candidate masks as packed 32 bit lanes
+static_assert(sizeof(Sudoku_candidates) == sizeof(cand_mask_t));
+
+Sudoku_simd_t sudoku_simd_supported() {
+
+    static const Sudoku_simd_t supported = [] {
+#if defined(SUDOKU_SIMD_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return Sudoku_simd_t::avx2;
+        if (__builtin_cpu_supports("sse4.1")) return Sudoku_simd_t::sse4;
+#endif
+        return Sudoku_simd_t::scalar;
+    }();
+
+    return supported;
+}
+
+const Sudoku_kernels& sudoku_simd_kernels(Sudoku_simd_t level) {
+
+    static const Sudoku_kernels scalar{Sudoku_simd_t::scalar, num_empty_scalar,
+                                       num_candidates_scalar, naked_single_cells_scalar,
+                                       filter_candidates_scalar};
+#if defined(SUDOKU_SIMD_X86)
+    static const Sudoku_kernels sse4{Sudoku_simd_t::sse4, num_empty_sse4,
+                                     num_candidates_sse4, naked_single_cells_sse4,
+                                     filter_candidates_sse4};
+    static const Sudoku_kernels avx2{Sudoku_simd_t::avx2, num_empty_avx2,
+                                     num_candidates_avx2, naked_single_cells_avx2,
+                                     filter_candidates_avx2};
+
+    Sudoku_simd_t supported = sudoku_simd_supported();
+    if (level == Sudoku_simd_t::avx2 && supported == Sudoku_simd_t::avx2) return avx2;
+    if (level != Sudoku_simd_t::scalar && supported != Sudoku_simd_t::scalar) return sse4;
+#endif
+
+    return scalar;
+}
+
+const Sudoku_kernels& sudoku_simd_kernels() {
+
+    static const Sudoku_kernels& best = sudoku_simd_kernels(sudoku_simd_supported());
+
+    return best;
+}
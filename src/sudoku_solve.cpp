@@ -2,11 +2,23 @@
 #include "dyn_assert.h"
 
 #include <algorithm>
+#include <atomic>
+#include <initializer_list>
 #include <numeric>
+#include <optional>
+#include <random>
 #include <tuple>
 #include "sudoku_print.h"    // for debugging only
 #include "sudoku_solve.h"
+#include "sudoku_solve_cbj.h"
+#include "sudoku_solve_fixed.h"
+#include "sudoku_simd.h"
+#include "sudoku_solve_batch.h"
 #include "sudoku_solve_helper.h"
+#include "sudoku_solve_portfolio.h"
+#include "sudoku_solve_probe.h"
+#include "sudoku_solve_sat.h"
+#include "sudoku_solve_tt.h"
 
 using namespace std;
 
@@ -15,7 +27,7 @@ using namespace std;
 //
 
 void sudoku_update_candidates_cell(Sudoku& s, int cnt) {
-    dynamic_assert(s.is_valid_index(cnt), "Index out of range.");
+    index_assert(s.is_valid_index(cnt), "Index out of range.");
     //
     // if the cell has an entry != 0 the candidate set must be cleared
     //
@@ -57,7 +69,7 @@ void sudoku_update_candidates_cell(Sudoku& s, int cnt) {
 }
 
 void sudoku_update_candidates_affected_by_cell(Sudoku& s, int cnt) {
-    dynamic_assert(s.is_valid_index(cnt), "Index out of range.");
+    index_assert(s.is_valid_index(cnt), "Index out of range.");
     //
     // update all candidate sets of cells in the regions the cell(cnt) belongs to
     //
@@ -83,10 +95,75 @@ void sudoku_update_candidates_affected_by_cell(Sudoku& s, int cnt) {
     return;
 }
 
+void sudoku_update_candidates_peers_of_cell(Sudoku& s, int cnt) {
+    index_assert(s.is_valid_index(cnt), "Index out of range.");
+    //
+    // cell(cnt) just received its entry: clear its candidate set and remove its value
+    // from the candidate sets of all cells in the regions the cell belongs to
+    //
+    // (equivalent to sudoku_update_candidates_affected_by_cell() for a freshly filled
+    // cell, but each peer is touched only once instead of being recomputed from its
+    // three regions)
+    //
+
+    int value = s(cnt).val;
+    s(cnt).cand.clear();
+    if (value == 0) return;
+
+    int curr_row   = s(cnt).ri;
+    int curr_col   = s(cnt).ci;
+    int curr_block = s(cnt).bi;
+    for (int j = 0; j < s.region_size; ++j) {
+        s.row(curr_row, j).cand.erase(value);
+        s.col(curr_col, j).cand.erase(value);
+        s.block(curr_block, j).cand.erase(value);
+    }
+
+    return;
+}
+
 void sudoku_update_candidates_all_cells(Sudoku& s) {
+    //
+    // same result as calling sudoku_update_candidates_cell() for each cell: collect the
+    // values used in each row, col and block first, then remove them from the
+    // candidate sets row by row (vectorized, see sudoku_simd.h)
+    //
+    const int n                 = s.region_size;
+    const Sudoku_index_table& t = s.index_table();
+    const uint8_t* val          = s.values();
+
+    vector<cand_mask_t> used(3 * n, 0);    // values used in row / col / block
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        if (val[cnt] == 0) continue;
+        const cand_mask_t b = Sudoku_candidates::bit(val[cnt]);
+        used[t.cnt_region[cnt]] |= b;
+        used[n + t.cnt_region[s.total_size + cnt]] |= b;
+        used[2 * n + t.cnt_region[2 * s.total_size + cnt]] |= b;
+    }
+
+    // per row: values used in the col and block of each cell of the row
+    vector<cand_mask_t> col_block_used(n);
+    const Sudoku_kernels& k = sudoku_simd_kernels();
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            int curr_block    = t.cnt_region[2 * s.total_size + s.row_to_cnt(i, j)];
+            col_block_used[j] = used[n + j] | used[2 * n + curr_block];
+        }
+        int first = s.row_to_cnt(i, 0);
+        k.filter_candidates(val + first, s.candidates() + first, n, used[i],
+                            col_block_used.data());
+    }
+}
+
+void sudoku_reset_candidates_all_cells(Sudoku& s) {
+    // all values are candidates of the empty cells again (i.e. reductions by the logic
+    // techniques are dropped), then remove the values entered in their regions
+    const Sudoku_candidates all(
+        static_cast<cand_mask_t>((std::uint64_t{1} << s.region_size) - 1));
     for (int cnt = 0; cnt < s.total_size; ++cnt) {
-        sudoku_update_candidates_cell(s, cnt);
+        s.candidates()[cnt] = (s.values()[cnt] == 0) ? all : Sudoku_candidates();
     }
+    sudoku_update_candidates_all_cells(s);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -95,13 +172,13 @@ void sudoku_update_candidates_all_cells(Sudoku& s) {
 bool sudoku_has_unique_entries_in_region(const Sudoku& s, const Region_t region) {
     for (int i = 0; i < s.region_size; ++i) {    // for each subregion
 
-        for (int value = 1; value <= s.region_size;
-             ++value) {    // for each potential value
-            int count = 0;
-            for (int j = 0; j < s.region_size; ++j) {    // occurences at each position
-                if (s(s.region_to_cnt(region, i, j)).val == value) ++count;
-            }
-            if (count > 1) return false;
+        cand_mask_t seen = 0;    // values entered in subregion so far
+        for (int cnt : s.region_cells(region, i)) {
+            int value = s(cnt).val;
+            if (value < 1 || value > s.region_size) continue;    // only count entries
+            const cand_mask_t b = Sudoku_candidates::bit(value);
+            if (seen & b) return false;    // value occurs twice
+            seen |= b;
         }
     }
 
@@ -114,9 +191,14 @@ bool sudoku_has_unique_entries_in_region(const Sudoku& s, const Region_t region)
 bool sudoku_has_sufficient_candidates_in_region(const Sudoku& s, const Region_t region) {
 
     for (int i = 0; i < s.region_size; ++i) {    // for each subregion
-        int num_empty       = sudoku_num_empty_in_subregion(s, region, i);
-        int num_unique_cand = sudoku_num_unique_candidates_in_subregion(s, region, i);
-        if (num_empty > num_unique_cand) return false;
+        int num_empty         = 0;
+        cand_mask_t union_set = 0;    // union of candidates of empty cells
+        for (int cnt : s.region_cells(region, i)) {
+            if (s(cnt).val != 0) continue;
+            ++num_empty;
+            union_set |= s(cnt).cand.mask();
+        }
+        if (num_empty > popcount(union_set)) return false;
     }
 
     return true;
@@ -129,13 +211,12 @@ bool sudoku_has_unique_single_candidates_in_region(const Sudoku& s,
                                                    const Region_t region) {
 
     for (int i = 0; i < s.region_size; ++i) {    // for each subregion
-        vector<int> cand_count{};                // candidate occurrence count
-
-        // count how often which entry occurs in candidate sets in each subregion
-        cand_count = sudoku_count_single_candidate_entries_in_subregion(s, region, i);
-
-        for (int k = 0; k < s.region_size; ++k) {    // for each potential value
-            if (cand_count[k] > 1) return false;
+        cand_mask_t seen = 0;    // single candidates of empty cells so far
+        for (int cnt : s.region_cells(region, i)) {
+            if (s(cnt).val != 0 || s(cnt).cand.size() != 1) continue;
+            const cand_mask_t b = s(cnt).cand.mask();
+            if (seen & b) return false;    // single candidate occurs twice
+            seen |= b;
         }
     }
 
@@ -146,7 +227,7 @@ bool sudoku_is_valid(const Sudoku& s) {
     // check for valid entry values:
     // 0 (=empty indicator, is valid too), valid entries: 1..region_size
     for (int cnt = 0; cnt < s.total_size; ++cnt) {
-        if (s(cnt).val < 0 || s(cnt).val > s.region_size) { return false; }
+        if (s(cnt).val > s.region_size) { return false; }
         if (s(cnt).val == 0 && s(cnt).cand.size() == 0) { return false; }
     }
 
@@ -170,18 +251,14 @@ bool sudoku_is_valid(const Sudoku& s) {
 
 int sudoku_num_entries(const Sudoku& s) {
     // return no. of entries > 0
-    int count = 0;
-    for (int cnt = 0; cnt < s.total_size; ++cnt) {
-        if (s(cnt).val > 0) ++count;
-    }
 
-    return count;
+    return s.total_size - sudoku_num_empty(s);
 }
 
 int sudoku_num_empty(const Sudoku& s) {
     // return no. of empty entries, i.e. entries with value 0
 
-    return s.total_size - sudoku_num_entries(s);
+    return sudoku_simd_kernels().num_empty(s.values(), s.total_size);
 }
 
 int sudoku_get_empty(const Sudoku& s) {
@@ -198,24 +275,37 @@ int sudoku_get_empty(const Sudoku& s) {
 }
 
 int sudoku_num_candidates(const Sudoku& s) {
-    int num_candidates = 0;
+    // no. of candidates of all empty cells; 0 if there are no empty cells left or if
+    // an empty cell has no candidates left (i.e. no candidates available)
 
-    if (sudoku_num_empty(s) == 0) return num_candidates;
+    int num_candidates =
+        sudoku_simd_kernels().num_candidates(s.values(), s.candidates(), s.total_size);
 
-    // for all entries == 0 candidates available, if size of candidate set > 0
-    for (int cnt = 0; cnt < s.total_size; ++cnt) {
-        if (s(cnt).val == 0 && s(cnt).cand.size() == 0) return num_candidates;
-    }
+    return (num_candidates < 0) ? 0 : num_candidates;
+}
 
-    // if arrived here, there are still candidates available
-    for (int cnt = 0; cnt < s.total_size; ++cnt) {
-        if (s(cnt).val == 0) num_candidates += s(cnt).cand.size();
-    }
+bool sudoku_has_candidates(const Sudoku& s) { return sudoku_num_candidates(s) > 0; }
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solutions found before (sudoku_apply_*): entries applied before may have made an entry
+// stale, i.e. filled one of its cells or removed its values; stale entries are skipped
+//////////////////////////////////////////////////////////////////////////////////////////
 
-    return num_candidates;
+// all cells still empty
+static bool cells_empty(const Sudoku& s, std::initializer_list<int> cells) {
+    for (int cnt : cells) {
+        if (s(cnt).val != 0) return false;
+    }
+    return true;
 }
 
-bool sudoku_has_candidates(const Sudoku& s) { return sudoku_num_candidates(s) > 0; }
+// each value of values still a candidate in at least one of the cells
+static bool values_left(const Sudoku& s, std::initializer_list<int> cells,
+                        cand_mask_t values) {
+    cand_mask_t left = 0;
+    for (int cnt : cells) left |= s(cnt).cand.mask();
+    return (left & values) == values;
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // naked singles
@@ -226,11 +316,14 @@ single_vec sudoku_naked_singles(const Sudoku& s) {
         naked_singles;    // vector of tuples with (cell-no., region, subregion, value)
                           // region & subregion can be ignored for naked singles
 
-    for (int cnt = 0; cnt < s.total_size; ++cnt) {
-        if (s(cnt).val == 0 && s(cnt).cand.size() == 1) {
-            naked_singles.push_back(make_tuple(
-                cnt, Region_t::row, s.cnt_to_row(cnt).first, *(s(cnt).cand.begin())));
-        }
+    vector<int> cells(s.total_size);
+    int num_cells = sudoku_simd_kernels().naked_single_cells(s.values(), s.candidates(),
+                                                              s.total_size, cells.data());
+    naked_singles.reserve(num_cells);
+    for (int i = 0; i < num_cells; ++i) {
+        int cnt = cells[i];
+        naked_singles.push_back(make_tuple(cnt, Region_t::row, s.cnt_to_row(cnt).first,
+                                           *(s(cnt).cand.begin())));
     }
 
     // for (int i=0; i<naked_singles.size(); ++i) {
@@ -250,19 +343,23 @@ bool sudoku_has_naked_singles(const Sudoku& s) { return sudoku_num_naked_singles
 
 // remove naked singles: fill in candidate value & return no. of removed naked singles
 int sudoku_remove_naked_singles(Sudoku& s) {
+    return sudoku_apply_naked_singles(s, sudoku_naked_singles(s));
+}
 
-    single_vec naked_singles      = sudoku_naked_singles(s);
-    int num_naked_singles_removed = naked_singles.size();
+// apply naked singles found before: fill in candidate value, update the candidates of
+// the affected cells only & return no. of applied naked singles (stale ones skipped)
+int sudoku_apply_naked_singles(Sudoku& s, const single_vec& naked_singles) {
 
-    for (int i = 0; i < num_naked_singles_removed; ++i) {
-        // 1st element of tuple contains cell no.
-        // 4th element of tuple contains candidate value
-        s(get<0>(naked_singles[i])).val = get<3>(naked_singles[i]);
+    int applied = 0;
+    for (const auto& e : naked_singles) {
+        const auto& [cnt, region, subregion, value] = e;
+        if (s(cnt).val != 0 || !s(cnt).cand.contains(value)) continue;
+        s.set_value(cnt, value);
+        sudoku_update_candidates_peers_of_cell(s, cnt);
+        ++applied;
     }
 
-    sudoku_update_candidates_all_cells(s);
-
-    return num_naked_singles_removed;
+    return applied;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -274,27 +371,31 @@ single_vec sudoku_hidden_singles_in_subregion(const Sudoku& s, const Region_t re
 
     // vector of tuples with (cell-no., region, subregion, value)
     single_vec hidden_singles;
-    vector<int> cand_count{};        // candidate occurrance count
-    vector<list<int>> cand_pos{};    // candidate position index
 
-    // count how often which entry occurs in candidate sets
-    cand_count = sudoku_count_candidate_entries_in_subregion(s, region, subregion);
-
-    // store index where elements occur in current subregion (index i)
-    cand_pos = sudoku_candidate_positions_in_subregion(s, region, subregion, cand_count);
-
-    // identify hidden singles
-    for (int k = 0; k < s.region_size; ++k) {    // for each value k+1 of the entry list
-        if (cand_count[k] == 1) {    // condition missing to exclude naked singles at this
-                                     // point so those will be found as well
-            // potential hidden single found at position cnt with value k+1
-            int cnt   = s.region_to_cnt(region, subregion, cand_pos[k].front());
-            int value = k + 1;
-            // only add it to the list, if it is not a naked twin,
+    // accumulate candidates of the region bit-parallel: a value is set in "twice" as
+    // soon as it has been seen in a second cell
+    cand_mask_t once  = 0;    // candidate seen in at least one cell
+    cand_mask_t twice = 0;    // candidate seen in at least two cells
+    for (int cnt : s.region_cells(region, subregion)) {
+        const cand_mask_t m = s(cnt).cand.mask();
+        twice |= once & m;
+        once |= m;
+    }
+    const cand_mask_t exactly_once = once & ~twice;
+
+    // identify hidden singles (in ascending order of values)
+    // (naked singles are found here as well and excluded in the check below)
+    for (cand_mask_t m = exactly_once; m != 0; m &= m - 1) {
+        const cand_mask_t b = m & -m;    // lowest remaining value
+        const int value     = countr_zero(m) + 1;
+        for (int cnt : s.region_cells(region, subregion)) {
+            if ((s(cnt).cand.mask() & b) == 0) continue;
+            // only add it to the list, if it is not a naked single,
             // i.e. if the cell still has more than 1 candidate
             if (s(cnt).cand.size() > 1) {
                 hidden_singles.push_back(make_tuple(cnt, region, subregion, value));
             }
+            break;    // value occurs in this cell only
         }
     }
 
@@ -342,23 +443,22 @@ single_vec sudoku_hidden_singles(const Sudoku& s) {
                           region_singles.end());
 
     // remove hidden single entries that occur more than once
-    // (same hidden single can occur from perspective of different regions)
-    sort(hidden_singles.begin(), hidden_singles.end(),
-         // sort entries according to 1st element of tuple (cell no.)
-         [](const tuple<int, Region_t, int, int>& a,
-            const tuple<int, Region_t, int, int>& b) -> bool {
-             return get<0>(a) < get<0>(b);
-         });
-    // erase duplicates for same cell no.
-    // (even if the same cell is found from perspective of different regions, the value
-    // can only be set once)
-    auto last = unique(hidden_singles.begin(), hidden_singles.end(),
-                       // eliminate entries with same 1st element
-                       [](const tuple<int, Region_t, int, int>& a,
-                          const tuple<int, Region_t, int, int>& b) -> bool {
-                           return get<0>(a) == get<0>(b);
-                       });
-    hidden_singles.erase(last, hidden_singles.end());    // actually erase elements
+    // (same hidden single can occur from perspective of different regions; even then
+    // the value can only be set once): keep the first entry found for each cell and
+    // return the entries ordered by cell no.
+    vector<bool> cell_found(s.total_size, false);
+    vector<int> entry_of_cell(s.total_size);
+    for (int i = 0; i < static_cast<int>(hidden_singles.size()); ++i) {
+        int cnt = get<0>(hidden_singles[i]);
+        if (cell_found[cnt]) continue;
+        cell_found[cnt]    = true;
+        entry_of_cell[cnt] = i;
+    }
+    single_vec unique_singles;
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        if (cell_found[cnt]) unique_singles.push_back(hidden_singles[entry_of_cell[cnt]]);
+    }
+    hidden_singles = std::move(unique_singles);
 
     // for (int i = 0; i < hidden_singles.size(); ++i) {
     //   cout << "\nFound hidden single at cell no. " << get<0>(hidden_singles[i]);
@@ -379,17 +479,23 @@ bool sudoku_has_hidden_singles(const Sudoku& s) {
 
 // remove hidden singles: fill in candidate value & return no. of removed hidden singles
 int sudoku_remove_hidden_singles(Sudoku& s) {
+    return sudoku_apply_hidden_singles(s, sudoku_hidden_singles(s));
+}
 
-    single_vec hidden_singles      = sudoku_hidden_singles(s);
-    int num_hidden_singles_removed = hidden_singles.size();
+// apply hidden singles found before: fill in candidate value, update the candidates of
+// the affected cells only & return no. of applied hidden singles (stale ones skipped)
+int sudoku_apply_hidden_singles(Sudoku& s, const single_vec& hidden_singles) {
 
+    int applied = 0;
     for (const auto& e : hidden_singles) {
         const auto& [cnt, region, subregion, value] = e;
-        s(cnt).val                                  = value;
+        if (s(cnt).val != 0 || !s(cnt).cand.contains(value)) continue;
+        s.set_value(cnt, value);
+        sudoku_update_candidates_peers_of_cell(s, cnt);
+        ++applied;
     }
-    sudoku_update_candidates_all_cells(s);
 
-    return num_hidden_singles_removed;
+    return applied;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -506,12 +612,18 @@ int sudoku_num_naked_twins(const Sudoku& s) { return sudoku_naked_twins(s).size(
 bool sudoku_has_naked_twins(const Sudoku& s) { return sudoku_num_naked_twins(s) > 0; }
 
 int sudoku_remove_naked_twins(Sudoku& s) {
+    return sudoku_apply_naked_twins(s, sudoku_naked_twins(s));
+}
 
-    twin_vec naked_twins        = sudoku_naked_twins(s);
-    int num_naked_twins_removed = naked_twins.size();
+// apply naked twins found before & return no. of applied naked twins (stale ones
+// skipped)
+int sudoku_apply_naked_twins(Sudoku& s, const twin_vec& naked_twins) {
 
+    int applied = 0;
     for (const auto& e : naked_twins) {
         const auto& [cnt1, cnt2, region, subregion, val1, val2] = e;
+        if (!cells_empty(s, {cnt1, cnt2})) continue;
+        ++applied;
         for (int i = 0; i < s.region_size; ++i) {
             int cnt = s.region_to_cnt(region, subregion, i);
             if (cnt == cnt1 || cnt == cnt2) {
@@ -524,7 +636,7 @@ int sudoku_remove_naked_twins(Sudoku& s) {
         }
     }
 
-    return num_naked_twins_removed;
+    return applied;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -640,34 +752,30 @@ int sudoku_num_hidden_twins(const Sudoku& s) { return sudoku_hidden_twins(s).siz
 bool sudoku_has_hidden_twins(const Sudoku& s) { return sudoku_num_hidden_twins(s) > 0; }
 
 int sudoku_remove_hidden_twins(Sudoku& s) {
+    return sudoku_apply_hidden_twins(s, sudoku_hidden_twins(s));
+}
 
-    twin_vec hidden_twins        = sudoku_hidden_twins(s);
-    int num_hidden_twins_removed = hidden_twins.size();
+// apply hidden twins found before & return no. of applied hidden twins (stale ones
+// skipped)
+int sudoku_apply_hidden_twins(Sudoku& s, const twin_vec& hidden_twins) {
 
+    int applied = 0;
     for (const auto& e : hidden_twins) {
         const auto& [cnt1, cnt2, region, subregion, val1, val2] = e;
 
         // in cells s(cnt1) and s(cnt2) keep only candidates that correspond to val1 or
         // val2
-        for (auto iter = s(cnt1).cand.begin(); iter != s(cnt1).cand.end();) {
-            if (*iter == val1 || *iter == val2) {
-                ++iter;
-            }    // keep those values
-            else {
-                iter = s(cnt1).cand.erase(iter);
-            }    // get rid of those values
-        }
-        for (auto iter = s(cnt2).cand.begin(); iter != s(cnt2).cand.end();) {
-            if (*iter == val1 || *iter == val2) {
-                ++iter;
-            }    // keep those values
-            else {
-                iter = s(cnt2).cand.erase(iter);
-            }    // get rid of those values
+        const cand_mask_t keep =
+            Sudoku_candidates::bit(val1) | Sudoku_candidates::bit(val2);
+        if (!cells_empty(s, {cnt1, cnt2}) || !values_left(s, {cnt1, cnt2}, keep)) {
+            continue;
         }
+        s(cnt1).cand &= keep;
+        s(cnt2).cand &= keep;
+        ++applied;
     }
 
-    return num_hidden_twins_removed;
+    return applied;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -706,9 +814,9 @@ triple_vec sudoku_naked_triples_in_subregion(const Sudoku& s, const Region_t reg
                 // at least 2 and at most 3 candidates and check whether the combinded set
                 // has only 3 candidates (than it is a potential naked triple)
 
-                set<int> combined_cand(s(cnt_i).cand);
-                combined_cand.insert(s(cnt_j).cand.begin(), s(cnt_j).cand.end());
-                combined_cand.insert(s(cnt_k).cand.begin(), s(cnt_k).cand.end());
+                Sudoku_candidates combined_cand(s(cnt_i).cand.mask() |
+                                                s(cnt_j).cand.mask() |
+                                                s(cnt_k).cand.mask());
 
                 if (combined_cand.size() == 3 &&
                     pairwise_different_if_size2(s(cnt_i).cand, s(cnt_j).cand,
@@ -723,13 +831,13 @@ triple_vec sudoku_naked_triples_in_subregion(const Sudoku& s, const Region_t reg
                     // make sure, that the remaining cells still have candidates left to
                     // be removed otherwise don't add this naked triple to the list of
                     // found triples
-                    set<int> combined_other_cand{};
+                    cand_mask_t combined_other_mask = 0;
                     for (int h = 0; h < s.region_size; ++h) {
                         int cnt_h = s.region_to_cnt(region, subregion, h);
                         if (cnt_h == cnt_i || cnt_h == cnt_j || cnt_h == cnt_k) continue;
-                        combined_other_cand.insert(s(cnt_h).cand.begin(),
-                                                   s(cnt_h).cand.end());
+                        combined_other_mask |= s(cnt_h).cand.mask();
                     }
+                    Sudoku_candidates combined_other_cand(combined_other_mask);
                     int combined_other_remove_count = combined_other_cand.count(val[0]);
                     combined_other_remove_count += combined_other_cand.count(val[1]);
                     combined_other_remove_count += combined_other_cand.count(val[2]);
@@ -822,12 +930,18 @@ int sudoku_num_naked_triples(const Sudoku& s) { return sudoku_naked_triples(s).s
 bool sudoku_has_naked_triples(const Sudoku& s) { return sudoku_num_naked_triples(s) > 0; }
 
 int sudoku_remove_naked_triples(Sudoku& s) {
+    return sudoku_apply_naked_triples(s, sudoku_naked_triples(s));
+}
 
-    triple_vec naked_triples      = sudoku_naked_triples(s);
-    int num_naked_triples_removed = naked_triples.size();
+// apply naked triples found before & return no. of applied naked triples (stale ones
+// skipped)
+int sudoku_apply_naked_triples(Sudoku& s, const triple_vec& naked_triples) {
 
+    int applied = 0;
     for (const auto& e : naked_triples) {
         const auto& [cnt1, cnt2, cnt3, region, subregion, val1, val2, val3] = e;
+        if (!cells_empty(s, {cnt1, cnt2, cnt3})) continue;
+        ++applied;
         for (int i = 0; i < s.region_size; ++i) {
             int cnt = s.region_to_cnt(region, subregion, i);
             if (cnt == cnt1 || cnt == cnt2 || cnt == cnt3) {
@@ -841,7 +955,7 @@ int sudoku_remove_naked_triples(Sudoku& s) {
         }
     }
 
-    return num_naked_triples_removed;
+    return applied;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1033,42 +1147,33 @@ bool sudoku_has_hidden_triples(const Sudoku& s) {
 }
 
 int sudoku_remove_hidden_triples(Sudoku& s) {
+    return sudoku_apply_hidden_triples(s, sudoku_hidden_triples(s));
+}
 
-    triple_vec hidden_triples      = sudoku_hidden_triples(s);
-    int num_hidden_triples_removed = hidden_triples.size();
+// apply hidden triples found before & return no. of applied hidden triples (stale ones
+// skipped)
+int sudoku_apply_hidden_triples(Sudoku& s, const triple_vec& hidden_triples) {
 
+    int applied = 0;
     for (const auto& e : hidden_triples) {
         const auto& [cnt1, cnt2, cnt3, region, subregion, val1, val2, val3] = e;
 
         // in cells s(cnt1), s(cnt2) and s(cnt3) keep only candidates that
         // correspond to val1, val2 and val3
-        for (auto iter = s(cnt1).cand.begin(); iter != s(cnt1).cand.end();) {
-            if (*iter == val1 || *iter == val2 || *iter == val3) {
-                ++iter;
-            }    // keep those values
-            else {
-                iter = s(cnt1).cand.erase(iter);
-            }    // get rid of those values
-        }
-        for (auto iter = s(cnt2).cand.begin(); iter != s(cnt2).cand.end();) {
-            if (*iter == val1 || *iter == val2 || *iter == val3) {
-                ++iter;
-            }    // keep those values
-            else {
-                iter = s(cnt2).cand.erase(iter);
-            }    // get rid of those values
-        }
-        for (auto iter = s(cnt3).cand.begin(); iter != s(cnt3).cand.end();) {
-            if (*iter == val1 || *iter == val2 || *iter == val3) {
-                ++iter;
-            }    // keep those values
-            else {
-                iter = s(cnt3).cand.erase(iter);
-            }    // get rid of those values
+        const cand_mask_t keep = Sudoku_candidates::bit(val1) |
+                                 Sudoku_candidates::bit(val2) |
+                                 Sudoku_candidates::bit(val3);
+        if (!cells_empty(s, {cnt1, cnt2, cnt3}) ||
+            !values_left(s, {cnt1, cnt2, cnt3}, keep)) {
+            continue;
         }
+        s(cnt1).cand &= keep;
+        s(cnt2).cand &= keep;
+        s(cnt3).cand &= keep;
+        ++applied;
     }
 
-    return num_hidden_triples_removed;
+    return applied;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1116,10 +1221,9 @@ quad_vec sudoku_naked_quadruples_in_subregion(const Sudoku& s, const Region_t re
                     // whether the combinded set has only 4 candidates (than it is a
                     // potential naked quad)
 
-                    set<int> combined_cand(s(cnt_i).cand);
-                    combined_cand.insert(s(cnt_j).cand.begin(), s(cnt_j).cand.end());
-                    combined_cand.insert(s(cnt_k).cand.begin(), s(cnt_k).cand.end());
-                    combined_cand.insert(s(cnt_l).cand.begin(), s(cnt_l).cand.end());
+                    Sudoku_candidates combined_cand(
+                        s(cnt_i).cand.mask() | s(cnt_j).cand.mask() |
+                        s(cnt_k).cand.mask() | s(cnt_l).cand.mask());
 
                     if (combined_cand.size() == 4 &&
                         pairwise_different_if_size2(s(cnt_i).cand, s(cnt_j).cand,
@@ -1134,15 +1238,15 @@ quad_vec sudoku_naked_quadruples_in_subregion(const Sudoku& s, const Region_t re
                         // make sure, that the remaining cells still have candidates left
                         // to be removed otherwise don't add this naked quad to the list
                         // of found quadruples
-                        set<int> combined_other_cand{};
+                        cand_mask_t combined_other_mask = 0;
                         for (int h = 0; h < s.region_size; ++h) {
                             int cnt_h = s.region_to_cnt(region, subregion, h);
                             if (cnt_h == cnt_i || cnt_h == cnt_j || cnt_h == cnt_k ||
                                 cnt_h == cnt_l)
                                 continue;
-                            combined_other_cand.insert(s(cnt_h).cand.begin(),
-                                                       s(cnt_h).cand.end());
+                            combined_other_mask |= s(cnt_h).cand.mask();
                         }
+                        Sudoku_candidates combined_other_cand(combined_other_mask);
                         int combined_other_remove_count =
                             combined_other_cand.count(val[0]);
                         combined_other_remove_count += combined_other_cand.count(val[1]);
@@ -1220,13 +1324,19 @@ bool sudoku_has_naked_quadruples(const Sudoku& s) {
 }
 
 int sudoku_remove_naked_quadruples(Sudoku& s) {
+    return sudoku_apply_naked_quadruples(s, sudoku_naked_quadruples(s));
+}
 
-    quad_vec naked_quadruples        = sudoku_naked_quadruples(s);
-    int num_naked_quadruples_removed = naked_quadruples.size();
+// apply naked quadruples found before & return no. of applied naked quadruples (stale
+// ones skipped)
+int sudoku_apply_naked_quadruples(Sudoku& s, const quad_vec& naked_quadruples) {
 
+    int applied = 0;
     for (const auto& e : naked_quadruples) {
         const auto& [cnt1, cnt2, cnt3, cnt4, region, subregion, val1, val2, val3, val4] =
             e;
+        if (!cells_empty(s, {cnt1, cnt2, cnt3, cnt4})) continue;
+        ++applied;
         for (int i = 0; i < s.region_size; ++i) {
             int cnt = s.region_to_cnt(region, subregion, i);
             if (cnt == cnt1 || cnt == cnt2 || cnt == cnt3 || cnt == cnt4) {
@@ -1241,7 +1351,7 @@ int sudoku_remove_naked_quadruples(Sudoku& s) {
         }
     }
 
-    return num_naked_quadruples_removed;
+    return applied;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1249,7 +1359,14 @@ int sudoku_remove_naked_quadruples(Sudoku& s) {
 //
 // assumption on input: valid sudoku with some empty cells left
 //////////////////////////////////////////////////////////////////////////////////////////
-std::pair<int, Sudoku> sudoku_remove_recursive(Sudoku s, int lvl) {
+// search was cancelled from outside (see Sudoku_search_options::cancel)
+static bool search_cancelled(const std::atomic<bool>* cancel) {
+    return cancel != nullptr && cancel->load(std::memory_order_relaxed);
+}
+
+// (search nodes are added to *nodes, if set)
+static std::pair<int, Sudoku>
+remove_recursive_run(Sudoku s, const std::atomic<bool>* cancel, long* nodes, int lvl) {
 
     // for debugging only: prefix string for output dependent on recursion level
     // std::string prefix = std::to_string(lvl) + ": ";
@@ -1262,6 +1379,14 @@ std::pair<int, Sudoku> sudoku_remove_recursive(Sudoku s, int lvl) {
         return std::make_pair(0, s);    // return sudoku unchanged
     }
 
+    // use the solver specialized for the shape of s, if there is one
+    // (searches in the same order and thus finds the same solution)
+    if (lvl == 0) {
+        if (auto res = sudoku_remove_recursive_fixed(s, cancel, nodes)) { return *res; }
+    }
+    if (search_cancelled(cancel)) return std::make_pair(0, s);
+    if (nodes != nullptr) ++*nodes;
+
     // find first non-empty cells
     int cnt = sudoku_get_empty(s);
     // returns valid index for first non-empty cell, since num_empty_before > 0
@@ -1279,8 +1404,8 @@ std::pair<int, Sudoku> sudoku_remove_recursive(Sudoku s, int lvl) {
         else
             s = s_old;    // restore initial state for next try
 
-        s(cnt).val = cv;    // set candidate value
-        sudoku_update_candidates_affected_by_cell(s, cnt);
+        s.set_value(cnt, cv);    // set candidate value
+        sudoku_update_candidates_peers_of_cell(s, cnt);
 
         // std::cout << prefix << "removed cv = " << cv << " in cell " << cnt << "\n";
 
@@ -1293,7 +1418,10 @@ std::pair<int, Sudoku> sudoku_remove_recursive(Sudoku s, int lvl) {
                 // => further recursion
                 // std::cout << prefix << "calling sudoku_remove_recursive.\n\n";
                 int num_removed_rec;
-                std::tie(num_removed_rec, s) = sudoku_remove_recursive(s, lvl + 1);
+                std::tie(num_removed_rec, s) =
+                    remove_recursive_run(s, cancel, nodes, lvl + 1);
+
+                if (search_cancelled(cancel)) break;    // give up
 
                 if (num_removed_rec == 0) {
 
@@ -1337,70 +1465,213 @@ std::pair<int, Sudoku> sudoku_remove_recursive(Sudoku s, int lvl) {
     return std::make_pair(0, s);
 }
 
-std::vector<int> sudoku_num_algo_solutions(const Sudoku& s) {
+std::pair<int, Sudoku> sudoku_remove_recursive(Sudoku s, int lvl) {
+    return remove_recursive_run(std::move(s), nullptr, nullptr, lvl);
+}
+
+std::pair<int, Sudoku> sudoku_remove_recursive(Sudoku s, const Sudoku_search_options& opt,
+                                               Sudoku_search_stats& stats) {
+
+    if (opt.backjumping) return sudoku_remove_recursive_cbj(std::move(s), opt, stats);
+
+    // plain search (node count only)
+    return remove_recursive_run(std::move(s), opt.cancel, &stats.nodes, 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// count solutions with early stopping
+//////////////////////////////////////////////////////////////////////////////////////////
+// (tt: transposition table or nullptr, salt: root_salt() of the root; stats only used
+// with a table)
+static void count_solutions_run(const Sudoku& s, int limit, int& num_solutions,
+                                Sudoku_transposition_table* tt, std::uint64_t salt,
+                                Sudoku_search_stats& stats) {
+
+    // branch on the empty cell with the fewest candidates
+    int cnt       = -1;
+    int min_cand  = s.region_size + 1;
+    int num_empty = 0;
+    for (int c = 0; c < s.total_size; ++c) {
+        if (s(c).val != 0) continue;
+        ++num_empty;
+        const int num_cand = s(c).cand.size();
+        if (num_cand == 0) return;    // dead end
+        if (num_cand < min_cand) {
+            min_cand = num_cand;
+            cnt      = c;
+        }
+    }
+    if (cnt < 0) {
+        ++num_solutions;    // all cells filled with candidate values: solution
+        return;
+    }
+
+    ++stats.nodes;
+    using Outcome     = Sudoku_transposition_table::Outcome;
+    std::uint64_t key = 0;
+    std::uint32_t tag = 0;
+    if (tt != nullptr) {
+        key = s.hash() ^ salt;
+        tag = Sudoku_transposition_table::tag(s, salt);
+        if (auto e = tt->probe(key, tag, stats)) {
+            if (e->outcome == Outcome::count) {
+                num_solutions += static_cast<int>(
+                    std::min<std::uint32_t>(e->count, limit - num_solutions));
+            }
+            return;
+        }
+    }
+
+    const int num_solutions_before = num_solutions;
+    for (auto const& cv : s(cnt).cand) {
+        if (num_solutions >= limit) return;
+        Sudoku s_try = s;
+        s_try.set_value(cnt, cv);
+        sudoku_update_candidates_peers_of_cell(s_try, cnt);
+        count_solutions_run(s_try, limit, num_solutions, tt, salt, stats);
+    }
+
+    // subtree searched completely (counting did not stop at limit): exact count
+    if (tt != nullptr && num_solutions < limit) {
+        const int n = num_solutions - num_solutions_before;
+        tt->store(key, tag, num_empty, n == 0 ? Outcome::dead : Outcome::count, n, stats);
+    }
+}
+
+int sudoku_count_solutions(const Sudoku& s, int limit) {
+
+    // candidates are derived from the entries only
+    Sudoku s_count(s);
+    sudoku_reset_candidates_all_cells(s_count);
+
+    return sudoku_count_solutions_within_candidates(s_count, limit);
+}
+
+int sudoku_count_solutions(const Sudoku& s, int limit, const Sudoku_search_options& opt,
+                           Sudoku_search_stats& stats) {
+
+    Sudoku s_count(s);
+    sudoku_reset_candidates_all_cells(s_count);
+
+    return sudoku_count_solutions_within_candidates(s_count, limit, opt, stats);
+}
+
+int sudoku_count_solutions_within_candidates(const Sudoku& s, int limit) {
+
+    const Sudoku_search_options opt;    // no transposition table
+    Sudoku_search_stats stats;
+    return sudoku_count_solutions_within_candidates(s, limit, opt, stats);
+}
+
+int sudoku_count_solutions_within_candidates(const Sudoku& s, int limit,
+                                             const Sudoku_search_options& opt,
+                                             Sudoku_search_stats& stats) {
+
+    if (limit <= 0 || !sudoku_is_valid(s)) return 0;
+
+    // counting uses the caller's table only (see opt.tt in sudoku_solve.h)
+    int num_solutions = 0;
+    if (!opt.transposition || opt.tt == nullptr) {
+        if (auto res = sudoku_count_solutions_fixed(s, limit)) return *res;
+        count_solutions_run(s, limit, num_solutions, nullptr, 0, stats);
+        return num_solutions;
+    }
+
+    // with transposition table: generic counter (the specialized solvers keep no hash);
+    // the candidates of s may be reduced below those of its values, so the keys depend
+    // on them as well (see sudoku_solve_tt.h)
+    Sudoku s_count(s);
+    s_count.rehash();
+    count_solutions_run(s_count, limit, num_solutions, opt.tt,
+                        Sudoku_transposition_table::root_salt(s_count), stats);
+    return num_solutions;
+}
+
+Sudoku_algo_solutions sudoku_algo_solutions(const Sudoku& s) {
+
+    Sudoku_algo_solutions sol;
+
+    sol.naked_singles    = sudoku_naked_singles(s);
+    sol.hidden_singles   = sudoku_hidden_singles(s);
+    sol.naked_twins      = sudoku_naked_twins(s);
+    sol.hidden_twins     = sudoku_hidden_twins(s);
+    sol.naked_triples    = sudoku_naked_triples(s);
+    sol.hidden_triples   = sudoku_hidden_triples(s);
+    sol.naked_quadruples = sudoku_naked_quadruples(s);
+
+    return sol;
+}
+
+std::vector<int> sudoku_num_algo_solutions(const Sudoku_algo_solutions& sol) {
 
     std::vector<int> sol_count;
 
     // sequence of elements must correspond to enum class Sudoku_solution_t
-    sol_count.push_back(sudoku_num_naked_singles(s));
-    sol_count.push_back(sudoku_num_hidden_singles(s));
-    sol_count.push_back(sudoku_num_naked_twins(s));
-    sol_count.push_back(sudoku_num_hidden_twins(s));
-    sol_count.push_back(sudoku_num_naked_triples(s));
-    sol_count.push_back(sudoku_num_hidden_triples(s));
-    sol_count.push_back(sudoku_num_naked_quadruples(s));
+    sol_count.push_back(sol.naked_singles.size());
+    sol_count.push_back(sol.hidden_singles.size());
+    sol_count.push_back(sol.naked_twins.size());
+    sol_count.push_back(sol.hidden_twins.size());
+    sol_count.push_back(sol.naked_triples.size());
+    sol_count.push_back(sol.hidden_triples.size());
+    sol_count.push_back(sol.naked_quadruples.size());
 
     return sol_count;
 }
 
+std::vector<int> sudoku_num_algo_solutions(const Sudoku& s) {
+    return sudoku_num_algo_solutions(sudoku_algo_solutions(s));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // remove all types of singles, twins, etc. by algorithm
 //////////////////////////////////////////////////////////////////////////////////////////
 int sudoku_remove_algo_all(Sudoku& s) {
+    return sudoku_remove_algo_all(s, sudoku_algo_solutions(s));
+}
+
+int sudoku_remove_algo_all(Sudoku& s, Sudoku_algo_solutions sol) {
+
+    //
+    // sol holds the solutions found for the current state of s. Each iteration applies
+    // them and then runs every finder exactly once on the new state, i.e. the finder
+    // results are not recomputed by the sudoku_remove_* functions. All solutions of
+    // one iteration are derived from the same state, so an earlier one may have made a
+    // later one stale (its cell filled, its value no candidate any more, e.g. a cell
+    // found as naked and as hidden single): the sudoku_apply_* functions skip those.
+    //
 
     int num_entries_before = sudoku_num_entries(s);
 
     // entries for Sudoku_solution_t
     std::vector<int> remove_count(Sudoku_solution_t::enum_count, 0);
 
-    std::vector<int> sol_count = sudoku_num_algo_solutions(s);
+    std::vector<int> sol_count = sudoku_num_algo_solutions(sol);
     int num_sol                = std::accumulate(sol_count.cbegin(), sol_count.cend(), 0);
 
     while (num_sol > 0 &&
            sudoku_is_valid(s)    // stop iteration in recursive calls for invalid sudokus
     ) {
 
-        if (sol_count[Sudoku_solution_t::naked_single] > 0) {
-            remove_count[Sudoku_solution_t::naked_single] +=
-                sudoku_remove_naked_singles(s);
-        }
-        if (sol_count[Sudoku_solution_t::hidden_single] > 0) {
-            remove_count[Sudoku_solution_t::hidden_single] +=
-                sudoku_remove_hidden_singles(s);
-        }
+        remove_count[Sudoku_solution_t::naked_single] +=
+            sudoku_apply_naked_singles(s, sol.naked_singles);
+        remove_count[Sudoku_solution_t::hidden_single] +=
+            sudoku_apply_hidden_singles(s, sol.hidden_singles);
 
-        if (sol_count[Sudoku_solution_t::naked_twin] > 0) {
-            remove_count[Sudoku_solution_t::naked_twin] += sudoku_remove_naked_twins(s);
-        }
-        if (sol_count[Sudoku_solution_t::hidden_twin] > 0) {
-            remove_count[Sudoku_solution_t::hidden_twin] += sudoku_remove_hidden_twins(s);
-        }
+        remove_count[Sudoku_solution_t::naked_twin] +=
+            sudoku_apply_naked_twins(s, sol.naked_twins);
+        remove_count[Sudoku_solution_t::hidden_twin] +=
+            sudoku_apply_hidden_twins(s, sol.hidden_twins);
 
-        if (sol_count[Sudoku_solution_t::naked_triple] > 0) {
-            remove_count[Sudoku_solution_t::naked_triple] +=
-                sudoku_remove_naked_triples(s);
-        }
-        if (sol_count[Sudoku_solution_t::hidden_triple] > 0) {
-            remove_count[Sudoku_solution_t::hidden_triple] +=
-                sudoku_remove_hidden_triples(s);
-        }
+        remove_count[Sudoku_solution_t::naked_triple] +=
+            sudoku_apply_naked_triples(s, sol.naked_triples);
+        remove_count[Sudoku_solution_t::hidden_triple] +=
+            sudoku_apply_hidden_triples(s, sol.hidden_triples);
 
-        if (sol_count[Sudoku_solution_t::naked_quadruple] > 0) {
-            remove_count[Sudoku_solution_t::naked_quadruple] +=
-                sudoku_remove_naked_quadruples(s);
-        }
+        remove_count[Sudoku_solution_t::naked_quadruple] +=
+            sudoku_apply_naked_quadruples(s, sol.naked_quadruples);
 
-        sol_count = sudoku_num_algo_solutions(s);
+        sol       = sudoku_algo_solutions(s);
+        sol_count = sudoku_num_algo_solutions(sol);
         num_sol   = std::accumulate(sol_count.cbegin(), sol_count.cend(), 0);
     }
 
@@ -1419,6 +1690,56 @@ int sudoku_remove_algo_all(Sudoku& s) {
 //////////////////////////////////////////////////////////////////////////////////////////
 std::pair<int, Sudoku> sudoku_remove_recursive_algo_all_mixed(Sudoku s, int lvl) {
 
+    const Sudoku_search_options opt;    // plain search
+    Sudoku_search_stats stats;
+    return sudoku_remove_recursive_algo_all_mixed(std::move(s), opt, stats, lvl);
+}
+
+// one run of the mixed search (with node limit and random branching for restarts)
+struct Sudoku_mixed_run {
+    long node_limit{-1};              // max. no. of nodes of this run (-1: no limit)
+    long nodes{0};                    // nodes visited in this run
+    bool aborted{false};              // node limit reached or search cancelled
+    std::mt19937_64* rng{nullptr};    // random tie-breaking, if set
+    Sudoku_transposition_table* tt{nullptr};    // dead grids (shared by all runs)
+    std::uint64_t tt_salt{0};    // root_salt() of the root of the search
+};
+
+// cell to branch on: first empty cell, or (random run) an empty cell with the least
+// candidates, ties broken at random
+static int mixed_branch_cell(const Sudoku& s, Sudoku_mixed_run& run) {
+
+    if (run.rng == nullptr) return sudoku_get_empty(s);
+
+    int best = -1, best_size = 0, num_ties = 0;
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        if (s(cnt).val != 0) continue;
+        const int size = s(cnt).cand.size();
+        if (best < 0 || size < best_size) {
+            best      = cnt;
+            best_size = size;
+            num_ties  = 1;
+        }
+        else if (size == best_size && (*run.rng)() % ++num_ties == 0) {
+            best = cnt;    // reservoir sampling among ties
+        }
+    }
+    return best;
+}
+
+static std::pair<int, Sudoku>
+remove_recursive_algo_all_mixed_run(Sudoku s, const Sudoku_search_options& opt,
+                                    Sudoku_search_stats& stats, Sudoku_mixed_run& run,
+                                    int lvl) {
+
+    ++stats.nodes;
+    ++run.nodes;
+    const bool limit_reached = run.node_limit >= 0 && run.nodes > run.node_limit;
+    if (limit_reached || search_cancelled(opt.cancel)) {
+        run.aborted = true;
+        return std::make_pair(0, s);
+    }
+
     // for debugging only: prefix string for output dependent on recursion level
     // std::string prefix = std::to_string(lvl) + ": ";
     // for (int i = 0; i < lvl; ++i) { prefix = " " + prefix; }
@@ -1429,19 +1750,52 @@ std::pair<int, Sudoku> sudoku_remove_recursive_algo_all_mixed(Sudoku s, int lvl)
         // std::cout << prefix << "pre-conditions not met!\n\n";
         return std::make_pair(0, s);    // return sudoku unchanged
     }
+    s.check_hash();    // kept up to date by set_value() (debug builds only)
+
+    // grid known to have no solution: skip the whole subtree
+    const std::uint64_t key = s.hash() ^ run.tt_salt;
+    const std::uint32_t tag =
+        run.tt != nullptr ? Sudoku_transposition_table::tag(s, run.tt_salt) : 0;
+    if (run.tt != nullptr) {
+        if (auto e = run.tt->probe(key, tag, stats);
+            e != nullptr && e->outcome == Sudoku_transposition_table::Outcome::dead) {
+            return std::make_pair(0, s);
+        }
+    }
+
+    // optional: learn values by probing bivalue cells before branching
+    // (s_unprobed keeps the input to return it unchanged, if the search fails)
+    std::optional<Sudoku> s_unprobed;
+    if (opt.probing) {
+        Sudoku s_probed = s;
+        int num_entered = sudoku_probe_bivalue_cells(s_probed, opt, stats);
+        if (num_entered < 0) {
+            return std::make_pair(0, s);    // no solution: return sudoku unchanged
+        }
+        if (num_entered > 0) {
+            if (num_entered == num_empty_before) {
+                return std::make_pair(num_empty_before, s_probed);    // solved
+            }
+            s_unprobed = std::move(s);
+            s          = std::move(s_probed);
+        }
+    }
 
     // Might be further optimized here if we test whether the algo solution works, before
     // we start the recursive (mixed) approach. This can also be reached by calling
     // sudoku_remove_algo_all before trying the recursive approaches)
 
     // find first non-empty cells
-    int cnt = sudoku_get_empty(s);
+    int cnt = mixed_branch_cell(s, run);
     // returns valid index for first non-empty cell, since num_empty_before > 0
 
     auto s_old     = s;    // store initial sudoku unmodified
     bool first_run = true;
 
-    for (auto const& cv : s_old(cnt).cand) {
+    std::vector<int> values(s_old(cnt).cand.begin(), s_old(cnt).cand.end());
+    if (run.rng != nullptr) std::shuffle(values.begin(), values.end(), *run.rng);
+
+    for (auto const& cv : values) {
 
         // std::cout << prefix << "cnt = " << cnt << "\n";
         // std::cout << prefix << "cv = " << cv << "\n";
@@ -1451,8 +1805,8 @@ std::pair<int, Sudoku> sudoku_remove_recursive_algo_all_mixed(Sudoku s, int lvl)
         else
             s = s_old;    // restore initial state for next try
 
-        s(cnt).val = cv;    // set candidate value
-        sudoku_update_candidates_affected_by_cell(s, cnt);
+        s.set_value(cnt, cv);    // set candidate value
+        sudoku_update_candidates_peers_of_cell(s, cnt);
 
         // std::cout << prefix << "removed cv = " << cv << " in cell " << cnt << "\n";
 
@@ -1463,16 +1817,18 @@ std::pair<int, Sudoku> sudoku_remove_recursive_algo_all_mixed(Sudoku s, int lvl)
 
                 // there are further candidates to look for
 
-                std::vector<int> sol_count = sudoku_num_algo_solutions(s);
+                Sudoku_algo_solutions sol  = sudoku_algo_solutions(s);
+                std::vector<int> sol_count = sudoku_num_algo_solutions(sol);
                 int num_sol = std::accumulate(sol_count.cbegin(), sol_count.cend(), 0);
                 // std::cout << prefix << "num_sol = " << num_sol << "\n";
 
                 if (num_sol > 0) {
 
                     // if algorithmic solution possible, remove candidates
+                    // (reusing the solutions found above)
                     // std::cout << prefix << "calling algo:\n";
 
-                    int num_removed_algo = sudoku_remove_algo_all(s);
+                    int num_removed_algo = sudoku_remove_algo_all(s, std::move(sol));
                     // std::cout << prefix << "algo, num_removed_algo = ";
                     // std::cout << num_removed_algo << "\n";
 
@@ -1502,7 +1858,9 @@ std::pair<int, Sudoku> sudoku_remove_recursive_algo_all_mixed(Sudoku s, int lvl)
                 // std::cout << prefix << "calling recursive.\n\n";
                 int num_removed_rec;
                 std::tie(num_removed_rec, s) =
-                    sudoku_remove_recursive_algo_all_mixed(s, lvl + 1);
+                    remove_recursive_algo_all_mixed_run(s, opt, stats, run, lvl + 1);
+
+                if (run.aborted) break;    // node limit reached: give up this run
 
                 if (num_removed_rec == 0) {
 
@@ -1541,8 +1899,108 @@ std::pair<int, Sudoku> sudoku_remove_recursive_algo_all_mixed(Sudoku s, int lvl)
 
     // std::cout << prefix << "Reached end of routine. No candiates left for cell ";
     // std::cout << cnt << ".\n\n";
-    s = s_old;    // restore and return unmodified state
+    // all values failed (unless the run gave up): no solution for this grid
+    if (run.tt != nullptr && !run.aborted) {
+        run.tt->store(key, tag, num_empty_before,
+                      Sudoku_transposition_table::Outcome::dead, 0, stats);
+    }
+    // restore and return unmodified state
+    s = s_unprobed ? std::move(*s_unprobed) : s_old;
     return std::make_pair(0, s);
 }
 
-//
\ No newline at end of file
+// node limit of restart run i
+// (base at least 1 and factor at least 1.1, so that the limits keep growing and the
+//  search stays complete for any options)
+static long mixed_restart_limit(const Sudoku_search_options& opt, long i) {
+    const long base = std::max(opt.restart_base, 1L);
+    if (opt.restarts == Sudoku_restart_t::luby) return base * sudoku_luby(i);
+
+    // geometric (limited, so that the limit does not overflow; NaN is taken as 1.1, too)
+    const double factor = opt.restart_factor > 1.1 ? opt.restart_factor : 1.1;
+    double limit        = static_cast<double>(base);
+    for (long k = 0; k < i && limit < 1e15; ++k) limit *= factor;
+    return static_cast<long>(limit);
+}
+
+std::pair<int, Sudoku>
+sudoku_remove_recursive_algo_all_mixed(Sudoku s, const Sudoku_search_options& opt,
+                                       Sudoku_search_stats& stats, int lvl) {
+
+    s.rehash();    // values of s may have been written directly by the caller
+
+    // transposition table: given by the caller or one for this search
+    std::optional<Sudoku_transposition_table> tt;
+    Sudoku_transposition_table* tt_ptr = nullptr;
+    std::uint64_t tt_salt              = 0;
+    if (opt.transposition) {
+        if (opt.tt == nullptr) tt.emplace(opt.tt_max_bytes, opt.tt_replace);
+        tt_ptr  = tt ? &*tt : opt.tt;
+        tt_salt = Sudoku_transposition_table::root_salt(s);
+    }
+
+    if (opt.restarts == Sudoku_restart_t::none) {
+        Sudoku_mixed_run run;
+        run.tt      = tt_ptr;
+        run.tt_salt = tt_salt;
+        return remove_recursive_algo_all_mixed_run(std::move(s), opt, stats, run, lvl);
+    }
+
+    // restarts: runs with growing node limits, branching randomized by a generator
+    // seeded once per search (i.e. reproducible for the same seed); the limits grow
+    // without bound, so the search stays complete
+    std::mt19937_64 rng(opt.seed);
+    for (long i = 0;; ++i) {
+        Sudoku_mixed_run run;
+        run.node_limit = mixed_restart_limit(opt, i);
+        run.rng        = &rng;
+        run.tt         = tt_ptr;    // dead grids stay dead across runs
+        run.tt_salt    = tt_salt;
+        auto res       = remove_recursive_algo_all_mixed_run(s, opt, stats, run, lvl);
+        if (!run.aborted || search_cancelled(opt.cancel)) return res;
+        ++stats.restarts;
+    }
+}
+
+//
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// search with a selectable engine
+//////////////////////////////////////////////////////////////////////////////////////////
+std::pair<int, Sudoku> sudoku_remove_engine(Sudoku s, Sudoku_engine_t engine) {
+
+    const Sudoku_search_options opt;    // plain search
+    Sudoku_search_stats stats;
+    return sudoku_remove_engine(std::move(s), engine, opt, stats);
+}
+
+std::pair<int, Sudoku> sudoku_remove_engine(Sudoku s, Sudoku_engine_t engine,
+                                            const Sudoku_search_options& opt,
+                                            Sudoku_search_stats& stats) {
+
+    switch (engine) {
+        case Sudoku_engine_t::recursive:
+            return sudoku_remove_recursive(std::move(s), opt, stats);
+        case Sudoku_engine_t::mixed:
+            return sudoku_remove_recursive_algo_all_mixed(std::move(s), opt, stats);
+        case Sudoku_engine_t::sat: {
+            Sudoku_sat_stats sat_stats;
+            auto res = sudoku_remove_sat(std::move(s), sat_stats, opt.cancel);
+            stats.nodes += sat_stats.decisions;
+            return res;
+        }
+        case Sudoku_engine_t::logic: {
+            int num_entries = sudoku_remove_algo_all(s);
+            return std::make_pair(num_entries, s);
+        }
+        case Sudoku_engine_t::portfolio: {
+            static const auto entries = sudoku_default_portfolio();
+            Sudoku_portfolio_stats portfolio_stats;
+            return sudoku_remove_portfolio(s, entries, portfolio_stats, opt.cancel);
+        }
+        case Sudoku_engine_t::batch: {
+            return sudoku_remove_recursive_batch({std::move(s)}).front();
+        }
+    }
+    return std::make_pair(0, s);    // unknown engine: return sudoku unchanged
+}
@@ -0,0 +1,138 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_solve_batch.h"
+#include "sudoku_simd.h"
+#include "sudoku_solve.h"
+
+#include <memory>    // unique_ptr
+#include <tuple>     // tie()
+
+using namespace std;
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+// same propagation, compiled for AVX2 (flatten: inline the lane loops, so that they are
+// vectorized for AVX2 as well); only called if the CPU supports AVX2
+template <typename Batch>
+__attribute__((target("avx2"), flatten)) static void
+propagate_avx2(typename Batch::Grid& g) {
+    Batch::propagate(g);
+}
+#define SUDOKU_BATCH_AVX2 1
+#endif
+
+// propagate with the best instruction set supported by the CPU
+template <typename Batch> static void propagate_dispatch(typename Batch::Grid& g) {
+#if defined(SUDOKU_BATCH_AVX2)
+    if (sudoku_simd_supported() == Sudoku_simd_t::avx2) {
+        propagate_avx2<Batch>(g);
+        return;
+    }
+#endif
+    Batch::propagate(g);
+}
+
+template <int t_region_size, int t_blocks_per_row, int t_blocks_per_col>
+void Sudoku_batch<t_region_size, t_blocks_per_row, t_blocks_per_col>::remove_recursive(
+    const Sudoku* s, int n, pair<int, Sudoku>* res) {
+
+    // grid is too large for the stack in case of 25x25 puzzles
+    auto g = make_unique<Grid>();
+
+    for (int l = 0; l < lanes; ++l) {
+        load(*g, l, s[(l < n) ? l : 0]);    // fill unused lanes with first puzzle
+    }
+    propagate_dispatch<Sudoku_batch>(*g);
+
+    for (int l = 0; l < n; ++l) {
+        if (g->dead[l] != 0) {
+            res[l] = make_pair(0, s[l]);    // no solution: return sudoku unchanged
+            continue;
+        }
+        int num_empty_before = sudoku_num_empty(s[l]);
+        Sudoku s_prop(s[l]);
+        store(*g, l, s_prop);
+        if (solved(*g, l)) {
+            res[l] = make_pair(num_empty_before, s_prop);
+            continue;
+        }
+        // propagation got stuck: branch with the scalar solver for this shape
+        // (the propagated state is consistent, so the pre-conditions hold)
+        int num_removed;
+        tie(num_removed, s_prop) = Fixed::remove_recursive(s_prop);
+        if (num_removed == 0) {
+            res[l] = make_pair(0, s[l]);
+        } else {
+            res[l] = make_pair(num_empty_before, s_prop);
+        }
+    }
+}
+
+// solve the puzzles puzzles[idx[0..]] of one shape in batches
+template <int t_region_size, int t_blocks_per_row, int t_blocks_per_col>
+static void remove_recursive_batches(const vector<Sudoku>& puzzles,
+                                     const vector<int>& idx,
+                                     vector<pair<int, Sudoku>>& res) {
+
+    using Batch = Sudoku_batch<t_region_size, t_blocks_per_row, t_blocks_per_col>;
+
+    vector<Sudoku> batch;
+    vector<pair<int, Sudoku>> batch_res;
+    for (size_t first = 0; first < idx.size(); first += Batch::lanes) {
+        size_t last = min(idx.size(), first + Batch::lanes);
+        batch.clear();
+        for (size_t i = first; i < last; ++i) batch.push_back(puzzles[idx[i]]);
+        batch_res.assign(batch.size(), make_pair(0, batch[0]));
+        Batch::remove_recursive(batch.data(), static_cast<int>(batch.size()),
+                                batch_res.data());
+        for (size_t i = first; i < last; ++i) {
+            res[idx[i]] = std::move(batch_res[i - first]);
+        }
+    }
+}
+
+vector<pair<int, Sudoku>> sudoku_remove_recursive_batch(const vector<Sudoku>& puzzles) {
+
+    vector<pair<int, Sudoku>> res;
+    res.reserve(puzzles.size());
+    for (const auto& s : puzzles) res.push_back(make_pair(0, s));
+
+    // collect puzzles per shape (same shapes as sudoku_remove_recursive_fixed());
+    // puzzles not meeting the pre-conditions of sudoku_remove_recursive() and puzzles
+    // of other shapes are solved one by one
+    vector<int> s933, s422, s623, s632, s1644, s2555;
+    for (int i = 0; i < static_cast<int>(puzzles.size()); ++i) {
+        const Sudoku& s = puzzles[i];
+        if (!sudoku_is_valid(s) || sudoku_num_empty(s) == 0) continue;    // unchanged
+
+        const auto shape = make_tuple(s.region_size, s.blocks_per_row, s.blocks_per_col);
+        if (shape == make_tuple(9, 3, 3)) {
+            s933.push_back(i);
+        } else if (shape == make_tuple(4, 2, 2)) {
+            s422.push_back(i);
+        } else if (shape == make_tuple(6, 2, 3)) {
+            s623.push_back(i);
+        } else if (shape == make_tuple(6, 3, 2)) {
+            s632.push_back(i);
+        } else if (shape == make_tuple(16, 4, 4)) {
+            s1644.push_back(i);
+        } else if (shape == make_tuple(25, 5, 5)) {
+            s2555.push_back(i);
+        } else {
+            res[i] = sudoku_remove_recursive(s);
+        }
+    }
+
+    remove_recursive_batches<9, 3, 3>(puzzles, s933, res);
+    remove_recursive_batches<4, 2, 2>(puzzles, s422, res);
+    remove_recursive_batches<6, 2, 3>(puzzles, s623, res);
+    remove_recursive_batches<6, 3, 2>(puzzles, s632, res);
+    // (larger shapes only if a Sudoku can hold them, see sudoku_max_region_size)
+    if constexpr (sudoku_max_region_size >= 16) {
+        remove_recursive_batches<16, 4, 4>(puzzles, s1644, res);
+    }
+    if constexpr (sudoku_max_region_size >= 25) {
+        remove_recursive_batches<25, 5, 5>(puzzles, s2555, res);
+    }
+
+    return res;
+}
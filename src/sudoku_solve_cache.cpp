@@ -0,0 +1,232 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_solve_cache.h"
+#include "sudoku_file.h"
+#include "sudoku_solve_helper.h"    // sudoku_mix64()
+
+#include <algorithm>    // reverse()
+#include <cstdio>       // snprintf()
+#include <fstream>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// helpers
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// sudoku of the shape of s with the entries of key (see sudoku_canonical_key()), or an
+// empty optional if key does not describe a full grid of this shape
+static optional<Sudoku> sudoku_from_key(const Sudoku& s, const string& key) {
+
+    Sudoku t(s.region_size, s.blocks_per_row, s.blocks_per_col);
+    const string prefix = sudoku_canonical_key(t);    // shape and empty grid
+    const size_t first  = prefix.size() - t.total_size;
+    if (key.size() != prefix.size() || key.compare(0, first, prefix, 0, first) != 0) {
+        return nullopt;
+    }
+    for (int cnt = 0; cnt < t.total_size; ++cnt) {
+        const char c = key[first + cnt];
+        const int v  = (c >= '0' && c <= '9') ? c - '0' : (c >= 'A') ? c - 'A' + 10 : -1;
+        if (v < 1 || v > t.region_size) return nullopt;
+        t.set_value(cnt, v);
+    }
+    return t;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Sudoku_solution_cache
+//////////////////////////////////////////////////////////////////////////////////////////
+
+Sudoku_solution_cache::Sudoku_solution_cache(std::size_t t_capacity) :
+    m_capacity(t_capacity) {}
+
+Sudoku_solution_cache::Hash
+Sudoku_solution_cache::hash(const std::string& canonical_key) {
+
+    // two independent 64 bit lanes (FNV-1a and a multiplicative hash), each finalized
+    uint64_t a = 0xcbf29ce484222325ULL;
+    uint64_t b = 0x9e3779b97f4a7c15ULL ^ canonical_key.size();
+    for (unsigned char c : canonical_key) {
+        a = (a ^ c) * 0x100000001b3ULL;
+        b = (b + c) * 0xff51afd7ed558ccdULL;
+        b ^= b >> 29;
+    }
+    return Hash{sudoku_mix64(a ^ (b >> 1)), sudoku_mix64(b)};
+}
+
+std::optional<std::pair<int, Sudoku>> Sudoku_solution_cache::lookup(const Sudoku& s) {
+    return lookup(s, sudoku_canonicalize(s));
+}
+
+std::optional<std::pair<int, Sudoku>>
+Sudoku_solution_cache::lookup(const Sudoku& s, const Sudoku_canonical& canon) {
+
+    const Hash h = hash(canon.key);
+    string solution;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        auto it = m_index.find(h);
+        if (it == m_index.end()) {
+            ++m_stats.misses;
+            return nullopt;
+        }
+        m_lru.splice(m_lru.begin(), m_lru, it->second);    // most recently used
+        solution = it->second->second;
+    }
+
+    auto res = solution_of(s, canon, solution);
+    lock_guard<mutex> lock(m_mutex);
+    if (res) {
+        ++m_stats.hits;
+    } else {
+        ++m_stats.misses;
+        ++m_stats.rejected;
+    }
+    return res;
+}
+
+std::optional<std::pair<int, Sudoku>>
+Sudoku_solution_cache::solution_of(const Sudoku& s, const Sudoku_canonical& canon,
+                                   const std::string& solution) {
+
+    if (solution.empty()) return std::make_pair(0, s);    // no solution
+
+    // map the solution of the canonical puzzle back onto s
+    auto solved = sudoku_from_key(s, solution);
+    if (!solved) return nullopt;    // other shape: not a valid entry for s
+    const Sudoku_transform inv = sudoku_inverse_transform(canon.transform);
+    Sudoku res                 = sudoku_apply_transform(*solved, inv);
+
+    // a full grid keeping the rules and the clues of s, else the entry is not the one
+    // of s (colliding hash or a corrupt file)
+    if (sudoku_num_empty(res) != 0 || !sudoku_is_valid(res)) return nullopt;
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        const int v = s.values()[cnt];
+        if (v != 0 && v != res.values()[cnt]) return nullopt;
+    }
+    return std::make_pair(sudoku_num_empty(s), res);
+}
+
+void Sudoku_solution_cache::insert(const Sudoku& s, const Sudoku& solved) {
+    insert(sudoku_canonicalize(s), solved);
+}
+
+void Sudoku_solution_cache::insert(const Sudoku_canonical& canon, const Sudoku& solved) {
+
+    string solution;    // empty: no solution
+    if (sudoku_num_empty(solved) == 0) {
+        solution = sudoku_canonical_key(sudoku_apply_transform(solved, canon.transform));
+    }
+    insert_entry(hash(canon.key), std::move(solution));
+}
+
+void Sudoku_solution_cache::insert_entry(const Hash& h, std::string solution) {
+
+    lock_guard<mutex> lock(m_mutex);
+    if (m_capacity == 0) return;
+
+    auto it = m_index.find(h);
+    if (it != m_index.end()) {    // e.g. solved concurrently by another thread
+        it->second->second = std::move(solution);
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return;
+    }
+
+    m_lru.emplace_front(h, std::move(solution));
+    m_index.emplace(h, m_lru.begin());
+    ++m_stats.insertions;
+    if (m_lru.size() > m_capacity) {    // evict the least recently used entry
+        m_index.erase(m_lru.back().first);
+        m_lru.pop_back();
+        ++m_stats.evictions;
+    }
+}
+
+std::size_t Sudoku_solution_cache::size() const {
+    lock_guard<mutex> lock(m_mutex);
+    return m_lru.size();
+}
+
+Sudoku_cache_stats Sudoku_solution_cache::stats() const {
+    lock_guard<mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void Sudoku_solution_cache::clear() {
+    lock_guard<mutex> lock(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+}
+
+bool Sudoku_solution_cache::save(const std::string& path) const {
+
+    string text;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        char hex[33];
+        for (const auto& [h, solution] : m_lru) {
+            snprintf(hex, sizeof(hex), "%016llx%016llx",
+                     static_cast<unsigned long long>(h.hi),
+                     static_cast<unsigned long long>(h.lo));
+            text += hex;
+            text += ' ';
+            text += solution.empty() ? string("-") : solution;
+            text += '\n';
+        }
+    }
+    // a crash while saving leaves the old file intact
+    return sudoku_replace_file(path, text);
+}
+
+int Sudoku_solution_cache::load(const std::string& path) {
+
+    ifstream is(path);
+    if (!is) return -1;
+
+    vector<Entry> entries;
+    string hex, solution;
+    while (is >> hex >> solution) {
+        if (hex.size() != 32 || hex.find_first_not_of("0123456789abcdef") != hex.npos) {
+            continue;    // not an entry
+        }
+        const Hash h{stoull(hex.substr(0, 16), nullptr, 16),
+                     stoull(hex.substr(16), nullptr, 16)};
+        entries.emplace_back(h, solution == "-" ? string() : solution);
+    }
+
+    // the file lists the most recently used entries first: insert them last
+    reverse(entries.begin(), entries.end());
+    for (auto& [h, sol] : entries) insert_entry(h, std::move(sol));
+    return static_cast<int>(entries.size());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solve with the cache
+//////////////////////////////////////////////////////////////////////////////////////////
+
+std::pair<int, Sudoku> sudoku_remove_cached(const Sudoku& s, Sudoku_solution_cache& cache,
+                                            Sudoku_engine_t engine) {
+
+    const Sudoku_search_options opt;    // plain search
+    Sudoku_search_stats stats;
+    return sudoku_remove_cached(s, cache, engine, opt, stats);
+}
+
+std::pair<int, Sudoku> sudoku_remove_cached(const Sudoku& s, Sudoku_solution_cache& cache,
+                                            Sudoku_engine_t engine,
+                                            const Sudoku_search_options& opt,
+                                            Sudoku_search_stats& stats) {
+
+    const Sudoku_canonical canon = sudoku_canonicalize(s);
+    if (auto hit = cache.lookup(s, canon)) return *hit;
+
+    auto res = sudoku_remove_engine(s, engine, opt, stats);
+
+    // a cancelled search returns s unchanged, which says nothing about s; the logic
+    // engine is not complete: only a solved sudoku is a definite result
+    if (opt.cancel && opt.cancel->load()) return res;
+    if (engine != Sudoku_engine_t::logic || sudoku_num_empty(res.second) == 0) {
+        cache.insert(canon, res.second);
+    }
+    return res;
+}
@@ -0,0 +1,472 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_solve_cbj.h"
+#include "sudoku_solve_fixed.h"
+
+#include <array>
+#include <atomic>
+#include <bit>    // countr_zero(), countl_zero(), popcount()
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// set of decision levels (1: first decision of the search)
+//////////////////////////////////////////////////////////////////////////////////////////
+template <int t_size> class Cbj_level_set {
+
+  public:
+    void insert(int l) { m_words[l >> 6] |= uint64_t{1} << (l & 63); }
+    void erase(int l) { m_words[l >> 6] &= ~(uint64_t{1} << (l & 63)); }
+    bool contains(int l) const { return (m_words[l >> 6] >> (l & 63)) & 1; }
+
+    void merge(const Cbj_level_set& other) {
+        for (size_t k = 0; k < m_words.size(); ++k) m_words[k] |= other.m_words[k];
+    }
+
+    int size() const {
+        int res = 0;
+        for (uint64_t w : m_words) res += popcount(w);
+        return res;
+    }
+
+    // latest level in the set (0: empty set)
+    int max() const {
+        for (int k = static_cast<int>(m_words.size()) - 1; k >= 0; --k) {
+            if (m_words[k] != 0) return 64 * k + 63 - countl_zero(m_words[k]);
+        }
+        return 0;
+    }
+
+    template <typename F> void for_each(F&& f) const {
+        for (size_t k = 0; k < m_words.size(); ++k) {
+            for (uint64_t w = m_words[k]; w != 0; w &= w - 1) {
+                f(static_cast<int>(64 * k) + countr_zero(w));
+            }
+        }
+    }
+
+  private:
+    array<uint64_t, (t_size + 64) / 64> m_words{};
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// search of Sudoku_fixed<> (same branching, same propagation of naked and hidden
+// singles), extended by the bookkeeping for conflict sets: each entry remembers when
+// and why it was made, so the decisions leading to a contradiction can be traced back
+//////////////////////////////////////////////////////////////////////////////////////////
+template <int t_region_size, int t_blocks_per_row, int t_blocks_per_col> class Cbj_fixed {
+
+    using Fixed  = Sudoku_fixed<t_region_size, t_blocks_per_row, t_blocks_per_col>;
+    using mask_t = typename Fixed::mask_t;
+    using cell_t = typename Fixed::cell_t;
+
+    static constexpr int region_size = Fixed::region_size;
+    static constexpr int total_size  = Fixed::total_size;
+    static constexpr int num_regions = Fixed::num_regions;
+    static constexpr mask_t all_mask = Fixed::all_mask;
+    static constexpr auto& tables    = Fixed::tables;
+
+    using Levels = Cbj_level_set<total_size>;
+
+    // cause of an entry: given (or forced before the first decision), naked single,
+    // decision of level l (naked - l); a hidden single stores its region
+    // (0..num_regions-1)
+    static constexpr int16_t given = -1;
+    static constexpr int16_t naked = -2;
+
+    struct Grid {
+        typename Fixed::Grid g;
+        array<uint16_t, total_size> stamp{};    // order of the entries (0: given)
+        array<int16_t, total_size> cause{};
+        // cell of region r holding value v (at[r][v-1], valid if it holds v)
+        array<array<cell_t, region_size>, num_regions> at{};
+        int num_stamps{0};
+    };
+
+    // regions (row, col, block) of each cell
+    static constexpr array<array<int, 3>, total_size> make_regions_of() {
+        array<array<int, 3>, total_size> res{};
+        for (int r = 0; r < num_regions; ++r) {
+            for (auto c : tables.region_cells[r]) res[c][r / region_size] = r;
+        }
+        return res;
+    }
+    static constexpr array<array<int, 3>, total_size> regions_of = make_regions_of();
+
+    struct Assignment {
+        int cnt;
+        int v;
+    };
+
+  public:
+    Cbj_fixed(const Sudoku_search_options& t_opt, Sudoku_search_stats& t_stats) :
+        m_opt(t_opt), m_stats(t_stats), m_path(total_size),
+        m_nogood_index(t_opt.nogoods ? total_size * region_size : 0) {}
+
+    // same as Sudoku_fixed<>::remove_recursive()
+    pair<int, Sudoku> remove_recursive(const Sudoku& s) {
+        Grid gr;
+        gr.g                       = Fixed::load(s);
+        const int num_empty_before = gr.g.num_empty;
+        for (int cnt = 0; cnt < total_size; ++cnt) {
+            if (gr.g.val[cnt] == 0 && gr.g.cand[cnt] == 0) return make_pair(0, s);
+        }
+        Levels conflict;
+        if (!propagate(gr, conflict)) return make_pair(0, s);
+        // entries forced before the first decision depend on no decision
+        // (at[r] starts with a cell of r for all values: valid if that cell holds it)
+        for (int r = 0; r < num_regions; ++r) gr.at[r].fill(tables.region_cells[r][0]);
+        for (int cnt = 0; cnt < total_size; ++cnt) {
+            if (gr.g.val[cnt] == 0) continue;
+            gr.stamp[cnt] = 0;
+            gr.cause[cnt] = given;
+            for (int r : regions_of[cnt]) gr.at[r][gr.g.val[cnt] - 1] = cnt;
+        }
+        if (!search(gr, 0, conflict)) {
+            return make_pair(0, s);    // return sudoku unchanged
+        }
+        Sudoku s_solved(s);
+        Fixed::store(gr.g, s_solved);
+        return make_pair(num_empty_before, s_solved);
+    }
+
+  private:
+    static constexpr mask_t bit(int v) {
+        return static_cast<mask_t>(mask_t{1} << (v - 1));
+    }
+
+    // depth first search on first empty cell (returns true if solved); if not, conflict
+    // holds the decision levels (<= depth) responsible for the failure
+    bool search(Grid& gr, int depth, Levels& conflict) {
+        if (gr.g.num_empty == 0) return true;
+        if (m_opt.cancel != nullptr && m_opt.cancel->load(memory_order_relaxed)) {
+            return false;
+        }
+        ++m_stats.nodes;
+
+        int cnt = 0;
+        while (gr.g.val[cnt] != 0) ++cnt;
+        const int lvl = depth + 1;
+
+        Levels cs;    // levels responsible for the failure of the values tried
+        for (mask_t m = gr.g.cand[cnt]; m != 0; m &= m - 1) {
+            const int v     = countr_zero(m) + 1;
+            m_path[lvl - 1] = {cnt, v};
+
+            if (m_opt.nogoods && violates_nogood(gr, cnt, v, cs)) {
+                ++m_stats.nogood_prunes;
+                continue;
+            }
+
+            Grid g_try = gr;
+            Levels child;
+            if (decide(g_try, cnt, v, lvl, child) && propagate(g_try, child) &&
+                search(g_try, lvl, child)) {
+                gr = std::move(g_try);
+                return true;
+            }
+            if (m_opt.cancel != nullptr && m_opt.cancel->load(memory_order_relaxed)) {
+                return false;
+            }
+            if (!child.contains(lvl)) {
+                // failed without regard to this decision: its other values fail the same
+                // way, go back further
+                ++m_stats.levels_skipped;
+                conflict = child;
+                return false;
+            }
+            child.erase(lvl);
+            cs.merge(child);
+        }
+
+        // values no longer candidates of cnt may come back, if a decision responsible
+        // for their removal is changed
+        new_analysis();
+        for (int v = 1; v <= region_size; ++v) {
+            if ((gr.g.cand[cnt] & bit(v)) == 0) mark(gr, removed_by(gr, cnt, v));
+        }
+        trace(gr, cs);
+
+        if (cs.max() < depth) ++m_stats.backjumps;    // skips the decision at depth
+        if (m_opt.nogoods) record_nogood(cs);
+        conflict = cs;
+        return false;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    // propagation (as in Sudoku_fixed<>), recording the cause of each entry
+    //////////////////////////////////////////////////////////////////////////////////////
+
+    bool decide(Grid& gr, int cnt, int v, int lvl, Levels& conflict) {
+        return assign(gr, cnt, v, static_cast<int16_t>(naked - lvl), conflict);
+    }
+
+    bool assign(Grid& gr, int cnt, int v, int16_t cause, Levels& conflict) {
+        array<cell_t, 2 * total_size> pending;
+        int num_pending = 0;
+
+        set_value(gr, cnt, v, cause, pending, num_pending);
+        while (num_pending > 0) {
+            int c = pending[--num_pending];
+            if (gr.g.val[c] != 0) continue;
+            if (gr.g.cand[c] == 0) {    // no candidate left in c
+                new_analysis();
+                for (int w = 1; w <= region_size; ++w) mark(gr, removed_by(gr, c, w));
+                trace(gr, conflict);
+                return false;
+            }
+            set_value(gr, c, countr_zero(gr.g.cand[c]) + 1, naked, pending, num_pending);
+        }
+        return true;
+    }
+
+    bool propagate(Grid& gr, Levels& conflict) {
+        auto& g      = gr.g;
+        bool changed = true;
+        while (changed && g.num_empty > 0) {
+            changed = false;
+            for (int r = 0; r < num_regions; ++r) {
+                mask_t once   = 0;
+                mask_t twice  = 0;
+                mask_t placed = 0;
+                for (auto c : tables.region_cells[r]) {
+                    if (g.val[c] != 0) {
+                        placed |= bit(g.val[c]);
+                    } else {
+                        twice |= once & g.cand[c];
+                        once |= g.cand[c];
+                    }
+                }
+                if ((once | placed) != all_mask) {    // value can't be set
+                    explain_region(gr, r, -1, all_mask & ~(once | placed), conflict);
+                    return false;
+                }
+
+                mask_t exactly_once = once & static_cast<mask_t>(~twice);
+                if (exactly_once == 0) continue;
+                for (auto c : tables.region_cells[r]) {
+                    if (g.val[c] != 0) continue;
+                    mask_t hit = g.cand[c] & exactly_once;
+                    if (hit == 0) continue;
+                    if (popcount(hit) > 1) {    // two values, one cell
+                        explain_region(gr, r, c, hit, conflict);
+                        return false;
+                    }
+                    if (!assign(gr, c, countr_zero(hit) + 1, static_cast<int16_t>(r),
+                                conflict)) {
+                        return false;
+                    }
+                    changed = true;
+                }
+            }
+        }
+        return true;
+    }
+
+    static void set_value(Grid& gr, int cnt, int v, int16_t cause,
+                          array<cell_t, 2 * total_size>& pending, int& num_pending) {
+        auto& g        = gr.g;
+        const mask_t b = bit(v);
+        g.val[cnt]     = v;
+        g.cand[cnt]    = 0;
+        --g.num_empty;
+        gr.stamp[cnt] = static_cast<uint16_t>(++gr.num_stamps);
+        gr.cause[cnt] = cause;
+        for (int r : regions_of[cnt]) gr.at[r][v - 1] = static_cast<cell_t>(cnt);
+        for (auto p : tables.peers[cnt]) {
+            if ((g.cand[p] & b) == 0) continue;
+            g.cand[p] &= static_cast<mask_t>(~b);
+            if (g.val[p] == 0 && popcount(g.cand[p]) <= 1) pending[num_pending++] = p;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    // explanations: decision levels an entry or a contradiction depends on
+    //////////////////////////////////////////////////////////////////////////////////////
+
+    // peer of cnt whose entry v removed v from the candidates of cnt, entered before
+    // stamp (-1: removed without a decision involved, or v not removed)
+    static int removed_by(const Grid& gr, int cnt, int v,
+                          int stamp = numeric_limits<int>::max()) {
+        int best = -1;
+        for (int r : regions_of[cnt]) {
+            const int p = gr.at[r][v - 1];
+            if (p == cnt || gr.g.val[p] != v || gr.stamp[p] >= stamp) continue;
+            if (gr.stamp[p] == 0) return -1;    // given
+            if (best < 0 || gr.stamp[p] < gr.stamp[best]) best = p;
+        }
+        return best;
+    }
+
+    // why none of the other empty cells of region r (except cell skip) can take the
+    // values of mask: entered before or lost them as candidates
+    void explain_region(const Grid& gr, int r, int skip, mask_t mask, Levels& conflict) {
+        new_analysis();
+        for (auto d : tables.region_cells[r]) {
+            if (d == skip) continue;
+            if (gr.g.val[d] != 0) {
+                mark(gr, d);
+                continue;
+            }
+            for (mask_t m = mask; m != 0; m &= m - 1) {
+                mark(gr, removed_by(gr, d, countr_zero(m) + 1));
+            }
+        }
+        trace(gr, conflict);
+    }
+
+    // start explaining a new contradiction: mark() the entries it follows from, then
+    // trace() them back to the decisions
+    void new_analysis() {
+        if (++m_visit_epoch == 0) {    // wrapped around: forget all marks
+            m_visited.fill(0);
+            m_visit_epoch = 1;
+        }
+        m_num_todo = 0;
+    }
+
+    // entry of cnt to be traced (cnt < 0: nothing to trace)
+    void mark(const Grid& gr, int cnt) {
+        if (cnt < 0 || gr.cause[cnt] == given || m_visited[cnt] == m_visit_epoch) return;
+        m_visited[cnt]       = m_visit_epoch;
+        m_todo[m_num_todo++] = static_cast<cell_t>(cnt);
+    }
+
+    // add the decisions the marked entries depend on to levels
+    void trace(const Grid& gr, Levels& levels) {
+        while (m_num_todo > 0) {
+            const int c = m_todo[--m_num_todo];
+            const int16_t cause = gr.cause[c];
+            const int stamp     = gr.stamp[c];
+            const int v         = gr.g.val[c];
+
+            if (cause < naked) {
+                levels.insert(naked - cause);    // decision
+            }
+            else if (cause == naked) {    // all other values removed from c before
+                for (int w = 1; w <= region_size; ++w) {
+                    if (w != v) mark(gr, removed_by(gr, c, w, stamp));
+                }
+            }
+            else {    // hidden single: no other cell of the region could take v
+                for (auto d : tables.region_cells[cause]) {
+                    if (d == c) continue;
+                    if (gr.g.val[d] != 0 && gr.stamp[d] < stamp) {
+                        mark(gr, d);
+                    }
+                    else {
+                        mark(gr, removed_by(gr, d, v, stamp));
+                    }
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////
+    // nogoods: decisions known to fail together, indexed by their latest assignment
+    //////////////////////////////////////////////////////////////////////////////////////
+
+    void record_nogood(const Levels& cs) {
+        const int size = cs.size();
+        if (size == 0 || size > m_opt.nogood_max_size ||
+            m_num_nogoods >= m_opt.nogood_max_count) {
+            return;
+        }
+        const int h        = cs.max();
+        const Assignment a = m_path[h - 1];
+        m_nogood_index[a.cnt * region_size + a.v - 1].push_back(
+            static_cast<int>(m_nogood_data.size()));
+        m_nogood_data.push_back(size - 1);    // no. of other assignments
+        cs.for_each([&](int l) {
+            if (l == h) return;
+            m_nogood_data.push_back(m_path[l - 1].cnt);
+            m_nogood_data.push_back(m_path[l - 1].v);
+        });
+        ++m_num_nogoods;
+        ++m_stats.nogoods_recorded;
+    }
+
+    // entering v in cnt completes a recorded nogood (the levels of its other entries
+    // are added to conflict)
+    bool violates_nogood(const Grid& gr, int cnt, int v, Levels& conflict) {
+        for (int offs : m_nogood_index[cnt * region_size + v - 1]) {
+            const int len    = m_nogood_data[offs];
+            const int* assig = &m_nogood_data[offs + 1];
+            bool match       = true;
+            for (int k = 0; match && k < len; ++k) {
+                match = (gr.g.val[assig[2 * k]] == assig[2 * k + 1]);
+            }
+            if (match) {
+                new_analysis();
+                for (int k = 0; k < len; ++k) mark(gr, assig[2 * k]);
+                trace(gr, conflict);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const Sudoku_search_options& m_opt;
+    Sudoku_search_stats& m_stats;
+
+    vector<Assignment> m_path;    // [l-1]: decision of level l on the current path
+
+    vector<vector<int>> m_nogood_index;    // offsets into m_nogood_data
+    vector<int> m_nogood_data;             // size, then pairs (cell, value)
+    int m_num_nogoods{0};
+
+    array<uint32_t, total_size> m_visited{};    // cells marked (== m_visit_epoch)
+    uint32_t m_visit_epoch{0};
+    array<cell_t, total_size> m_todo;    // marked, not traced yet (each cell once)
+    int m_num_todo{0};
+};
+
+template <int t_region_size, int t_blocks_per_row, int t_blocks_per_col>
+static pair<int, Sudoku> remove_recursive_cbj(const Sudoku& s,
+                                              const Sudoku_search_options& opt,
+                                              Sudoku_search_stats& stats) {
+    Cbj_fixed<t_region_size, t_blocks_per_row, t_blocks_per_col> cbj(opt, stats);
+    return cbj.remove_recursive(s);
+}
+
+std::pair<int, Sudoku> sudoku_remove_recursive_cbj(Sudoku s,
+                                                   const Sudoku_search_options& opt,
+                                                   Sudoku_search_stats& stats) {
+
+    // pre-conditions: sudoku is valid and still has empty cells
+    if (!sudoku_is_valid(s) || sudoku_num_empty(s) == 0) {
+        return std::make_pair(0, s);    // return sudoku unchanged
+    }
+
+    // shapes of sudoku_remove_recursive_fixed() (up to sudoku_max_region_size)
+    if (s.region_size == 9 && s.blocks_per_row == 3 && s.blocks_per_col == 3) {
+        return remove_recursive_cbj<9, 3, 3>(s, opt, stats);
+    }
+    if (s.region_size == 4 && s.blocks_per_row == 2 && s.blocks_per_col == 2) {
+        return remove_recursive_cbj<4, 2, 2>(s, opt, stats);
+    }
+    if (s.region_size == 6 && s.blocks_per_row == 2 && s.blocks_per_col == 3) {
+        return remove_recursive_cbj<6, 2, 3>(s, opt, stats);
+    }
+    if (s.region_size == 6 && s.blocks_per_row == 3 && s.blocks_per_col == 2) {
+        return remove_recursive_cbj<6, 3, 2>(s, opt, stats);
+    }
+    if constexpr (sudoku_max_region_size >= 16) {
+        if (s.region_size == 16 && s.blocks_per_row == 4 && s.blocks_per_col == 4) {
+            return remove_recursive_cbj<16, 4, 4>(s, opt, stats);
+        }
+    }
+    if constexpr (sudoku_max_region_size >= 25) {
+        if (s.region_size == 25 && s.blocks_per_row == 5 && s.blocks_per_col == 5) {
+            return remove_recursive_cbj<25, 5, 5>(s, opt, stats);
+        }
+    }
+
+    // other shapes: plain search
+    Sudoku_search_options plain = opt;
+    plain.backjumping           = false;
+    return sudoku_remove_recursive(std::move(s), plain, stats);
+}
@@ -0,0 +1,67 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_solve_fixed.h"
+
+using namespace std;
+
+optional<pair<int, Sudoku>> sudoku_remove_recursive_fixed(const Sudoku& s,
+                                                         const atomic<bool>* cancel,
+                                                         long* nodes) {
+
+    // select the specialization matching the shape of s
+    // (region_size, blocks_per_row, blocks_per_col; shapes above sudoku_max_region_size
+    // are not instantiated, a Sudoku cannot hold them)
+
+    if (s.region_size == 9 && s.blocks_per_row == 3 && s.blocks_per_col == 3) {
+        return Sudoku_fixed<9, 3, 3>::remove_recursive(s, cancel, nodes);
+    }
+    if (s.region_size == 4 && s.blocks_per_row == 2 && s.blocks_per_col == 2) {
+        return Sudoku_fixed<4, 2, 2>::remove_recursive(s, cancel, nodes);
+    }
+    if (s.region_size == 6 && s.blocks_per_row == 2 && s.blocks_per_col == 3) {
+        return Sudoku_fixed<6, 2, 3>::remove_recursive(s, cancel, nodes);
+    }
+    if (s.region_size == 6 && s.blocks_per_row == 3 && s.blocks_per_col == 2) {
+        return Sudoku_fixed<6, 3, 2>::remove_recursive(s, cancel, nodes);
+    }
+    if constexpr (sudoku_max_region_size >= 16) {
+        if (s.region_size == 16 && s.blocks_per_row == 4 && s.blocks_per_col == 4) {
+            return Sudoku_fixed<16, 4, 4>::remove_recursive(s, cancel, nodes);
+        }
+    }
+    if constexpr (sudoku_max_region_size >= 25) {
+        if (s.region_size == 25 && s.blocks_per_row == 5 && s.blocks_per_col == 5) {
+            return Sudoku_fixed<25, 5, 5>::remove_recursive(s, cancel, nodes);
+        }
+    }
+
+    return nullopt;    // no specialization available: use generic solver
+}
+
+optional<int> sudoku_count_solutions_fixed(const Sudoku& s, int limit) {
+
+    if (s.region_size == 9 && s.blocks_per_row == 3 && s.blocks_per_col == 3) {
+        return Sudoku_fixed<9, 3, 3>::count_solutions(s, limit);
+    }
+    if (s.region_size == 4 && s.blocks_per_row == 2 && s.blocks_per_col == 2) {
+        return Sudoku_fixed<4, 2, 2>::count_solutions(s, limit);
+    }
+    if (s.region_size == 6 && s.blocks_per_row == 2 && s.blocks_per_col == 3) {
+        return Sudoku_fixed<6, 2, 3>::count_solutions(s, limit);
+    }
+    if (s.region_size == 6 && s.blocks_per_row == 3 && s.blocks_per_col == 2) {
+        return Sudoku_fixed<6, 3, 2>::count_solutions(s, limit);
+    }
+    if constexpr (sudoku_max_region_size >= 16) {
+        if (s.region_size == 16 && s.blocks_per_row == 4 && s.blocks_per_col == 4) {
+            return Sudoku_fixed<16, 4, 4>::count_solutions(s, limit);
+        }
+    }
+    if constexpr (sudoku_max_region_size >= 25) {
+        if (s.region_size == 25 && s.blocks_per_row == 5 && s.blocks_per_col == 5) {
+            return Sudoku_fixed<25, 5, 5>::count_solutions(s, limit);
+        }
+    }
+
+    return nullopt;    // no specialization available: use generic counter
+}
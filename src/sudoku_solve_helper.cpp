@@ -183,3 +183,57 @@ bool pairwise_different_if_size2(const set<int>& a, const set<int>& b, const set
 
     return true;
 }
+
+// candidate sets are equal if their masks are equal
+static bool equal_if_size2(const Sudoku_candidates& a, const Sudoku_candidates& b) {
+    return a.size() == 2 && a == b;
+}
+
+bool pairwise_different_if_size2(const Sudoku_candidates& a, const Sudoku_candidates& b,
+                                 const Sudoku_candidates& c) {
+
+    // pairwise different only required for sets with 2 entries
+    if (a.size() < 2) return false;
+    if (b.size() < 2) return false;
+    if (c.size() < 2) return false;
+    if (equal_if_size2(a, b) || equal_if_size2(a, c) || equal_if_size2(b, c)) return false;
+
+    return true;
+}
+
+bool pairwise_different_if_size2(const Sudoku_candidates& a, const Sudoku_candidates& b,
+                                 const Sudoku_candidates& c, const Sudoku_candidates& d) {
+
+    // pairwise different only required for sets with 2 entries
+    if (equal_if_size2(a, b) || equal_if_size2(a, c) || equal_if_size2(a, d)) return false;
+    if (equal_if_size2(b, c) || equal_if_size2(b, d) || equal_if_size2(c, d)) return false;
+
+    return true;
+}
+
+long sudoku_luby(long i) {
+
+    // find the finite subsequence containing i and its size: 2^(seq+1) - 1
+    long size = 1;
+    int seq   = 0;
+    while (size < i + 1) {
+        ++seq;
+        size = 2 * size + 1;
+    }
+    // descend into the (repeated) first half, until i is the last element
+    while (size - 1 != i) {
+        size = (size - 1) >> 1;
+        --seq;
+        i = i % size;
+    }
+    return 1L << seq;
+}
+
+std::uint64_t sudoku_mix64(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
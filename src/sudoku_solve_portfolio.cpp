@@ -0,0 +1,107 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_solve_portfolio.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+using namespace std;
+
+std::vector<Sudoku_portfolio_entry> sudoku_default_portfolio() {
+
+    vector<Sudoku_portfolio_entry> entries;
+
+    entries.push_back({"logic", Sudoku_engine_t::logic, {}});
+    entries.push_back({"recursive", Sudoku_engine_t::recursive, {}});
+
+    Sudoku_search_options probing;
+    probing.probing = true;
+    entries.push_back({"mixed+probing", Sudoku_engine_t::mixed, probing});
+
+    entries.push_back({"sat", Sudoku_engine_t::sat, {}});
+
+    return entries;
+}
+
+std::pair<int, Sudoku>
+sudoku_remove_portfolio(const Sudoku& s,
+                        const std::vector<Sudoku_portfolio_entry>& entries,
+                        Sudoku_portfolio_stats& stats,
+                        const std::atomic<bool>* outer_cancel) {
+
+    ++stats.solves;
+    const int n = static_cast<int>(entries.size());
+    if (static_cast<int>(stats.wins.size()) < n) stats.wins.resize(n, 0);
+    if (n == 0) return std::make_pair(0, s);    // nothing to run: return unchanged
+
+    atomic<bool> cancel{false};
+    mutex result_mutex;
+    condition_variable finished_cv;    // an entry finished (outer cancel only)
+    int finished = 0;
+    optional<pair<int, Sudoku>> result;      // definite result of the winner
+    optional<pair<int, Sudoku>> fallback;    // result of the entry finishing first
+    int winner = -1;
+
+    auto run = [&](int i) {
+        Sudoku_search_options opt = entries[i].opt;
+        opt.cancel                = &cancel;
+        Sudoku_search_stats search_stats;
+        auto res = sudoku_remove_engine(s, entries[i].engine, opt, search_stats);
+
+        // the logic engine is not complete: only a solved sudoku is definite (it may
+        // also fill all cells of an unsolvable one, breaking the rules)
+        const bool definite =
+            entries[i].engine != Sudoku_engine_t::logic ||
+            (sudoku_num_empty(res.second) == 0 && sudoku_is_valid(res.second));
+
+        lock_guard<mutex> lock(result_mutex);
+        ++finished;
+        finished_cv.notify_one();
+        if (outer_cancel != nullptr && outer_cancel->load()) cancel.store(true);
+        if (cancel.load()) return;    // lost the race (result may be incomplete)
+        if (definite) {
+            result = std::move(res);
+            winner = i;
+            cancel.store(true);
+        }
+        else if (!fallback) {
+            fallback = std::move(res);
+        }
+    };
+
+    vector<thread> threads;
+    if (outer_cancel == nullptr) {
+        threads.reserve(n - 1);
+        for (int i = 1; i < n; ++i) threads.emplace_back(run, i);
+        run(0);
+    }
+    else {
+        // all entries on threads: the calling thread passes an outer cancel on
+        threads.reserve(n);
+        for (int i = 0; i < n; ++i) threads.emplace_back(run, i);
+        unique_lock<mutex> lock(result_mutex);
+        while (finished < n && !cancel.load()) {
+            if (outer_cancel->load(memory_order_relaxed)) {
+                cancel.store(true);
+                break;
+            }
+            finished_cv.wait_for(lock, chrono::milliseconds(1));
+        }
+    }
+    for (auto& t : threads) t.join();
+
+    if (winner < 0 && outer_cancel != nullptr && outer_cancel->load()) {
+        ++stats.undecided;    // cancelled: results may be incomplete
+        return std::make_pair(0, s);
+    }
+    if (winner < 0) {
+        ++stats.undecided;
+        return fallback ? *fallback : std::make_pair(0, s);
+    }
+    ++stats.wins[winner];
+    return *result;
+}
@@ -0,0 +1,238 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_solve_probe.h"
+
+#include <algorithm>    // copy()
+#include <bit>          // countr_zero()
+#include <cstdint>
+#include <span>
+#include <utility>    // pair
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// trail based propagation on the state arrays of a Sudoku
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+// Every cell is saved on the trail before it is modified. undo(mark) restores all cells
+// saved after mark in reverse order; committing a state means forgetting the trail.
+//
+// The propagation is sound as long as the candidates are a superset of the real
+// candidates, i.e. conclusions never remove a solution.
+//
+class Sudoku_probe_state {
+
+  public:
+    Sudoku_probe_state(Sudoku& t_s)
+        : m_val(t_s.values()), m_cand(t_s.candidates()), m_idx(t_s.index_table()),
+          m_all(Sudoku_candidates::bit(t_s.region_size + 1) - 1) {}
+
+    int trail_size() const { return static_cast<int>(m_trail.size()); }
+
+    void commit() { m_trail.clear(); }
+
+    void undo(int mark) {
+        while (trail_size() > mark) {
+            const Trail_entry& e = m_trail.back();
+            m_val[e.cnt]         = e.val;
+            m_cand[e.cnt]        = Sudoku_candidates(e.cand);
+            m_trail.pop_back();
+        }
+        m_pending.clear();
+    }
+
+    // enter v in cell cnt and propagate naked and hidden singles
+    // (returns false on contradiction; the state must be undone then)
+    bool assign_and_propagate(int cnt, int v) {
+        m_pending.clear();
+        if (!assign(cnt, v)) return false;
+        return propagate();
+    }
+
+    const uint8_t* values() const { return m_val; }
+
+  private:
+    struct Trail_entry {
+        int cnt;
+        uint8_t val;
+        cand_mask_t cand;
+    };
+
+    uint8_t* const m_val;
+    Sudoku_candidates* const m_cand;
+    const Sudoku_index_table& m_idx;
+    const cand_mask_t m_all;    // all values possible in a region
+
+    vector<Trail_entry> m_trail;
+    vector<int> m_pending;    // cells that became naked singles
+
+    void save(int cnt) { m_trail.push_back({cnt, m_val[cnt], m_cand[cnt].mask()}); }
+
+    span<const int> region_cells(int region, int i) const {
+        const int rs = m_idx.region_size;
+        return span<const int>(m_idx.region_cnt.data() + (region * rs + i) * rs, rs);
+    }
+
+    // enter v in cell cnt and remove it from the candidates of all peers
+    bool assign(int cnt, int v) {
+        if (m_val[cnt] != 0) return m_val[cnt] == v;
+        if (!m_cand[cnt].contains(v)) return false;
+
+        save(cnt);
+        m_val[cnt] = v;
+        m_cand[cnt].clear();
+
+        for (int region = 0; region < 3; ++region) {
+            const int i = m_idx.cnt_region[region * m_idx.total_size + cnt];
+            for (int c : region_cells(region, i)) {
+                if (c == cnt) continue;
+                if (m_val[c] == v) return false;    // value entered twice
+                if (m_val[c] != 0 || !m_cand[c].contains(v)) continue;
+                save(c);
+                m_cand[c].erase(v);
+                if (m_cand[c].empty()) return false;
+                if (m_cand[c].size() == 1) m_pending.push_back(c);
+            }
+        }
+        return true;
+    }
+
+    bool propagate() {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+
+            // naked singles
+            while (!m_pending.empty()) {
+                const int c = m_pending.back();
+                m_pending.pop_back();
+                if (m_val[c] != 0) continue;
+                if (!assign(c, *m_cand[c].begin())) return false;
+            }
+
+            // hidden singles
+            for (int region = 0; region < 3; ++region) {
+                for (int i = 0; i < m_idx.region_size; ++i) {
+                    cand_mask_t once = 0, twice = 0, placed = 0;
+                    auto rc = region_cells(region, i);
+                    for (int c : rc) {
+                        if (m_val[c] != 0) {
+                            placed |= Sudoku_candidates::bit(m_val[c]);
+                        }
+                        else {
+                            const cand_mask_t m = m_cand[c].mask();
+                            twice |= once & m;
+                            once |= m;
+                        }
+                    }
+                    // value neither entered nor possible in region
+                    if ((placed | once) != m_all) return false;
+
+                    cand_mask_t hidden = once & ~twice & ~placed;
+                    while (hidden != 0) {
+                        const int v = countr_zero(hidden) + 1;
+                        hidden &= hidden - 1;
+                        for (int c : rc) {
+                            if (m_val[c] == 0 && m_cand[c].contains(v)) {
+                                if (!assign(c, v)) return false;
+                                changed = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+            if (!m_pending.empty()) changed = true;
+        }
+        return true;
+    }
+};
+
+// probing passes (values are entered directly into the arrays of s)
+static int probe_run(Sudoku& s, const Sudoku_search_options& opt,
+                     Sudoku_search_stats& stats) {
+
+    Sudoku_probe_state ps(s);
+    const uint8_t* val = ps.values();
+    const int n        = s.total_size;
+
+    vector<uint8_t> val_a(n);    // values entered by the probe of the first candidate
+    vector<pair<int, int>> agreed;
+
+    auto num_empty = [&]() {
+        int res = 0;
+        for (int c = 0; c < n; ++c) {
+            if (val[c] == 0) ++res;
+        }
+        return res;
+    };
+    const int num_empty_before = num_empty();
+    int num_empty_round        = num_empty_before;
+
+    for (int round = 0; round < opt.probing_max_rounds; ++round) {
+
+        for (int cnt = 0; cnt < n; ++cnt) {
+
+            if (val[cnt] != 0 || s(cnt).cand.size() != 2) continue;
+
+            auto it     = s(cnt).cand.begin();
+            const int a = *it;
+            const int b = *++it;
+
+            ++stats.probes;
+            const bool ok_a = ps.assign_and_propagate(cnt, a);
+            if (ok_a) copy(val, val + n, val_a.begin());
+            ps.undo(0);
+
+            ++stats.probes;
+            const bool ok_b = ps.assign_and_propagate(cnt, b);
+
+            if (!ok_a && !ok_b) return -1;
+
+            if (!ok_a) {
+                // keep state of probe b
+                ++stats.probe_failures;
+            }
+            else if (!ok_b) {
+                // redo probe a (succeeded before, so it succeeds again)
+                ps.undo(0);
+                ps.assign_and_propagate(cnt, a);
+                ++stats.probe_failures;
+            }
+            else {
+                // enter the values both probes agree on
+                agreed.clear();
+                for (int c = 0; c < n; ++c) {
+                    if (c != cnt && val_a[c] != 0 && val_a[c] == val[c]) {
+                        agreed.emplace_back(c, val[c]);
+                    }
+                }
+                ps.undo(0);
+                for (auto const& [c, v] : agreed) {
+                    if (val[c] != 0) {
+                        if (val[c] != v) return -1;
+                        continue;
+                    }
+                    ++stats.probe_agreements;
+                    if (!ps.assign_and_propagate(c, v)) return -1;
+                }
+            }
+            ps.commit();
+        }
+
+        const int num_empty_after = num_empty();
+        if (num_empty_after == num_empty_round) break;    // nothing learned
+        num_empty_round = num_empty_after;
+    }
+
+    return num_empty_before - num_empty_round;
+}
+
+int sudoku_probe_bivalue_cells(Sudoku& s, const Sudoku_search_options& opt,
+                               Sudoku_search_stats& stats) {
+
+    const int res = probe_run(s, opt, stats);
+    s.rehash();    // values were entered bypassing Sudoku::set_value()
+    return res;
+}
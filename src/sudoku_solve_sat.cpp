@@ -0,0 +1,610 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_solve_sat.h"
+#include "sudoku_solve.h"
+#include "sudoku_solve_helper.h"
+
+#include <algorithm>    // sort(), swap()
+#include <atomic>
+#include <bit>          // countr_zero()
+#include <cstdint>
+#include <iterator>    // ssize()
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// literals: 2*var for x(var), 2*var + 1 for not x(var)
+//////////////////////////////////////////////////////////////////////////////////////////
+
+using lit_t = int;
+
+static constexpr lit_t lit_make(int var, bool neg) { return 2 * var + (neg ? 1 : 0); }
+static constexpr int lit_var(lit_t l) { return l >> 1; }
+static constexpr bool lit_neg(lit_t l) { return (l & 1) != 0; }
+static constexpr lit_t lit_not(lit_t l) { return l ^ 1; }
+
+// truth values
+static constexpr int8_t l_true  = 1;
+static constexpr int8_t l_false = -1;
+static constexpr int8_t l_undef = 0;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// max-heap of variables ordered by activity (VSIDS order)
+//////////////////////////////////////////////////////////////////////////////////////////
+class Sat_var_heap {
+
+  public:
+    Sat_var_heap(const vector<double>& t_activity) : m_act(t_activity) {}
+
+    bool empty() const { return m_heap.empty(); }
+    bool contains(int v) const { return v < ssize(m_pos) && m_pos[v] >= 0; }
+
+    void insert(int v) {
+        if (v >= ssize(m_pos)) m_pos.resize(v + 1, -1);
+        if (contains(v)) return;
+        m_pos[v] = static_cast<int>(m_heap.size());
+        m_heap.push_back(v);
+        up(m_pos[v]);
+    }
+
+    // activity of v was increased
+    void increased(int v) {
+        if (contains(v)) up(m_pos[v]);
+    }
+
+    int remove_max() {
+        const int v = m_heap.front();
+        m_heap.front()        = m_heap.back();
+        m_pos[m_heap.front()] = 0;
+        m_pos[v]              = -1;
+        m_heap.pop_back();
+        if (m_heap.size() > 1) down(0);
+        return v;
+    }
+
+  private:
+    const vector<double>& m_act;
+    vector<int> m_heap;
+    vector<int> m_pos;    // position of var in m_heap (-1: not contained)
+
+    void up(int i) {
+        const int v = m_heap[i];
+        while (i > 0) {
+            const int p = (i - 1) / 2;
+            if (m_act[m_heap[p]] >= m_act[v]) break;
+            m_heap[i]        = m_heap[p];
+            m_pos[m_heap[i]] = i;
+            i                = p;
+        }
+        m_heap[i] = v;
+        m_pos[v]  = i;
+    }
+
+    void down(int i) {
+        const int v = m_heap[i];
+        const int n = static_cast<int>(m_heap.size());
+        while (2 * i + 1 < n) {
+            int c = 2 * i + 1;
+            if (c + 1 < n && m_act[m_heap[c + 1]] > m_act[m_heap[c]]) ++c;
+            if (m_act[m_heap[c]] <= m_act[v]) break;
+            m_heap[i]        = m_heap[c];
+            m_pos[m_heap[i]] = i;
+            i                = c;
+        }
+        m_heap[i] = v;
+        m_pos[v]  = i;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// CDCL solver
+//////////////////////////////////////////////////////////////////////////////////////////
+class Sat_solver {
+
+  public:
+    Sat_solver(Sudoku_sat_stats& t_stats, const atomic<bool>* t_cancel)
+        : m_stats(t_stats), m_cancel(t_cancel), m_order(m_activity) {}
+
+    int new_var() {
+        const int v = static_cast<int>(m_assigns.size());
+        m_assigns.push_back(l_undef);
+        m_level.push_back(0);
+        m_reason.push_back(-1);
+        m_polarity.push_back(true);    // first try: false (most variables are)
+        m_seen.push_back(0);
+        m_activity.push_back(0.0);
+        m_watches.emplace_back();
+        m_watches.emplace_back();
+        m_order.insert(v);
+        ++m_stats.vars;
+        return v;
+    }
+
+    // add clause at decision level 0 (returns false, if the problem became unsat)
+    bool add_clause(vector<lit_t> lits) {
+        if (!m_ok) return false;
+
+        sort(lits.begin(), lits.end());
+        vector<lit_t> c;
+        for (size_t i = 0; i < lits.size(); ++i) {
+            const lit_t l = lits[i];
+            if (value(l) == l_true) return true;                    // satisfied
+            if (i > 0 && l == lit_not(lits[i - 1])) return true;    // tautology
+            if (value(l) == l_false || (i > 0 && l == lits[i - 1])) continue;
+            c.push_back(l);
+        }
+        ++m_stats.clauses;
+
+        if (c.empty()) return m_ok = false;
+        if (c.size() == 1) {
+            enqueue(c[0], -1);
+            return m_ok = (propagate() < 0);
+        }
+        attach(new_clause(std::move(c), false));
+        return true;
+    }
+
+    // returns true if satisfiable (model available by value_of_var()), false if unsat
+    // or cancelled
+    bool solve() {
+        if (!m_ok) return false;
+
+        m_max_learnts = max(1000.0, m_num_original / 3.0);
+        for (long restart = 0;; ++restart) {
+            const long budget = sudoku_luby(restart) * restart_first;
+            const int8_t res  = search(budget);
+            if (res != l_undef) return res == l_true;
+            if (cancelled()) return false;
+            ++m_stats.restarts;
+        }
+    }
+
+    bool value_of_var(int v) const { return m_assigns[v] == l_true; }
+
+  private:
+    struct Clause {
+        vector<lit_t> lits;    // lits[0] is the implied literal, if used as reason
+        double activity{0.0};
+        bool learnt{false};
+        bool deleted{false};
+    };
+
+    struct Watcher {
+        int cref;         // watching clause
+        lit_t blocker;    // other literal of the clause (if true, clause is satisfied)
+    };
+
+    static constexpr int restart_first   = 100;    // conflicts of first restart interval
+    static constexpr double var_decay    = 0.95;
+    static constexpr double clause_decay = 0.999;
+    static constexpr double learnts_grow = 1.1;    // growth of learned clause limit
+
+    Sudoku_sat_stats& m_stats;
+    const atomic<bool>* m_cancel;    // stop searching when set (nullptr: never)
+    bool m_ok{true};
+
+    vector<Clause> m_clauses;
+    long m_num_original{0};
+    long m_num_learnts{0};
+    double m_max_learnts{0.0};
+
+    vector<vector<Watcher>> m_watches;    // [lit]: clauses watching not lit
+
+    vector<int8_t> m_assigns;
+    vector<int> m_level;
+    vector<int> m_reason;    // clause implying the assignment (-1: decision or unit)
+    vector<bool> m_polarity;    // saved phase (true: negative)
+    vector<char> m_seen;
+
+    vector<lit_t> m_trail;
+    vector<int> m_trail_lim;    // start of each decision level in m_trail
+    size_t m_qhead{0};
+
+    vector<double> m_activity;
+    double m_var_inc{1.0};
+    double m_cla_inc{1.0};
+    Sat_var_heap m_order;
+
+    int8_t value(lit_t l) const {
+        const int8_t a = m_assigns[lit_var(l)];
+        return lit_neg(l) ? static_cast<int8_t>(-a) : a;
+    }
+
+    int decision_level() const { return static_cast<int>(m_trail_lim.size()); }
+
+    bool cancelled() const {
+        return m_cancel != nullptr && m_cancel->load(memory_order_relaxed);
+    }
+
+    int new_clause(vector<lit_t> lits, bool learnt) {
+        m_clauses.push_back(Clause{std::move(lits), 0.0, learnt, false});
+        if (learnt)
+            ++m_num_learnts;
+        else
+            ++m_num_original;
+        return static_cast<int>(m_clauses.size()) - 1;
+    }
+
+    void attach(int cref) {
+        const auto& c = m_clauses[cref].lits;
+        m_watches[lit_not(c[0])].push_back({cref, c[1]});
+        m_watches[lit_not(c[1])].push_back({cref, c[0]});
+    }
+
+    void enqueue(lit_t l, int reason) {
+        const int v  = lit_var(l);
+        m_assigns[v] = lit_neg(l) ? l_false : l_true;
+        m_level[v]   = decision_level();
+        m_reason[v]  = reason;
+        m_trail.push_back(l);
+    }
+
+    // unit propagation; returns the conflicting clause or -1
+    int propagate() {
+        int confl = -1;
+        while (m_qhead < m_trail.size()) {
+            const lit_t p         = m_trail[m_qhead++];    // p became true
+            const lit_t false_lit = lit_not(p);
+            auto& ws              = m_watches[p];
+            ++m_stats.propagations;
+
+            size_t i = 0, j = 0;
+            while (i < ws.size()) {
+                const Watcher w = ws[i];
+                if (value(w.blocker) == l_true) {
+                    ws[j++] = ws[i++];
+                    continue;
+                }
+
+                auto& c = m_clauses[w.cref].lits;
+                if (c[0] == false_lit) swap(c[0], c[1]);
+                ++i;
+
+                const lit_t first = c[0];
+                const Watcher nw{w.cref, first};
+                if (first != w.blocker && value(first) == l_true) {
+                    ws[j++] = nw;
+                    continue;
+                }
+
+                // look for a new literal to watch
+                bool found = false;
+                for (size_t k = 2; k < c.size(); ++k) {
+                    if (value(c[k]) != l_false) {
+                        swap(c[1], c[k]);
+                        m_watches[lit_not(c[1])].push_back(nw);
+                        found = true;
+                        break;
+                    }
+                }
+                if (found) continue;
+
+                // clause is unit or conflicting
+                ws[j++] = nw;
+                if (value(first) == l_false) {
+                    confl   = w.cref;
+                    m_qhead = m_trail.size();
+                    while (i < ws.size()) ws[j++] = ws[i++];
+                }
+                else {
+                    enqueue(first, w.cref);
+                }
+            }
+            ws.resize(j);
+        }
+        return confl;
+    }
+
+    void bump_var(int v) {
+        if ((m_activity[v] += m_var_inc) > 1e100) {
+            for (auto& a : m_activity) a *= 1e-100;
+            m_var_inc *= 1e-100;
+        }
+        m_order.increased(v);
+    }
+
+    void bump_clause(Clause& c) {
+        if ((c.activity += m_cla_inc) > 1e20) {
+            for (auto& cl : m_clauses) {
+                if (cl.learnt) cl.activity *= 1e-20;
+            }
+            m_cla_inc *= 1e-20;
+        }
+    }
+
+    // first UIP conflict analysis; returns the backtrack level
+    int analyze(int confl, vector<lit_t>& learnt) {
+        learnt.assign(1, 0);    // placeholder for the asserting literal
+        int path_count = 0;
+        lit_t p        = -1;
+        int index      = static_cast<int>(m_trail.size()) - 1;
+
+        do {
+            Clause& c = m_clauses[confl];
+            if (c.learnt) bump_clause(c);
+            for (size_t j = (p == -1) ? 0 : 1; j < c.lits.size(); ++j) {
+                const lit_t q = c.lits[j];
+                const int v   = lit_var(q);
+                if (!m_seen[v] && m_level[v] > 0) {
+                    bump_var(v);
+                    m_seen[v] = 1;
+                    if (m_level[v] >= decision_level())
+                        ++path_count;
+                    else
+                        learnt.push_back(q);
+                }
+            }
+            while (!m_seen[lit_var(m_trail[index--])]) {}
+            p                  = m_trail[index + 1];
+            confl              = m_reason[lit_var(p)];
+            m_seen[lit_var(p)] = 0;
+            --path_count;
+        } while (path_count > 0);
+        learnt[0] = lit_not(p);
+
+        // minimization: drop literals implied by other literals of the clause
+        const vector<lit_t> to_clear(learnt.begin() + 1, learnt.end());
+        size_t j = 1;
+        for (size_t i = 1; i < learnt.size(); ++i) {
+            const int r = m_reason[lit_var(learnt[i])];
+            bool keep   = (r < 0);
+            if (!keep) {
+                const auto& rc = m_clauses[r].lits;
+                for (size_t k = 1; k < rc.size(); ++k) {
+                    const int v = lit_var(rc[k]);
+                    if (!m_seen[v] && m_level[v] > 0) {
+                        keep = true;
+                        break;
+                    }
+                }
+            }
+            if (keep) learnt[j++] = learnt[i];
+        }
+        learnt.resize(j);
+        for (lit_t l : to_clear) m_seen[lit_var(l)] = 0;
+
+        // backtrack level: highest level in the clause apart from the asserting literal
+        if (learnt.size() == 1) return 0;
+        size_t max_i = 1;
+        for (size_t i = 2; i < learnt.size(); ++i) {
+            if (m_level[lit_var(learnt[i])] > m_level[lit_var(learnt[max_i])]) max_i = i;
+        }
+        swap(learnt[1], learnt[max_i]);
+        return m_level[lit_var(learnt[1])];
+    }
+
+    void cancel_until(int lvl) {
+        if (decision_level() <= lvl) return;
+        for (int i = static_cast<int>(m_trail.size()) - 1; i >= m_trail_lim[lvl]; --i) {
+            const int v   = lit_var(m_trail[i]);
+            m_assigns[v]  = l_undef;
+            m_reason[v]   = -1;
+            m_polarity[v] = lit_neg(m_trail[i]);
+            m_order.insert(v);
+        }
+        m_trail.resize(m_trail_lim[lvl]);
+        m_qhead = m_trail.size();
+        m_trail_lim.resize(lvl);
+    }
+
+    lit_t pick_branch_lit() {
+        while (!m_order.empty()) {
+            const int v = m_order.remove_max();
+            if (m_assigns[v] == l_undef) return lit_make(v, m_polarity[v]);
+        }
+        return -1;    // all variables assigned
+    }
+
+    bool locked(int cref) const {
+        const lit_t l = m_clauses[cref].lits[0];
+        return m_reason[lit_var(l)] == cref && value(l) == l_true;
+    }
+
+    // remove the less active half of the learned clauses, then compact the clause
+    // database and rebuild the watches
+    void reduce_db() {
+        vector<int> learnts;
+        for (int cref = 0; cref < ssize(m_clauses); ++cref) {
+            if (m_clauses[cref].learnt) learnts.push_back(cref);
+        }
+        sort(learnts.begin(), learnts.end(), [this](int a, int b) {
+            return m_clauses[a].activity < m_clauses[b].activity;
+        });
+        for (size_t i = 0; i < learnts.size() / 2; ++i) {
+            Clause& c = m_clauses[learnts[i]];
+            if (c.lits.size() > 2 && !locked(learnts[i])) {
+                c.deleted = true;
+                --m_num_learnts;
+                ++m_stats.deleted;
+            }
+        }
+
+        vector<int> new_ref(m_clauses.size(), -1);
+        int n = 0;
+        for (int cref = 0; cref < ssize(m_clauses); ++cref) {
+            if (m_clauses[cref].deleted) continue;
+            new_ref[cref] = n;
+            if (n != cref) m_clauses[n] = std::move(m_clauses[cref]);
+            ++n;
+        }
+        m_clauses.resize(n);
+        for (lit_t l : m_trail) {
+            int& r = m_reason[lit_var(l)];
+            if (r >= 0) r = new_ref[r];
+        }
+        for (auto& ws : m_watches) ws.clear();
+        for (int cref = 0; cref < n; ++cref) attach(cref);
+
+        m_max_learnts *= learnts_grow;
+    }
+
+    // search until a model is found (l_true), unsat is proven (l_false) or the
+    // conflict budget is used up or the search is cancelled (l_undef)
+    int8_t search(long budget) {
+        long conflicts = 0;
+        vector<lit_t> learnt;
+
+        for (;;) {
+            const int confl = propagate();
+            if (confl >= 0) {
+                ++m_stats.conflicts;
+                ++conflicts;
+                if (decision_level() == 0) return l_false;
+
+                const int bt_level = analyze(confl, learnt);
+                cancel_until(bt_level);
+                if (learnt.size() == 1) {
+                    enqueue(learnt[0], -1);
+                }
+                else {
+                    const int cref = new_clause(learnt, true);
+                    attach(cref);
+                    bump_clause(m_clauses[cref]);
+                    enqueue(learnt[0], cref);
+                }
+                ++m_stats.learned;
+                m_var_inc /= var_decay;
+                m_cla_inc /= clause_decay;
+            }
+            else {
+                if (conflicts >= budget || cancelled()) {
+                    cancel_until(0);
+                    return l_undef;
+                }
+                if (m_num_learnts - static_cast<long>(m_trail.size()) >= m_max_learnts) {
+                    reduce_db();
+                }
+                const lit_t next = pick_branch_lit();
+                if (next < 0) return l_true;    // model found
+
+                ++m_stats.decisions;
+                m_trail_lim.push_back(static_cast<int>(m_trail.size()));
+                enqueue(next, -1);
+            }
+        }
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// encoding and solution
+//////////////////////////////////////////////////////////////////////////////////////////
+
+std::pair<int, Sudoku> sudoku_remove_sat(Sudoku s) {
+    Sudoku_sat_stats stats;
+    return sudoku_remove_sat(std::move(s), stats);
+}
+
+std::pair<int, Sudoku> sudoku_remove_sat(Sudoku s, Sudoku_sat_stats& stats,
+                                         const std::atomic<bool>* cancel) {
+
+    // pre-conditions: sudoku is valid and still has empty cells
+    const int num_empty_before = sudoku_num_empty(s);
+    if (!sudoku_is_valid(s) || num_empty_before == 0) {
+        return std::make_pair(0, s);    // return sudoku unchanged
+    }
+
+    const int rs = s.region_size;
+    const int n  = s.total_size;
+
+    // values entered in each region
+    vector<cand_mask_t> used(3 * rs, 0);
+    auto region_index = [&](int region, int cnt) {
+        return region * rs + s.cnt_to_region(static_cast<Region_t>(region), cnt).first;
+    };
+    for (int cnt = 0; cnt < n; ++cnt) {
+        if (s(cnt).val == 0) continue;
+        for (int region = 0; region < 3; ++region) {
+            used[region_index(region, cnt)] |= Sudoku_candidates::bit(s(cnt).val);
+        }
+    }
+
+    Sat_solver solver(stats, cancel);
+
+    // one variable per empty cell and possible value (-1: value not possible)
+    vector<int> var(n * rs, -1);
+    for (int cnt = 0; cnt < n; ++cnt) {
+        if (s(cnt).val != 0) continue;
+        cand_mask_t m = s(cnt).cand.mask();
+        for (int region = 0; region < 3; ++region) m &= ~used[region_index(region, cnt)];
+        if (m == 0) return std::make_pair(0, s);    // no value left for empty cell
+        while (m != 0) {
+            const int v = countr_zero(m);
+            m &= m - 1;
+            var[cnt * rs + v] = solver.new_var();
+        }
+    }
+
+    // exactly one of lits (at least one, pairwise at most one)
+    // (skip_pair(a, b): pair is excluded by another constraint already)
+    vector<lit_t> lits;
+    auto exactly_one = [&](const vector<int>& cells, auto&& skip_pair, auto&& var_of) {
+        lits.clear();
+        for (int c : cells) lits.push_back(lit_make(var_of(c), false));
+        bool ok = solver.add_clause(lits);
+        for (size_t i = 0; ok && i < cells.size(); ++i) {
+            for (size_t j = i + 1; ok && j < cells.size(); ++j) {
+                if (skip_pair(cells[i], cells[j])) continue;
+                ok = solver.add_clause(
+                    {lit_make(var_of(cells[i]), true), lit_make(var_of(cells[j]), true)});
+            }
+        }
+        return ok;
+    };
+
+    bool ok = true;
+    vector<int> group;
+
+    // each empty cell has exactly one value
+    for (int cnt = 0; ok && cnt < n; ++cnt) {
+        if (s(cnt).val != 0) continue;
+        group.clear();
+        for (int v = 0; v < rs; ++v) {
+            if (var[cnt * rs + v] >= 0) group.push_back(v);
+        }
+        ok = exactly_one(
+            group, [](int, int) { return false; },
+            [&](int v) { return var[cnt * rs + v]; });
+    }
+
+    // each missing value appears in exactly one cell of each region
+    // (pairs of cells sharing a row or column are already excluded by those regions)
+    for (int region = 0; ok && region < 3; ++region) {
+        const Region_t rt = static_cast<Region_t>(region);
+        for (int i = 0; ok && i < rs; ++i) {
+            const auto rc = s.region_cells(rt, i);
+            for (int v = 0; ok && v < rs; ++v) {
+                if (used[region * rs + i] & Sudoku_candidates::bit(v + 1)) continue;
+                group.clear();
+                for (int c : rc) {
+                    if (var[c * rs + v] >= 0) group.push_back(c);
+                }
+                ok = exactly_one(
+                    group,
+                    [&](int a, int b) {
+                        return rt == Region_t::block &&
+                               (s.cnt_to_row(a).first == s.cnt_to_row(b).first ||
+                                s.cnt_to_col(a).first == s.cnt_to_col(b).first);
+                    },
+                    [&](int c) { return var[c * rs + v]; });
+            }
+        }
+    }
+
+    // no solution (or cancelled)
+    if (!ok || !solver.solve()) return std::make_pair(0, s);
+
+    for (int cnt = 0; cnt < n; ++cnt) {
+        if (s(cnt).val != 0) continue;
+        for (int v = 0; v < rs; ++v) {
+            const int x = var[cnt * rs + v];
+            if (x >= 0 && solver.value_of_var(x)) {
+                s.set_value(cnt, v + 1);
+                break;
+            }
+        }
+    }
+    sudoku_update_candidates_all_cells(s);
+
+    return std::make_pair(num_empty_before, s);
+}
@@ -0,0 +1,102 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_solve_tt.h"
+#include "sudoku_solve_helper.h"    // sudoku_mix64()
+
+#include <bit>    // bit_floor()
+
+using namespace std;
+
+Sudoku_transposition_table::Sudoku_transposition_table(std::size_t t_max_bytes,
+                                                       Sudoku_tt_replace_t t_replace) :
+    m_replace(t_replace) {
+
+    // largest power of two no. of slots within the cap (at least one bucket of two)
+    const size_t num_slots = bit_floor(max<size_t>(t_max_bytes / sizeof(Entry), 2));
+    m_slots.resize(num_slots);
+    m_mask = (m_replace == Sudoku_tt_replace_t::two_tier ? num_slots / 2 : num_slots) - 1;
+}
+
+std::uint64_t Sudoku_transposition_table::root_salt(const Sudoku& s) {
+
+    Sudoku from_values(s);
+    sudoku_reset_candidates_all_cells(from_values);
+
+    uint64_t salt = 0;
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        const cand_mask_t mask = s(cnt).cand.mask();
+        if (s(cnt).val != 0 || mask == from_values(cnt).cand.mask()) continue;
+        salt ^= sudoku_mix64(((uint64_t(cnt) << 32) | mask) + 0x9e3779b97f4a7c15ULL);
+    }
+    return salt;
+}
+
+std::uint32_t Sudoku_transposition_table::tag(const Sudoku& s, std::uint64_t salt) {
+
+    // FNV-1a of the values, seeded with the salt
+    uint32_t h         = 2166136261u ^ static_cast<uint32_t>(salt >> 32);
+    const uint8_t* val = s.values();
+    for (int cnt = 0; cnt < s.total_size; ++cnt) {
+        h = (h ^ val[cnt]) * 16777619u;
+    }
+    return h;
+}
+
+const Sudoku_transposition_table::Entry*
+Sudoku_transposition_table::probe(std::uint64_t key, std::uint32_t tag,
+                                  Sudoku_search_stats& stats) const {
+
+    ++stats.tt_probes;
+    const int ways    = (m_replace == Sudoku_tt_replace_t::two_tier) ? 2 : 1;
+    const Entry* slot = m_slots.data() + (key & m_mask) * ways;
+    for (int w = 0; w < ways; ++w) {
+        if (slot[w].outcome != Outcome::none && slot[w].key == key) {
+            if (slot[w].tag != tag) return nullptr;    // other grid with the same key
+            ++stats.tt_hits;
+            return slot + w;
+        }
+    }
+    return nullptr;
+}
+
+void Sudoku_transposition_table::store(std::uint64_t key, std::uint32_t tag,
+                                       int num_empty, Outcome outcome,
+                                       std::uint32_t count, Sudoku_search_stats& stats) {
+
+    const Entry e{key, tag, count, static_cast<uint16_t>(num_empty), outcome};
+    Entry* slot = nullptr;
+
+    switch (m_replace) {
+        case Sudoku_tt_replace_t::always:
+            slot = &m_slots[key & m_mask];
+            break;
+        case Sudoku_tt_replace_t::depth_preferred:
+            slot = &m_slots[key & m_mask];
+            if (slot->outcome != Outcome::none && slot->key != key &&
+                slot->num_empty > e.num_empty) {
+                return;    // keep the larger subtree
+            }
+            break;
+        case Sudoku_tt_replace_t::two_tier: {
+            Entry* bucket = &m_slots[(key & m_mask) * 2];
+            if (bucket[1].outcome != Outcome::none && bucket[1].key == key) {
+                slot = bucket + 1;    // update in place
+            }
+            else if (bucket[0].outcome == Outcome::none || bucket[0].key == key ||
+                     bucket[0].num_empty <= e.num_empty) {
+                if (bucket[0].outcome != Outcome::none && bucket[0].key != key) {
+                    bucket[1] = bucket[0];    // demote to the always-replace slot
+                }
+                slot = bucket;
+            }
+            else {
+                slot = bucket + 1;
+            }
+            break;
+        }
+    }
+
+    ++stats.tt_stores;
+    if (slot->outcome != Outcome::none && slot->key != key) ++stats.tt_overwrites;
+    *slot = e;
+}
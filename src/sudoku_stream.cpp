@@ -0,0 +1,428 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_stream.h"
+#include "sudoku_file.h"
+#include "sudoku_line.h"
+#include "sudoku_metrics.h"
+#include "sudoku_queue.h"
+#include "sudoku_solve_batch.h"
+#include "sudoku_solve_cache.h"
+
+#include <algorithm>    // max()
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// reorder buffer: results of the chunks in flight, written in input order
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+class Reorder_buffer {
+
+  public:
+    explicit Reorder_buffer(size_t t_window) : m_slots(max<size_t>(t_window, 1)) {}
+
+    // reader: wait until chunk seq fits into the window; false if aborted
+    bool wait_for_slot(uint64_t seq) {
+        unique_lock<mutex> lock(m_mutex);
+        m_slot_free.wait(lock,
+                         [&] { return m_aborted || seq < m_next + m_slots.size(); });
+        return !m_aborted;
+    }
+
+    // worker: result of chunk seq (swapped with the cleared string of an earlier chunk,
+    // so allocations are reused), end: input offset and records at the end of the chunk
+    void put(uint64_t seq, string& out, const Sudoku_stream_checkpoint& end) {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            Slot& slot = m_slots[seq % m_slots.size()];
+            slot.out.swap(out);
+            slot.end   = end;
+            slot.ready = true;
+        }
+        m_ready.notify_one();
+    }
+
+    // reader: no. of chunks of the whole input, once known
+    void finish(uint64_t num_chunks) {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_num_chunks = num_chunks;
+        }
+        m_ready.notify_one();
+    }
+
+    // writer: failed to write, stop the reader
+    void abort() {
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_aborted = true;
+        }
+        m_slot_free.notify_all();
+    }
+
+    // writer: append the results of all chunks ready in order to out, waiting for the
+    // next one if wait is set; end is set to the input end of the last chunk appended;
+    // returns the no. of chunks appended (0 and wait: done)
+    size_t take(string& out, bool wait, Sudoku_stream_checkpoint& end) {
+        unique_lock<mutex> lock(m_mutex);
+        if (wait) {
+            m_ready.wait(lock, [this] { return next_ready() || m_next == m_num_chunks; });
+        }
+        size_t n = 0;
+        while (next_ready()) {
+            Slot& slot = m_slots[m_next % m_slots.size()];
+            out += slot.out;
+            slot.out.clear();
+            end.input_offset = slot.end.input_offset;    // output_offset is the writer's
+            end.records      = slot.end.records;
+            slot.ready = false;
+            ++m_next;
+            ++n;
+        }
+        lock.unlock();
+        if (n > 0) m_slot_free.notify_one();
+        return n;
+    }
+
+  private:
+    struct Slot {
+        string out;
+        Sudoku_stream_checkpoint end;
+        bool ready{false};
+    };
+
+    bool next_ready() const {
+        return m_next < m_num_chunks && m_slots[m_next % m_slots.size()].ready;
+    }
+
+    vector<Slot> m_slots;    // chunk seq in slot seq % size
+    mutex m_mutex;
+    condition_variable m_slot_free;
+    condition_variable m_ready;
+    uint64_t m_next{0};                   // next chunk to write
+    uint64_t m_num_chunks{UINT64_MAX};    // unknown until end of input
+    bool m_aborted{false};
+};
+
+struct Chunk {
+    uint64_t seq{0};
+    string lines;    // batch_size lines, each ending in '\n'
+    Sudoku_stream_checkpoint end;    // input offset and records after the last line
+};
+
+bool write_all(int fd, string_view data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// checkpoints
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static constexpr string_view checkpoint_tag = "sudoku_stream_checkpoint_v1";
+
+bool sudoku_read_stream_checkpoint(const std::string& path,
+                                   Sudoku_stream_checkpoint& cp) {
+
+    ifstream is(path);
+    string tag;
+    Sudoku_stream_checkpoint read;
+    if (!(is >> tag >> read.input_offset >> read.records >> read.output_offset) ||
+        tag != checkpoint_tag) {
+        return false;
+    }
+    cp = read;
+    return true;
+}
+
+bool sudoku_write_stream_checkpoint(const std::string& path,
+                                    const Sudoku_stream_checkpoint& cp) {
+
+    const string text = string(checkpoint_tag) + ' ' + to_string(cp.input_offset) + ' ' +
+                        to_string(cp.records) + ' ' + to_string(cp.output_offset) + '\n';
+    return sudoku_replace_file(path, text);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// sudoku_solve_stream
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// results of the valid puzzles of a chunk (nullopt: not in the format or breaking the
+// rules), in input order
+static void solve_chunk(const vector<optional<Sudoku>>& puzzles,
+                        const Sudoku_stream_options& opt,
+                        Sudoku_search_stats& search_stats,
+                        vector<pair<int, Sudoku>>& results) {
+
+    results.clear();
+    if (opt.engine != Sudoku_engine_t::batch) {
+        for (const auto& s : puzzles) {
+            if (!s) continue;
+            const auto t_start = chrono::steady_clock::now();
+            results.push_back(opt.cache ? sudoku_remove_cached(*s, *opt.cache, opt.engine,
+                                                               opt.search, search_stats)
+                                        : sudoku_remove_engine(*s, opt.engine,
+                                                               opt.search, search_stats));
+            if (opt.metrics) {
+                opt.metrics->record(opt.engine, chrono::steady_clock::now() - t_start);
+            }
+        }
+        return;
+    }
+
+    // batch engine: cache hits first, all other puzzles of the chunk in one call
+    const auto t_start = chrono::steady_clock::now();
+    vector<Sudoku> todo;
+    vector<Sudoku_canonical> canons;    // of todo (with a cache)
+    vector<size_t> todo_pos;            // of todo in results
+    for (const auto& s : puzzles) {
+        if (!s) continue;
+        if (opt.cache) {
+            Sudoku_canonical canon = sudoku_canonicalize(*s);
+            if (auto hit = opt.cache->lookup(*s, canon)) {
+                results.push_back(std::move(*hit));
+                continue;
+            }
+            canons.push_back(std::move(canon));
+        }
+        todo_pos.push_back(results.size());
+        results.emplace_back(0, *s);
+        todo.push_back(*s);
+    }
+    auto solved = sudoku_remove_recursive_batch(todo);
+    for (size_t k = 0; k < solved.size(); ++k) {
+        if (opt.cache) opt.cache->insert(canons[k], solved[k].second);
+        results[todo_pos[k]] = std::move(solved[k]);
+    }
+
+    // no latency per puzzle in a batch: each puzzle is recorded with the mean
+    if (opt.metrics && !results.empty()) {
+        const auto mean = (chrono::steady_clock::now() - t_start) /
+                          static_cast<long>(results.size());
+        for (size_t k = 0; k < results.size(); ++k) opt.metrics->record(opt.engine, mean);
+    }
+}
+
+bool sudoku_solve_stream(int in_fd, int out_fd, const Sudoku_stream_options& opt,
+                         Sudoku_stream_stats& stats) {
+
+    const int num_threads =
+        opt.threads > 0 ? opt.threads
+                        : max(1, static_cast<int>(thread::hardware_concurrency()));
+    const size_t batch_size = max<size_t>(opt.batch_size, 1);
+
+    // resume from the checkpoint, if there is one
+    Sudoku_stream_checkpoint start;
+    if (!opt.checkpoint_path.empty()) {
+        sudoku_read_stream_checkpoint(opt.checkpoint_path, start);
+        const auto out_offset = static_cast<off_t>(start.output_offset);
+        if (::ftruncate(out_fd, out_offset) != 0 ||
+            ::lseek(out_fd, out_offset, SEEK_SET) != out_offset) {
+            return false;
+        }
+    }
+
+    Reorder_buffer reorder(opt.window);
+    Sudoku_bounded_queue<Chunk> work(2 * static_cast<size_t>(num_threads));
+    atomic<long> solved{0}, unsolvable{0}, unsolved{0}, invalid{0};
+
+    vector<thread> workers;
+    for (int t = 0; t < num_threads; ++t) {
+        workers.emplace_back([&] {
+            vector<Chunk> taken;
+            string out;
+            Sudoku_search_stats search_stats;
+            long num_solved = 0, num_unsolvable = 0, num_unsolved = 0, num_invalid = 0;
+
+            vector<optional<Sudoku>> puzzles;
+            vector<pair<int, Sudoku>> results;
+
+            while (work.pop_batch(taken, 1) > 0) {
+                string_view lines = taken.front().lines;
+                puzzles.clear();
+                while (!lines.empty()) {
+                    const size_t end = lines.find('\n');
+                    auto s           = sudoku_from_line(lines.substr(0, end));
+                    lines.remove_prefix(end + 1);
+                    if (s && !sudoku_is_valid(*s)) s.reset();    // rules broken
+                    puzzles.push_back(std::move(s));
+                }
+                solve_chunk(puzzles, opt, search_stats, results);
+
+                auto res = results.begin();
+                for (const auto& s : puzzles) {
+                    if (!s) {    // format or rules broken
+                        out += "invalid -\n";
+                        ++num_invalid;
+                        continue;
+                    }
+                    const Sudoku& r = (res++)->second;
+                    if (sudoku_num_empty(r) == 0 && sudoku_is_valid(r)) {
+                        out += "solved ";
+                        sudoku_append_line(out, r);
+                        out += '\n';
+                        ++num_solved;
+                    }
+                    else if (opt.engine == Sudoku_engine_t::logic) {    // proves nothing
+                        out += "unsolved ";
+                        sudoku_append_line(out, r);
+                        out += '\n';
+                        ++num_unsolved;
+                    }
+                    else {
+                        out += "unsolvable -\n";
+                        ++num_unsolvable;
+                    }
+                }
+                reorder.put(taken.front().seq, out, taken.front().end);
+                out.clear();
+                taken.clear();
+            }
+            solved += num_solved;
+            unsolvable += num_unsolvable;
+            unsolved += num_unsolved;
+            invalid += num_invalid;
+        });
+    }
+
+    // writer: output in order, checkpoints after writing a block
+    bool write_ok = true;
+    long num_checkpoints = 0;
+    thread writer([&] {
+        string block;
+        block.reserve(2 * opt.flush_bytes);
+        Sudoku_stream_checkpoint taken = start;    // end of the last chunk in block
+        auto last_checkpoint           = chrono::steady_clock::now();
+
+        auto flush = [&](bool final) {
+            if (write_ok) write_ok = write_all(out_fd, block);
+            taken.output_offset += block.size();
+            block.clear();
+            if (!write_ok || opt.checkpoint_path.empty()) return;
+
+            const auto now = chrono::steady_clock::now();
+            if (final || chrono::duration<double>(now - last_checkpoint).count() >=
+                             opt.checkpoint_interval) {
+                // the output must be on disk before the checkpoint pointing behind it
+                write_ok = ::fdatasync(out_fd) == 0 &&
+                           sudoku_write_stream_checkpoint(opt.checkpoint_path, taken);
+                last_checkpoint = now;
+                ++num_checkpoints;
+            }
+        };
+
+        for (;;) {
+            if (reorder.take(block, false, taken) == 0) {
+                // nothing ready: write what there is before waiting
+                if (!block.empty()) flush(false);
+                if (reorder.take(block, true, taken) == 0) break;
+            }
+            if (block.size() >= opt.flush_bytes) flush(false);
+            if (!write_ok) reorder.abort();
+        }
+        flush(true);
+    });
+
+    // reader: cut the input into chunks of batch_size complete lines
+    bool read_ok = true;
+    string buf;
+    vector<char> in(1 << 20);
+    Chunk chunk;
+    chunk.end             = start;
+    size_t lines_in_chunk = 0;
+    long records          = 0;
+
+    auto submit = [&] {
+        if (!reorder.wait_for_slot(chunk.seq)) return false;
+        const uint64_t seq = chunk.seq;
+        const auto end     = chunk.end;
+        work.push(std::move(chunk));
+        chunk          = Chunk{};
+        chunk.seq      = seq + 1;
+        chunk.end      = end;
+        lines_in_chunk = 0;
+        return true;
+    };
+
+    // input offset of the next block read; resume by seeking, or else by skipping
+    uint64_t offset  = 0;
+    uint64_t to_skip = start.input_offset;
+    const auto in_offset = static_cast<off_t>(to_skip);
+    if (to_skip > 0 && ::lseek(in_fd, in_offset, SEEK_SET) == in_offset) {
+        offset  = to_skip;
+        to_skip = 0;
+    }
+
+    for (bool more = true; more;) {
+        const ssize_t n = ::read(in_fd, in.data(), in.size());
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) read_ok = false;
+        more = n > 0;
+
+        string_view data(in.data(), n > 0 ? static_cast<size_t>(n) : 0);
+        offset += data.size();
+        const uint64_t skip = min<uint64_t>(to_skip, data.size());
+        data.remove_prefix(skip);
+        to_skip -= skip;
+        if (!more && !buf.empty()) data = "\n";    // last line without line end
+
+        while (!data.empty()) {
+            const size_t end = data.find('\n');
+            if (end == string_view::npos) {
+                buf.append(data);
+                break;
+            }
+            chunk.lines += buf;
+            chunk.lines.append(data.substr(0, end + 1));
+            buf.clear();
+            data.remove_prefix(end + 1);
+            ++records;
+            ++chunk.end.records;
+            chunk.end.input_offset = offset - data.size();    // end of this line
+            if (++lines_in_chunk == batch_size && !submit()) {
+                more = false;    // output failed
+                break;
+            }
+        }
+    }
+    if (lines_in_chunk > 0) submit();
+    reorder.finish(chunk.seq);
+
+    work.close();
+    for (auto& t : workers) t.join();
+    writer.join();
+
+    stats.records += records;
+    stats.solved += solved;
+    stats.unsolvable += unsolvable;
+    stats.unsolved += unsolved;
+    stats.invalid += invalid;
+    stats.resumed += static_cast<long>(start.records);
+    stats.checkpoints += num_checkpoints;
+    return read_ok && write_ok;
+}
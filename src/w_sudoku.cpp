@@ -621,7 +621,7 @@ void w_Sudoku::on_update_request_by_child(int from_child) {
 
 void w_Sudoku::on_value_changed_by_user(int from_child, int value) {
   store_sudoku_for_undo(s);
-  s(from_child).val = value;
+  s.set_value(from_child, value);
   sudoku_update_candidates_affected_by_cell(s, from_child);
 
   emit text_msg(QString("User entered value ") + QString::number(value) +
@@ -0,0 +1,109 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_canonical.h"
+#include "sudoku_generate.h"
+#include "sudoku_solve.h"
+#include "test_util.h"
+
+#include <algorithm>    // shuffle()
+#include <cstdint>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <numeric>    // iota()
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// canonical form (sudoku_canonical.h) of 4x4, 6x6 (2x3 blocks) and 9x9 puzzles and
+// their solutions
+//
+//   - random symmetric variants are valid and have the canonical key of the original
+//   - the transform found maps a variant onto the canonical grid
+//   - a transform followed by its inverse gives back the original
+//   - sudoku_canonicalize_all() gives the keys of sudoku_canonicalize()
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// permutation of n groups of k in a row: groups and the entries within each shuffled
+static vector<int> shuffle_groups(int n, int k, mt19937_64& rng) {
+    vector<int> groups(n), perm;
+    iota(groups.begin(), groups.end(), 0);
+    shuffle(groups.begin(), groups.end(), rng);
+    for (int g : groups) {
+        vector<int> within(k);
+        iota(within.begin(), within.end(), g * k);
+        shuffle(within.begin(), within.end(), rng);
+        perm.insert(perm.end(), within.begin(), within.end());
+    }
+    return perm;
+}
+
+// random symmetry of the shape of s
+static Sudoku_transform random_transform(const Sudoku& s, mt19937_64& rng) {
+    const int n            = s.region_size;
+    const int rows_per_blk = n / s.blocks_per_col;
+    const int cols_per_blk = n / s.blocks_per_row;
+    Sudoku_transform tr;
+    tr.transpose = rows_per_blk == cols_per_blk && rng() % 2 == 1;
+    tr.row       = shuffle_groups(s.blocks_per_col, rows_per_blk, rng);
+    tr.col       = shuffle_groups(s.blocks_per_row, cols_per_blk, rng);
+    tr.digit.resize(n + 1);
+    iota(tr.digit.begin(), tr.digit.end(), 0);
+    shuffle(tr.digit.begin() + 1, tr.digit.end(), rng);
+    return tr;
+}
+
+int main() {
+
+    mt19937_64 rng(42);
+    const int shapes[][3] = {{4, 2, 2}, {6, 2, 3}, {9, 3, 3}};
+
+    for (const auto& shape : shapes) {
+        const string size = to_string(shape[0]) + "x" + to_string(shape[0]);
+        vector<Sudoku> originals;
+        vector<string> keys;
+        for (uint64_t seed = 0; seed < 3; ++seed) {
+            Sudoku_generate_options gen_opt;
+            gen_opt.seed    = seed;
+            gen_opt.threads = 1;
+            Sudoku_generate_stats gen_stats;
+            const auto p =
+                sudoku_generate(shape[0], shape[1], shape[2], gen_opt, gen_stats);
+            if (!p) continue;
+
+            for (const Sudoku& s : {*p, sudoku_remove_recursive(*p).second}) {
+                const string name = size + " seed " + to_string(seed) +
+                                    (sudoku_num_empty(s) == 0 ? " solution" : " puzzle");
+                const Sudoku_canonical c = sudoku_canonicalize(s);
+                const Sudoku canonical   = sudoku_apply_transform(s, c.transform);
+                check(sudoku_canonical_key(canonical) == c.key,
+                      name + ": transform onto the canonical grid");
+
+                for (int k = 0; k < 20; ++k) {
+                    const Sudoku_transform tr = random_transform(s, rng);
+                    const Sudoku variant      = sudoku_apply_transform(s, tr);
+                    check(sudoku_is_valid(variant), name + ": variant valid");
+                    const Sudoku_canonical cv = sudoku_canonicalize(variant);
+                    check(cv.key == c.key, name + ": key of a variant");
+                    check(same_values(sudoku_apply_transform(variant, cv.transform),
+                                      canonical),
+                          name + ": transform of a variant onto the canonical grid");
+                    const Sudoku_transform inv = sudoku_inverse_transform(tr);
+                    check(same_values(sudoku_apply_transform(variant, inv), s),
+                          name + ": inverse transform");
+                }
+                originals.push_back(s);
+                keys.push_back(c.key);
+            }
+        }
+
+        const auto all = sudoku_canonicalize_all(originals, 2);
+        bool same = all.size() == keys.size();
+        for (size_t k = 0; same && k < keys.size(); ++k) same = all[k].key == keys[k];
+        check(same, size + ": sudoku_canonicalize_all()");
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
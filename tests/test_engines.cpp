@@ -0,0 +1,175 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_generate.h"
+#include "sudoku_solve.h"
+#include "sudoku_solve_batch.h"
+#include "sudoku_solve_fixed.h"
+#include "sudoku_solve_sat.h"
+#include "test_util.h"
+
+#include <cstdint>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <string>
+#include <utility>    // pair
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// equivalence of the engines with the plain recursive search
+//
+//   - specialized solver (sudoku_solve_fixed.h) against the generic one
+//   - batch solver (sudoku_solve_batch.h) against sudoku_remove_recursive()
+//   - SAT engine (sudoku_solve_sat.h) against sudoku_remove_recursive()
+//   - backjumping, with and without nogoods (sudoku_solve_cbj.h), against the plain
+//     search: same result and never more search nodes
+//   - mixed search with probing (sudoku_solve_probe.h) against the one without: same
+//     result; probes are made and counted
+//
+// on generated puzzles of all specialized shapes (unique solution), unsolvable variants
+// of them (one empty cell set to a value other than its solution, without breaking the
+// rules) and puzzles breaking the rules
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct Puzzle {
+    string name;
+    Sudoku s;
+};
+
+static void check(bool ok, const string& what, const Puzzle& p) {
+    check(ok, what + " (" + p.name + ")");
+}
+
+// same no. of entries made and same values
+static bool same_result(const pair<int, Sudoku>& a, const pair<int, Sudoku>& b) {
+    return a.first == b.first && same_values(a.second, b.second);
+}
+
+static vector<Puzzle> test_puzzles() {
+
+    struct Shape {
+        int region_size, blocks_per_row, blocks_per_col, count;
+    };
+    const Shape shapes[] = {{4, 2, 2, 4}, {6, 2, 3, 4}, {6, 3, 2, 4}, {9, 3, 3, 8},
+                            {16, 4, 4, 2}};
+
+    vector<Puzzle> puzzles;
+    for (const auto& sh : shapes) {
+        if (sh.region_size > sudoku_max_region_size) continue;
+        for (int k = 0; k < sh.count; ++k) {
+            Sudoku_generate_options opt;
+            opt.seed    = static_cast<uint64_t>(k);
+            opt.threads = 1;
+            Sudoku_generate_stats stats;
+            auto p = sudoku_generate(sh.region_size, sh.blocks_per_row, sh.blocks_per_col,
+                                     opt, stats);
+            if (!p) continue;
+            const string name = to_string(sh.region_size) + ":" +
+                                to_string(sh.blocks_per_row) + ":" +
+                                to_string(sh.blocks_per_col) + " seed " + to_string(k);
+            puzzles.push_back({name, *p});
+
+            // unsolvable variant: the solution is unique, so any other value in an
+            // empty cell leaves no solution
+            const auto solved = sudoku_remove_recursive(*p);
+            for (int cnt = 0; cnt < p->total_size; ++cnt) {
+                const auto c = (*p)(cnt);
+                if (c.val != 0 || c.cand.size() < 2) continue;
+                for (int v : c.cand) {
+                    if (v == solved.second.values()[cnt]) continue;
+                    Sudoku u(*p);
+                    u.set_value(cnt, v);
+                    sudoku_update_candidates_all_cells(u);
+                    puzzles.push_back({name + " unsolvable", u});
+                    break;
+                }
+                break;
+            }
+
+            // breaking the rules: the first entry once more in its row
+            if (k == 0) {
+                Sudoku b(*p);
+                for (int cnt = 0; cnt < b.total_size; ++cnt) {
+                    const int v = b.values()[cnt];
+                    const int j = cnt % b.region_size;
+                    if (v == 0) continue;
+                    const int other = cnt - j + (j + 1) % b.region_size;
+                    b.set_value(other, v);
+                    sudoku_update_candidates_all_cells(b);
+                    break;
+                }
+                puzzles.push_back({name + " invalid", b});
+            }
+        }
+    }
+    return puzzles;
+}
+
+int main() {
+
+    const vector<Puzzle> puzzles = test_puzzles();
+
+    vector<Sudoku> all;
+    for (const auto& p : puzzles) all.push_back(p.s);
+    const auto batch = sudoku_remove_recursive_batch(all);
+
+    long plain_nodes = 0, cbj_nodes = 0, probes = 0, probe_learned = 0;
+    for (size_t i = 0; i < puzzles.size(); ++i) {
+        const Puzzle& p = puzzles[i];
+
+        // plain search (specialized solver for all shapes of the test)
+        Sudoku_search_options plain_opt;
+        Sudoku_search_stats plain_stats;
+        const auto plain = sudoku_remove_recursive(p.s, plain_opt, plain_stats);
+
+        // specialized solver against the generic search (lvl > 0 skips the dispatch
+        // to the specialized solver; too slow for 16x16)
+        const auto fixed = sudoku_remove_recursive_fixed(p.s);
+        check(fixed.has_value(), "specialized solver available", p);
+        if (fixed && p.s.region_size <= 9) {
+            check(same_result(*fixed, sudoku_remove_recursive(p.s, 1)),
+                  "specialized solver == generic search", p);
+        }
+
+        check(same_result(batch[i], plain), "batch solver == recursive search", p);
+
+        // SAT engine: same result for unique and for no solution
+        check(same_result(sudoku_remove_sat(p.s), plain),
+              "SAT engine == recursive search", p);
+
+        for (bool nogoods : {false, true}) {
+            Sudoku_search_options opt;
+            opt.backjumping = true;
+            opt.nogoods     = nogoods;
+            Sudoku_search_stats stats;
+            const auto cbj = sudoku_remove_recursive(p.s, opt, stats);
+            const string what = nogoods ? "backjumping with nogoods" : "backjumping";
+            check(same_result(cbj, plain), what + " == recursive search", p);
+            check(stats.nodes <= plain_stats.nodes, what + ": nodes <= plain nodes", p);
+            if (!nogoods) cbj_nodes += stats.nodes;
+        }
+        plain_nodes += plain_stats.nodes;
+
+        // probing: same result as the mixed search without it (too slow for 16x16)
+        if (p.s.region_size > 9) continue;
+        Sudoku_search_options mixed_opt;
+        Sudoku_search_stats mixed_stats;
+        const auto mixed =
+            sudoku_remove_recursive_algo_all_mixed(p.s, mixed_opt, mixed_stats);
+        Sudoku_search_options probe_opt;
+        probe_opt.probing = true;
+        Sudoku_search_stats stats;
+        const auto probed = sudoku_remove_recursive_algo_all_mixed(p.s, probe_opt, stats);
+        check(same_result(probed, mixed), "mixed search with probing == mixed search", p);
+        check(mixed_stats.probes == 0, "mixed search without probing: no probes", p);
+        probes += stats.probes;
+        probe_learned += stats.probe_failures + stats.probe_agreements;
+    }
+    check(probes > 0 && probe_learned > 0, "probing: probes made and counted");
+
+    cout << puzzles.size() << " puzzles checked, search nodes: plain " << plain_nodes
+         << ", backjumping " << cbj_nodes << "; probes " << probes << " ("
+         << probe_learned << " learned)\n";
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
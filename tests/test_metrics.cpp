@@ -0,0 +1,96 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_metrics.h"
+#include "test_util.h"
+
+#include <cstdint>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// latency histogram (Sudoku_latency_histogram in sudoku_metrics.h)
+//
+//   - bucket_of() maps every value into its bucket: bucket_max() of the bucket before
+//     < value <= bucket_max() of its bucket, within 1/32 (values below 32 exactly),
+//     up to the largest uint64
+//   - percentile() lies within the bucket of the exact percentile, and never above
+//     the maximum recorded
+//   - records of several threads are all counted
+//////////////////////////////////////////////////////////////////////////////////////////
+
+using Histogram = Sudoku_latency_histogram;
+
+// bucket of v: in range, the right one, at most 1/32 above v
+static bool bucket_ok(uint64_t v) {
+    const int b = Histogram::bucket_of(v);
+    if (b < 0 || b >= Histogram::num_buckets) return false;
+    const uint64_t hi = Histogram::bucket_max(b);
+    if (v > hi || (b > 0 && Histogram::bucket_max(b - 1) >= v)) return false;
+    return v < Histogram::sub_buckets ? hi == v : hi - v <= v / Histogram::sub_buckets;
+}
+
+int main() {
+
+    // buckets
+    bool ok = true;
+    for (uint64_t v = 0; v < 5000; ++v) ok = ok && bucket_ok(v);
+    for (int bit = 5; bit < 64; ++bit) {
+        const uint64_t p = uint64_t{1} << bit;
+        for (uint64_t v : {p - 1, p, p + 1, p + p / 3, p + p / 2 + 7}) {
+            ok = ok && bucket_ok(v);
+        }
+    }
+    ok = ok && bucket_ok(numeric_limits<uint64_t>::max());
+    check(ok, "bucket_of() and bucket_max()");
+    check(Histogram::bucket_of(numeric_limits<uint64_t>::max()) ==
+                  Histogram::num_buckets - 1 &&
+              Histogram::bucket_max(Histogram::num_buckets - 1) ==
+                  numeric_limits<uint64_t>::max(),
+          "last bucket");
+    bool monotonic = true;
+    for (int b = 1; b < Histogram::num_buckets; ++b) {
+        const uint64_t hi = Histogram::bucket_max(b);
+        monotonic = monotonic && Histogram::bucket_max(b - 1) < hi &&
+                    Histogram::bucket_of(hi) == b;
+    }
+    check(monotonic, "bucket_max() increasing, each in its own bucket");
+
+    // percentiles of 1 us .. 10 ms in steps of 1 us
+    Histogram h;
+    check(h.snapshot().percentile(0.5) == 0, "empty: percentile 0");
+    const uint64_t num = 10000;
+    for (uint64_t k = 1; k <= num; ++k) h.record(k * 1000);
+    const auto snap = h.snapshot();
+    check(snap.count == num && snap.max_ns == num * 1000, "count and max");
+    for (double q : {0.0001, 0.5, 0.9, 0.99, 0.999, 1.0}) {
+        const uint64_t exact = static_cast<uint64_t>(q * double(num) + 0.5) * 1000;
+        const uint64_t p     = snap.percentile(q);
+        check(p >= exact && p - exact <= exact / Histogram::sub_buckets &&
+                  p <= snap.max_ns,
+              "percentile " + to_string(q) + ": " + to_string(p) + " for " +
+                  to_string(exact));
+    }
+
+    // records of several threads
+    Histogram mt;
+    vector<thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&mt, t] {
+            for (uint64_t k = 0; k < 100000; ++k) mt.record(k * (t + 1));
+        });
+    }
+    for (auto& t : threads) t.join();
+    const auto mt_snap = mt.snapshot();
+    uint64_t total     = 0;
+    for (auto c : mt_snap.counts) total += c;
+    check(mt_snap.count == 400000 && total == 400000 && mt_snap.max_ns == 399996,
+          "records of 4 threads");
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
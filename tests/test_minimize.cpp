@@ -0,0 +1,104 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_check_pool.h"
+#include "sudoku_generate.h"
+#include "sudoku_minimize.h"
+#include "sudoku_solve.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// minimizer (sudoku_minimize.h) and its thread pool (sudoku_check_pool.h)
+//
+//   - every task of a batch runs exactly once, over many batches of a pool
+//   - minimal puzzles of full solutions: the clues are a subset, the solution stays
+//     unique and no clue can be removed; the same result with 1 and 3 threads
+//   - sudoku_minimize_all() gives the results of sudoku_minimize() puzzle by puzzle
+//   - a puzzle with several solutions has no minimal puzzle
+//////////////////////////////////////////////////////////////////////////////////////////
+
+int main() {
+
+    // pool: batches of all sizes up to 2x the threads
+    Sudoku_check_pool pool(3);
+    bool once = true;
+    for (int round = 0; round < 200; ++round) {
+        const int n = round % 7;
+        vector<atomic<int>> calls(n);
+        pool.run(n, [&](int k) { ++calls[k]; });
+        for (const auto& c : calls) once = once && c == 1;
+    }
+    check(once, "pool: each task run once per batch");
+
+    mt19937_64 rng(11);
+    vector<Sudoku> puzzles;
+    for (int k = 0; k < 6; ++k) {
+        const bool small = k % 2 == 0;
+        puzzles.push_back(small ? sudoku_generate_solution(4, 2, 2, rng)
+                                : sudoku_generate_solution(9, 3, 3, rng));
+    }
+
+    Sudoku_minimize_options opt;
+    opt.shuffle = true;
+    opt.seed    = 5;
+    Sudoku_minimize_stats seq_stats;
+    vector<optional<Sudoku>> seq;
+    for (const auto& s : puzzles) {
+        const string name = to_string(s.region_size) + "x" + to_string(s.region_size);
+        opt.threads = 1;
+        seq.push_back(sudoku_minimize(s, opt, seq_stats));
+        const auto& m = seq.back();
+        check(m.has_value(), name + ": minimized");
+        if (!m) continue;
+
+        bool subset = true;
+        for (int cnt = 0; cnt < s.total_size; ++cnt) {
+            const int v = m->values()[cnt];
+            subset      = subset && (v == 0 || v == s.values()[cnt]);
+        }
+        check(subset, name + ": clues of the solution");
+        check(sudoku_count_solutions(*m, 2) == 1, name + ": unique solution");
+        check(sudoku_is_minimal(*m), name + ": minimal");
+
+        opt.threads = 3;
+        Sudoku_minimize_stats par_stats;
+        const auto par = sudoku_minimize(s, opt, par_stats);
+        check(par && same_values(*par, *m), name + ": same result with 3 threads");
+    }
+
+    opt.threads = 3;
+    Sudoku_minimize_stats all_stats;
+    const auto all = sudoku_minimize_all(puzzles, opt, all_stats);
+    bool same = all.size() == seq.size();
+    for (size_t k = 0; same && k < all.size(); ++k) {
+        same = all[k] && seq[k] && same_values(*all[k], *seq[k]);
+    }
+    check(same, "sudoku_minimize_all(): results of sudoku_minimize()");
+    check(all_stats.checks == seq_stats.checks &&
+              all_stats.removals == seq_stats.removals,
+          "sudoku_minimize_all(): stats of sudoku_minimize()");
+
+    // several solutions: the first clue of a minimal puzzle removed
+    if (seq[1]) {
+        Sudoku ambiguous(*seq[1]);
+        for (int cnt = 0; cnt < ambiguous.total_size; ++cnt) {
+            if (ambiguous.values()[cnt] == 0) continue;
+            ambiguous.set_value(cnt, 0);
+            break;
+        }
+        Sudoku_minimize_stats stats;
+        check(!sudoku_minimize(ambiguous, opt, stats), "several solutions: none");
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,102 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_generate.h"
+#include "sudoku_line.h"
+#include "sudoku_solve.h"
+#include "sudoku_solve_portfolio.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <numeric>    // accumulate()
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// portfolio solve (sudoku_solve_portfolio.h) against sudoku_remove_recursive()
+//
+//   - generated puzzles (unique solution) and unsolvable variants of them: same result
+//     with the default portfolio and with Sudoku_engine_t::portfolio
+//   - every call is counted once, as a win of an entry or as undecided
+//   - a portfolio of the logic engine only does not decide a hard puzzle
+//   - a cancelled call returns the sudoku unchanged and counts as undecided
+//////////////////////////////////////////////////////////////////////////////////////////
+
+int main() {
+
+    vector<Sudoku> puzzles;
+    for (int k = 0; k < 6; ++k) {
+        Sudoku_generate_options opt;
+        opt.seed    = static_cast<uint64_t>(k);
+        opt.threads = 1;
+        Sudoku_generate_stats stats;
+        const bool small = k % 2 == 0;
+        auto p = small ? sudoku_generate(4, 2, 2, opt, stats)
+                       : sudoku_generate(9, 3, 3, opt, stats);
+        if (!p) continue;
+        puzzles.push_back(*p);
+
+        // unsolvable variant: another candidate in the first cell with several
+        const Sudoku solved = sudoku_remove_recursive(*p).second;
+        for (int cnt = 0; cnt < p->total_size; ++cnt) {
+            const auto c = (*p)(cnt);
+            if (c.val != 0 || c.cand.size() < 2) continue;
+            Sudoku u(*p);
+            for (int v : c.cand) {
+                if (v == solved.values()[cnt]) continue;
+                u.set_value(cnt, v);
+                break;
+            }
+            puzzles.push_back(u);
+            break;
+        }
+    }
+    check(puzzles.size() == 12, "puzzles generated");
+
+    const auto entries = sudoku_default_portfolio();
+    Sudoku_portfolio_stats stats;
+    for (size_t k = 0; k < puzzles.size(); ++k) {
+        const Sudoku& p   = puzzles[k];
+        const string name = "puzzle " + to_string(k);
+        const auto expect = sudoku_remove_recursive(p);
+
+        const auto res = sudoku_remove_portfolio(p, entries, stats);
+        check(res.first == expect.first && same_values(res.second, expect.second),
+              name + ": portfolio == recursive search");
+
+        const auto eng = sudoku_remove_engine(p, Sudoku_engine_t::portfolio);
+        check(eng.first == expect.first && same_values(eng.second, expect.second),
+              name + ": Sudoku_engine_t::portfolio == recursive search");
+    }
+    const long n   = static_cast<long>(puzzles.size());
+    const long won = accumulate(stats.wins.begin(), stats.wins.end(), 0L);
+    check(stats.solves == n, "solves counted");
+    check(stats.wins.size() == entries.size(), "one win counter per entry");
+    check(won == n && stats.undecided == 0, "complete entries: every call won");
+
+    // logic techniques only: no definite result for a hard puzzle
+    const Sudoku hard = *sudoku_from_line("800000000003600000070090200050007000000045700"
+                                          "000100030001000068008500010090000400");
+    const vector<Sudoku_portfolio_entry> logic_only = {
+        {"logic", Sudoku_engine_t::logic, {}}};
+    Sudoku_portfolio_stats logic_stats;
+    const auto res = sudoku_remove_portfolio(hard, logic_only, logic_stats);
+    check(logic_stats.solves == 1 && logic_stats.undecided == 1 &&
+              logic_stats.wins == vector<long>{0},
+          "logic only: undecided");
+    check(sudoku_num_empty(res.second) > 0, "logic only: result of the entry");
+
+    // cancelled before the start
+    const atomic<bool> cancel{true};
+    Sudoku_portfolio_stats cancel_stats;
+    const auto cancelled = sudoku_remove_portfolio(hard, entries, cancel_stats, &cancel);
+    check(cancelled.first == 0 && same_values(cancelled.second, hard) &&
+              cancel_stats.undecided == 1,
+          "cancelled: unchanged, undecided");
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
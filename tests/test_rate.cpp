@@ -0,0 +1,87 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_line.h"
+#include "sudoku_rate.h"
+#include "sudoku_solve.h"
+#include "test_util.h"
+
+#include <array>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// difficulty rating (sudoku_rate.h) of known puzzles
+//
+//   - technique counts, steps, cells left, score and tier of the puzzles in input/
+//     (sudoku.in.einsteiger, .mittel, .standard and .hardest)
+//   - a solution with one cell emptied: one naked single
+//   - a cell without candidates: contradiction found
+//////////////////////////////////////////////////////////////////////////////////////////
+
+using Counts = array<int, Sudoku_solution_t::enum_count>;
+
+struct Known {
+    string name;
+    string line;
+    bool solved;
+    Counts count;
+    int steps, remaining, score;
+    Sudoku_tier_t tier;
+};
+
+static void check_rating(const Known& k) {
+    const auto s = sudoku_from_line(k.line);
+    check(s.has_value(), k.name + ": puzzle read");
+    if (!s) return;
+    const Sudoku_rating r = sudoku_rate(*s);
+    check(r.valid, k.name + ": valid");
+    check(r.solved == k.solved, k.name + ": solved by logic");
+    check(r.count == k.count, k.name + ": technique counts");
+    check(r.steps == k.steps, k.name + ": steps " + to_string(r.steps));
+    check(r.remaining == k.remaining, k.name + ": cells left " + to_string(r.remaining));
+    check(r.score == k.score, k.name + ": score " + to_string(r.score));
+    check(r.tier == k.tier, k.name + ": tier " + string(sudoku_tier_name(r.tier)));
+    check(r.hardest == (k.solved ? Sudoku_solution_t::naked_single
+                                 : Sudoku_solution_t::enum_count),
+          k.name + ": hardest technique");
+}
+
+int main() {
+
+    const Known known[] = {
+        {"einsteiger",
+         "640298507052106984798045062903614870086530429"
+         "574082603830769241419803756207451308",
+         true, Counts{16}, 1, 0, 16, Sudoku_tier_t::einsteiger},
+        {"mittel",
+         "790058200004607058503002670040270506039500180"
+         "670019002900701004068005700307480025",
+         true, Counts{37}, 4, 0, 67, Sudoku_tier_t::mittel},
+        {"standard",
+         "080600020300008009000003100800100630000080000"
+         "035006007004900000700500004060002090",
+         false, Counts{12, 24}, 11, 20, 560, Sudoku_tier_t::standard},
+        {"hardest",
+         "800000000003600000070090200050007000000045700"
+         "000100030001000068008500010090000400",
+         false, Counts{}, 0, 60, 1200, Sudoku_tier_t::hardest}};
+    for (const auto& k : known) check_rating(k);
+
+    // solution of "mittel" with one cell emptied
+    Sudoku one = sudoku_remove_recursive(*sudoku_from_line(known[1].line)).second;
+    one.set_value(40, 0);
+    const Sudoku_rating r1 = sudoku_rate(one);
+    check(r1.solved && r1.count == Counts{1} && r1.steps == 1 && r1.score == 1 &&
+              r1.tier == Sudoku_tier_t::einsteiger,
+          "one empty cell: one naked single");
+
+    // cell (0, 0): 1..8 in its row, 9 in its column
+    const Sudoku dead = *sudoku_from_line("0123456789" + string(71, '0'));
+    const Sudoku_rating rd = sudoku_rate(dead);
+    check(!rd.valid && !rd.solved, "cell without candidates: contradiction");
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
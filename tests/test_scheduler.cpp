@@ -0,0 +1,133 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_scheduler.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// job scheduler (sudoku_scheduler.h), single threaded
+//
+//   - within a class earliest deadline first, jobs without deadline last in the order
+//     of arrival
+//   - interactive before batch, one batch job after interactive_burst interactive ones
+//     in a row while batch jobs wait
+//   - a batch job ends a batch: interactive jobs pushed meanwhile go first
+//   - jobs past their deadline handed back as expired
+//   - after close(): push() fails, the jobs left are handed out, then 0
+//////////////////////////////////////////////////////////////////////////////////////////
+
+using Scheduler = Sudoku_scheduler<int>;
+using ms        = chrono::milliseconds;
+
+// jobs of one pop_batch() (expired jobs must be none); none if nothing is queued, where
+// pop_batch() would wait
+static vector<int> pop(Scheduler& s, size_t max_items = 100) {
+    vector<int> out, expired;
+    if (s.size() == 0) return out;
+    s.pop_batch(out, max_items, expired);
+    if (!expired.empty()) check(false, "no job expired");
+    return out;
+}
+
+int main() {
+
+    const auto now             = Scheduler::clock::now();
+    constexpr auto interactive = Sudoku_priority_t::interactive;
+    constexpr auto batch       = Sudoku_priority_t::batch;
+
+    {    // earliest deadline first
+        Scheduler s(16);
+        s.push(1, interactive);
+        s.push(2, interactive, now + ms(3000));
+        s.push(3, interactive);
+        s.push(4, interactive, now + ms(1000));
+        s.push(5, interactive, now + ms(2000));
+        check(pop(s) == vector<int>{4, 5, 2, 1, 3}, "earliest deadline first");
+        s.push(6, interactive);
+        s.push(7, interactive, now + ms(1000));
+        check(pop(s, 1) == vector<int>{7}, "max_items");
+        check(s.size() == 1, "one job left");
+    }
+
+    {    // classes
+        Scheduler s(16, 2);
+        s.push(10, batch);
+        s.push(11, batch);
+        for (int i = 0; i < 5; ++i) s.push(i, interactive);
+        check(pop(s) == vector<int>{0, 1, 10}, "burst of 2, then a batch job ends it");
+        check(pop(s) == vector<int>{2, 3, 11}, "next burst");
+        check(pop(s) == vector<int>{4}, "interactive job left");
+
+        s.push(20, batch, now + ms(2000));
+        s.push(21, batch, now + ms(1000));
+        s.push(22, batch);
+        check(pop(s) == vector<int>{21}, "batch jobs one at a time");
+        s.push(23, interactive);
+        check(pop(s) == vector<int>{23, 20}, "interactive job pushed meanwhile first");
+        check(pop(s) == vector<int>{22}, "last batch job");
+
+        const auto st = s.stats();
+        check(st.cls[0].queued == 6 && st.cls[0].dispatched == 6, "interactive stats");
+        check(st.cls[1].queued == 5 && st.cls[1].dispatched == 5, "batch stats");
+    }
+
+    {    // interactive jobs without batch jobs waiting don't count towards the burst
+        Scheduler s(16, 2);
+        for (int i = 0; i < 5; ++i) s.push(i, interactive);
+        check(pop(s).size() == 5, "interactive jobs alone");
+        s.push(10, batch);
+        for (int i = 5; i < 8; ++i) s.push(i, interactive);
+        check(pop(s) == vector<int>{5, 6, 10}, "burst counted once a batch job waits");
+    }
+
+    {    // strict priority
+        Scheduler s(32, 0);
+        s.push(10, batch);
+        vector<int> expected;
+        for (int i = 0; i < 20; ++i) {
+            s.push(i, interactive);
+            expected.push_back(i);
+        }
+        expected.push_back(10);
+        check(pop(s) == expected, "strict priority: the batch job last");
+    }
+
+    {    // expiry
+        Scheduler s(16);
+        s.push(1, interactive, now - ms(1));
+        s.push(2, interactive, now + ms(60000));
+        s.push(3, batch, now - ms(2));
+        s.push(4, interactive, now - ms(3));
+        vector<int> out, expired;
+        check(s.pop_batch(out, 1, expired) == 3, "expired jobs counted");
+        check(out == vector<int>{2}, "job within its deadline dispatched");
+        check(expired == vector<int>{4, 1}, "expired jobs in dispatch order");
+        out.clear();
+        expired.clear();
+        check(s.pop_batch(out, 1, expired) == 1 && out.empty() &&
+                  expired == vector<int>{3},
+              "expired batch job");
+        const auto st = s.stats();
+        check(st.cls[0].expired == 2 && st.cls[1].expired == 1, "expired stats");
+    }
+
+    {    // close
+        Scheduler s(16);
+        s.push(1, batch);
+        s.push(2, interactive);
+        s.close();
+        check(!s.push(3, interactive), "push after close");
+        check(pop(s) == vector<int>{2, 1}, "jobs left after close");
+        vector<int> out, expired;
+        check(s.pop_batch(out, 100, expired) == 0, "closed and empty");
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
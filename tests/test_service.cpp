@@ -0,0 +1,124 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_generate.h"
+#include "sudoku_line.h"
+#include "sudoku_service.h"
+#include "sudoku_solve.h"
+#include "test_util.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <cstring>    // memcpy()
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solve service (sudoku_service.h) on a socket in /tmp
+//
+//   - a text request is answered with the solution of the recursive search
+//   - a client sending requests without reading the replies breaks its connection
+//     after send_timeout_ms: the requests left are dropped and stop() returns
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// connected client socket, or -1
+static int connect_to(const string& path) {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// all of data, false if the connection broke before
+static bool send_all(int fd, const string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n =
+            ::send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// one line without '\n', empty at end of stream
+static string read_line(int fd) {
+    string line;
+    char c;
+    while (::recv(fd, &c, 1, 0) == 1 && c != '\n') line += c;
+    return line;
+}
+
+int main() {
+
+    Sudoku_generate_options gen_opt;
+    gen_opt.seed    = 1;
+    gen_opt.threads = 1;
+    Sudoku_generate_stats gen_stats;
+    const auto puzzle = sudoku_generate(9, 3, 3, gen_opt, gen_stats);
+    check(puzzle.has_value(), "puzzle generated");
+    if (!puzzle) return EXIT_FAILURE;
+    const string line     = sudoku_to_line(*puzzle);
+    const string solution = sudoku_to_line(sudoku_remove_recursive(*puzzle).second);
+
+    Sudoku_service_options opt;
+    opt.socket_path     = "/tmp/test_service." + to_string(::getpid()) + ".sock";
+    opt.threads         = 1;
+    opt.queue_capacity  = 64;
+    opt.send_timeout_ms = 200;
+    Sudoku_service service(opt);
+    check(service.start(), "service started: " + service.error());
+
+    // request and reply
+    const int fd = connect_to(opt.socket_path);
+    check(fd >= 0, "connected");
+    if (fd >= 0) {
+        check(send_all(fd, "7 " + line + '\n'), "request sent");
+        const string reply = read_line(fd);
+        check(reply.starts_with("7 solved " + solution + ' '), "reply: " + reply);
+        ::close(fd);
+    }
+
+    // client not reading: 20000 replies of ~100 bytes are more than the socket buffers
+    // take, so the worker's send times out
+    const int slow_fd = connect_to(opt.socket_path);
+    check(slow_fd >= 0, "slow client connected");
+    long sent = 0;
+    if (slow_fd >= 0) {
+        const string request = line + '\n';
+        while (sent < 20000 && send_all(slow_fd, request)) ++sent;
+        this_thread::sleep_for(chrono::milliseconds(500));
+    }
+
+    const auto start = chrono::steady_clock::now();
+    service.stop();
+    const auto elapsed = chrono::steady_clock::now() - start;
+    if (slow_fd >= 0) ::close(slow_fd);
+
+    const auto st = service.stats();
+    check(elapsed < chrono::seconds(5), "stop() not stalled by the slow client");
+    check(st.dropped > 0, "requests of the slow client dropped");
+    check(sent < 20000, "slow client's connection shut down");
+    check(st.solved + st.unsolvable + st.unsolved + st.invalid + st.expired +
+                  st.dropped ==
+              st.requests,
+          "each request replied or dropped");
+
+    cout << st.requests << " requests, " << st.solved << " solved, " << st.dropped
+         << " dropped\n";
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
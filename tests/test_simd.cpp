@@ -0,0 +1,117 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_simd.h"
+#include "test_util.h"
+
+#include <cstdint>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// SSE4.1 and AVX2 kernels against the scalar reference on random states
+//
+// The states cover all array lengths up to one 25x25 grid, so every tail length of the
+// vector loops is hit, with random mixes of empty cells, candidate counts (0, 1, more)
+// and used masks. Instruction sets the CPU does not support are skipped.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static const char* level_name(Sudoku_simd_t level) {
+    switch (level) {
+        case Sudoku_simd_t::scalar: return "scalar";
+        case Sudoku_simd_t::sse4: return "sse4.1";
+        case Sudoku_simd_t::avx2: return "avx2";
+    }
+    return "unknown";
+}
+
+struct State {
+    vector<uint8_t> val;
+    vector<Sudoku_candidates> cand;
+    vector<cand_mask_t> used;
+    cand_mask_t common_used{0};
+};
+
+// random state of n cells with values and candidates of region size region_size
+static State random_state(int n, int region_size, mt19937& rng) {
+
+    const cand_mask_t all = static_cast<cand_mask_t>((uint64_t{1} << region_size) - 1);
+    uniform_int_distribution<int> value(1, region_size);
+    uniform_int_distribution<cand_mask_t> mask(0, all);
+    uniform_int_distribution<int> pct(0, 99);
+
+    State st;
+    st.val.resize(n);
+    st.cand.resize(n);
+    st.used.resize(n);
+    for (int i = 0; i < n; ++i) {
+        st.val[i] = pct(rng) < 50 ? 0 : static_cast<uint8_t>(value(rng));
+        const int kind = pct(rng);
+        cand_mask_t m  = mask(rng);
+        if (kind < 10) m = 0;    // no candidate left
+        else if (kind < 40) m = Sudoku_candidates::bit(value(rng));    // one left
+        st.cand[i] = Sudoku_candidates(m);
+        st.used[i] = pct(rng) < 50 ? 0 : mask(rng);
+    }
+    st.common_used = pct(rng) < 50 ? 0 : Sudoku_candidates::bit(value(rng));
+    return st;
+}
+
+// all kernels of k against the scalar kernels on st; false on the first difference
+static bool same_results(const Sudoku_kernels& k, const State& st) {
+
+    const Sudoku_kernels& ref = sudoku_simd_kernels(Sudoku_simd_t::scalar);
+    const int n               = static_cast<int>(st.val.size());
+
+    if (k.num_empty(st.val.data(), n) != ref.num_empty(st.val.data(), n)) return false;
+    if (k.num_candidates(st.val.data(), st.cand.data(), n) !=
+        ref.num_candidates(st.val.data(), st.cand.data(), n)) {
+        return false;
+    }
+
+    vector<int> cells(n + 1, -1), ref_cells(n + 1, -1);
+    const int num =
+        k.naked_single_cells(st.val.data(), st.cand.data(), n, cells.data());
+    const int ref_num =
+        ref.naked_single_cells(st.val.data(), st.cand.data(), n, ref_cells.data());
+    if (num != ref_num) return false;
+    for (int i = 0; i < num; ++i) {
+        if (cells[i] != ref_cells[i]) return false;
+    }
+
+    vector<Sudoku_candidates> cand(st.cand), ref_cand(st.cand);
+    k.filter_candidates(st.val.data(), cand.data(), n, st.common_used, st.used.data());
+    ref.filter_candidates(st.val.data(), ref_cand.data(), n, st.common_used,
+                          st.used.data());
+    return cand == ref_cand;
+}
+
+int main() {
+
+    mt19937 rng(20261019);
+
+    for (auto level : {Sudoku_simd_t::sse4, Sudoku_simd_t::avx2}) {
+        if (sudoku_simd_supported() < level) {
+            cout << level_name(level) << ": not supported by this CPU, skipped\n";
+            continue;
+        }
+        const Sudoku_kernels& k = sudoku_simd_kernels(level);
+        long states             = 0;
+        for (int n = 1; n <= 625; ++n) {
+            for (int region_size : {4, 9, 16, 25}) {
+                const State st = random_state(n, region_size, rng);
+                ++states;
+                check(same_results(k, st),
+                      string(level_name(level)) + ": same as scalar for n = " +
+                          to_string(n) + ", region size " + to_string(region_size));
+            }
+        }
+        cout << level_name(level) << ": " << states << " random states checked\n";
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
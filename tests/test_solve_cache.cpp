@@ -0,0 +1,112 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_canonical.h"
+#include "sudoku_generate.h"
+#include "sudoku_solve.h"
+#include "sudoku_solve_cache.h"
+#include "test_util.h"
+
+#include <algorithm>    // swap()
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// solution cache (sudoku_solve_cache.h)
+//
+//   - a symmetric variant of a cached puzzle is a hit, and the cached solution mapped
+//     back by the inverse transform is the solution of the variant
+//   - a cancelled search is not cached
+//   - save() and load() keep the entries
+//   - an entry not fitting the puzzle (solution of another one, rules broken) is a
+//     miss and replaced by the result of solving
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static Sudoku generate(uint64_t seed) {
+    Sudoku_generate_options opt;
+    opt.seed    = seed;
+    opt.threads = 1;
+    Sudoku_generate_stats stats;
+    return *sudoku_generate(9, 3, 3, opt, stats);
+}
+
+int main() {
+
+    const Sudoku p = generate(1);
+    const auto solved = sudoku_remove_recursive(p);
+
+    Sudoku_solution_cache cache(16);
+    const auto first = sudoku_remove_cached(p, cache);
+    check(same_values(first.second, solved.second), "miss: solution of the engine");
+    check(cache.stats().misses == 1 && cache.size() == 1, "miss: result cached");
+
+    // variant: transposed, rows swapped within the first band, first two stacks
+    // swapped, digits shifted by one
+    Sudoku_transform tr = sudoku_identity_transform(p);
+    tr.transpose        = true;
+    swap(tr.row[0], tr.row[2]);
+    for (int j = 0; j < 3; ++j) swap(tr.col[j], tr.col[3 + j]);
+    for (int v = 1; v <= 9; ++v) tr.digit[v] = v % 9 + 1;
+    const Sudoku variant = sudoku_apply_transform(p, tr);
+
+    const auto hit = cache.lookup(variant);
+    check(hit.has_value(), "variant: hit");
+    if (hit) {
+        check(same_values(hit->second, sudoku_remove_recursive(variant).second),
+              "variant: cached solution mapped back onto the variant");
+        check(hit->first == solved.first, "variant: no. of entries made");
+    }
+
+    // cancelled search: nothing cached
+    const Sudoku q = generate(2);
+    const atomic<bool> cancel{true};
+    Sudoku_search_options opt;
+    opt.cancel = &cancel;
+    Sudoku_search_stats stats;
+    sudoku_remove_cached(q, cache, Sudoku_engine_t::recursive, opt, stats);
+    check(cache.size() == 1 && cache.stats().insertions == 1, "cancelled: not cached");
+    check(!cache.lookup(q).has_value(), "cancelled: no hit afterwards");
+
+    // save and load
+    const string path = (filesystem::temp_directory_path() /
+                         ("test_solve_cache." + to_string(random_device{}())))
+                            .string();
+    check(cache.save(path), "save");
+    Sudoku_solution_cache loaded(16);
+    check(loaded.load(path) == 1, "load: one entry");
+    const auto reloaded = loaded.lookup(p);
+    check(reloaded && same_values(reloaded->second, solved.second),
+          "load: hit with the same solution");
+
+    // entries not fitting the puzzle: the solution of another puzzle, a grid breaking
+    // the rules; both are misses, and solving replaces them
+    string p_hash;    // the one entry saved is the one of p
+    ifstream(path) >> p_hash;
+    const Sudoku r = generate(3);
+    const string r_key =
+        sudoku_canonical_key(sudoku_apply_transform(sudoku_remove_recursive(r).second,
+                                                    sudoku_canonicalize(r).transform));
+    string bad_key = r_key;
+    swap(bad_key[bad_key.size() - 1], bad_key[bad_key.size() - 10]);    // last column
+    for (const string& key : {r_key, bad_key}) {
+        ofstream(path) << p_hash << ' ' << key << '\n';
+        Sudoku_solution_cache corrupt(16);
+        check(corrupt.load(path) == 1, "corrupt entry: loaded");
+        check(!corrupt.lookup(p).has_value() && corrupt.stats().misses == 1 &&
+                  corrupt.stats().rejected == 1,
+              "corrupt entry: miss");
+        const auto res = sudoku_remove_cached(p, corrupt);
+        check(same_values(res.second, solved.second) && corrupt.lookup(p).has_value(),
+              "corrupt entry: replaced by the solution");
+    }
+    filesystem::remove(path);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
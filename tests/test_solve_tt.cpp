@@ -0,0 +1,106 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_generate.h"
+#include "sudoku_solve.h"
+#include "sudoku_solve_tt.h"
+#include "test_util.h"
+
+#include <cstdint>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// transposition table (sudoku_solve_tt.h): same results with and without it
+//
+//   - solution counts of puzzles with many solutions (clues of generated puzzles
+//     removed), with a table of their own and with one table shared by all counts;
+//     without a table set, counting uses none
+//   - counts within reduced candidates (one candidate of a cell removed, as in the
+//     clue checks of sudoku_minimize()) on the shared table, followed by the count of
+//     the same grid with all candidates
+//   - mixed search with table and restarts: same solution as without
+//////////////////////////////////////////////////////////////////////////////////////////
+
+int main() {
+
+    const int limit = 1000;
+    Sudoku_search_options shared_opt;
+    shared_opt.transposition = true;
+    Sudoku_transposition_table shared(shared_opt.tt_max_bytes, shared_opt.tt_replace);
+    shared_opt.tt = &shared;
+    Sudoku_search_stats shared_stats;
+
+    long counts = 0;
+    for (int region_size : {4, 9}) {
+        for (uint64_t seed = 0; seed < 6; ++seed) {
+            Sudoku_generate_options gen_opt;
+            gen_opt.seed    = seed;
+            gen_opt.threads = 1;
+            Sudoku_generate_stats gen_stats;
+            const int b = region_size == 4 ? 2 : 3;
+            const auto p = sudoku_generate(region_size, b, b, gen_opt, gen_stats);
+            if (!p) continue;
+            const string name = to_string(region_size) + "x" + to_string(region_size) +
+                                " seed " + to_string(seed);
+
+            // more solutions: the first clues removed
+            Sudoku q(*p);
+            for (int cnt = 0, removed = 0; cnt < q.total_size && removed < 6; ++cnt) {
+                if (q(cnt).val == 0) continue;
+                q.set_value(cnt, 0);
+                ++removed;
+            }
+            sudoku_reset_candidates_all_cells(q);
+
+            const int plain = sudoku_count_solutions(q, limit);
+            Sudoku_search_options own_opt;
+            own_opt.transposition = true;
+            Sudoku_search_stats own_stats;
+            check(sudoku_count_solutions(q, limit, own_opt, own_stats) == plain &&
+                      own_stats.tt_probes == 0,
+                  name + ": count without a table set: none used");
+            Sudoku_transposition_table own(own_opt.tt_max_bytes, own_opt.tt_replace);
+            own_opt.tt = &own;
+            check(sudoku_count_solutions(q, limit, own_opt, own_stats) == plain,
+                  name + ": count with a table of its own");
+
+            // reduced candidates: one candidate of the first empty cell with several
+            Sudoku r(q);
+            for (int cnt = 0; cnt < r.total_size; ++cnt) {
+                if (r(cnt).val != 0 || r(cnt).cand.size() < 2) continue;
+                r(cnt).cand.erase(*r(cnt).cand.begin());
+                break;
+            }
+            check(sudoku_count_solutions_within_candidates(r, limit, shared_opt,
+                                                           shared_stats) ==
+                      sudoku_count_solutions_within_candidates(r, limit),
+                  name + ": count within reduced candidates, shared table");
+            check(sudoku_count_solutions(q, limit, shared_opt, shared_stats) == plain,
+                  name + ": count with all candidates after the reduced one, shared "
+                         "table");
+
+            // mixed search with table and restarts
+            Sudoku_search_options mixed_opt;
+            mixed_opt.transposition = true;
+            mixed_opt.restarts      = Sudoku_restart_t::luby;
+            mixed_opt.restart_base  = 4;
+            Sudoku_search_stats mixed_stats;
+            const auto with_tt =
+                sudoku_remove_recursive_algo_all_mixed(*p, mixed_opt, mixed_stats);
+            const auto without = sudoku_remove_recursive(*p);
+            bool same = with_tt.first == without.first;
+            for (int cnt = 0; same && cnt < p->total_size; ++cnt) {
+                same = with_tt.second.values()[cnt] == without.second.values()[cnt];
+            }
+            check(same, name + ": mixed search with table and restarts");
+            counts += plain;
+        }
+    }
+
+    cout << "solutions counted: " << counts << ", shared table: " << shared_stats.tt_hits
+         << " hits of " << shared_stats.tt_probes << " probes\n";
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_generate.h"
+#include "sudoku_line.h"
+#include "sudoku_solve_cache.h"
+#include "sudoku_stream.h"
+#include "test_util.h"
+
+#include <cstdint>
+#include <cstdio>     // remove()
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <fstream>
+#include <iostream>
+#include <iterator>    // istreambuf_iterator
+#include <string>
+
+#include <fcntl.h>     // open()
+#include <unistd.h>    // close(), getpid()
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// streaming solve with checkpoints (sudoku_stream.h) on files in /tmp
+//
+//   - a run with checkpoints writes the same output as one without
+//   - a run interrupted after a part of the input (its checkpoint, plus results written
+//     after it) resumed on the whole input gives byte-identical output
+//   - a finished run started again does nothing
+//   - the batch engine (puzzles of a chunk solved together) writes the same output as
+//     the recursive one, also with a solution cache
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static const string dir = "/tmp/test_stream." + to_string(::getpid());
+
+static string read_file(const string& path) {
+    ifstream in(path, ios::binary);
+    return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+static void write_file(const string& path, const string& data) {
+    ofstream(path, ios::binary | ios::trunc) << data;
+}
+
+// solve input into output (not truncated, as by sudoku_cli with checkpoints)
+static bool run(const string& input, const string& output,
+                const Sudoku_stream_options& opt, Sudoku_stream_stats& st) {
+    const int in_fd  = ::open(input.c_str(), O_RDONLY);
+    const int out_fd = ::open(output.c_str(), O_WRONLY | O_CREAT, 0644);
+    const bool ok =
+        in_fd >= 0 && out_fd >= 0 && sudoku_solve_stream(in_fd, out_fd, opt, st);
+    if (in_fd >= 0) ::close(in_fd);
+    if (out_fd >= 0) ::close(out_fd);
+    return ok;
+}
+
+int main() {
+
+    // 24 lines: 4x4 and 9x9 puzzles, one line not a puzzle
+    string lines, head;
+    const int num_lines = 24, num_head = 10;
+    for (int k = 0; k < num_lines; ++k) {
+        string line = "not a puzzle";
+        if (k != 7) {
+            Sudoku_generate_options gen_opt;
+            gen_opt.seed    = static_cast<uint64_t>(k);
+            gen_opt.threads = 1;
+            Sudoku_generate_stats gen_stats;
+            const int b  = k % 3 == 0 ? 2 : 3;
+            const auto p = sudoku_generate(b * b, b, b, gen_opt, gen_stats);
+            if (p) line = sudoku_to_line(*p);
+        }
+        lines += line + '\n';
+        if (k + 1 == num_head) head = lines;
+    }
+
+    const string input = dir + ".in", input_head = dir + ".head";
+    const string reference = dir + ".ref", output = dir + ".out", cp = dir + ".cp";
+    write_file(input, lines);
+    write_file(input_head, head);
+
+    Sudoku_stream_options opt;
+    opt.threads     = 2;
+    opt.batch_size  = 2;
+    opt.window      = 4;
+    opt.flush_bytes = 1;
+    Sudoku_stream_stats ref_st;
+    check(run(input, reference, opt, ref_st), "run without checkpoints");
+    const string expected = read_file(reference);
+    check(ref_st.records == num_lines && ref_st.invalid == 1, "reference records");
+
+    // with checkpoints: same output, a checkpoint at the end
+    opt.checkpoint_path     = cp;
+    opt.checkpoint_interval = 1e-6;
+    Sudoku_stream_stats st;
+    check(run(input, output, opt, st), "run with checkpoints");
+    check(read_file(output) == expected, "output with checkpoints");
+    Sudoku_stream_checkpoint last;
+    check(sudoku_read_stream_checkpoint(cp, last) && last.records == num_lines &&
+              last.input_offset == lines.size() && last.output_offset == expected.size(),
+          "last checkpoint");
+    check(st.checkpoints > 1, "checkpoints written");
+    std::remove(output.c_str());
+    std::remove(cp.c_str());
+
+    // interrupted: the head of the input done, then results past the checkpoint
+    Sudoku_stream_stats head_st;
+    check(run(input_head, output, opt, head_st), "run on the head");
+    Sudoku_stream_checkpoint mid;
+    check(sudoku_read_stream_checkpoint(cp, mid) && mid.records == num_head,
+          "checkpoint after the head");
+    ofstream(output, ios::binary | ios::app) << "solved - written after the checkpoint\n";
+    Sudoku_stream_stats resumed_st;
+    check(run(input, output, opt, resumed_st), "resumed run");
+    check(read_file(output) == expected, "resumed output byte-identical");
+    check(resumed_st.resumed == num_head &&
+              resumed_st.records + resumed_st.resumed == num_lines,
+          "records of the resumed run");
+
+    // finished: nothing to do
+    Sudoku_stream_stats again_st;
+    check(run(input, output, opt, again_st), "finished run again");
+    check(again_st.records == 0 && read_file(output) == expected, "finished run: no-op");
+
+    // batch engine, without and with a cache (hits on the second run)
+    Sudoku_stream_options batch_opt = opt;
+    batch_opt.checkpoint_path.clear();
+    batch_opt.engine     = Sudoku_engine_t::batch;
+    batch_opt.batch_size = 8;
+    Sudoku_solution_cache cache;
+    for (auto* c : {static_cast<Sudoku_solution_cache*>(nullptr), &cache, &cache}) {
+        batch_opt.cache = c;
+        std::remove(output.c_str());
+        Sudoku_stream_stats batch_st;
+        check(run(input, output, batch_opt, batch_st) && read_file(output) == expected,
+              string("batch engine output") + (c ? " with a cache" : ""));
+    }
+    check(cache.stats().hits >= num_lines - 1, "batch engine: cache hits");
+
+    for (const string& path : {input, input_head, reference, output, cp}) {
+        std::remove(path.c_str());
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,34 @@
+// let emacs know this is a C++ header: -*- C++ -*-
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#pragma once
+
+#include "sudoku_class.h"
+
+#include <iostream>
+#include <string>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// scaffolding shared by the test executables (see CMakeLists.txt)
+//
+// Each test is a main() making a series of check() calls; failed checks are reported
+// and counted, and main() returns EXIT_SUCCESS only if there were none.
+//////////////////////////////////////////////////////////////////////////////////////////
+
+inline int failures = 0;    // no. of failed checks
+
+inline void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cout << "FAILED: " << what << '\n';
+        ++failures;
+    }
+}
+
+// same shape and same values (candidates are not compared)
+inline bool same_values(const Sudoku& a, const Sudoku& b) {
+    if (a.total_size != b.total_size) return false;
+    for (int cnt = 0; cnt < a.total_size; ++cnt) {
+        if (a.values()[cnt] != b.values()[cnt]) return false;
+    }
+    return true;
+}
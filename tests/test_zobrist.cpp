@@ -0,0 +1,99 @@
+// 3456789012345678901234567890123456789012345678901234567890123456789012345678901234567890
+
+#include "sudoku_class.h"
+#include "sudoku_generate.h"
+#include "sudoku_metrics.h"    // sudoku_engine_name()
+#include "sudoku_solve.h"
+#include "test_util.h"
+
+#include <cstdint>
+#include <cstdlib>    // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Zobrist hash of the values (Sudoku::hash())
+//
+//   - set_value() keeps hash() equal to compute_hash(), over random writes
+//   - copies take the hash along, restoring a saved copy restores it
+//   - the hash depends on the values only: the same grid reached in another order, or
+//     written directly and rehashed, has the same hash; a changed value changes it
+//   - solving with the engines leaves the hash up to date
+//////////////////////////////////////////////////////////////////////////////////////////
+
+int main() {
+
+    mt19937_64 rng(7);
+    const int shapes[][3] = {{4, 2, 2}, {6, 2, 3}, {9, 3, 3}, {16, 4, 4}};
+
+    for (const auto& shape : shapes) {
+        if (shape[0] > sudoku_max_region_size) continue;
+        const int n       = shape[0];
+        const string name = to_string(n) + "x" + to_string(n);
+
+        Sudoku s(shape[0], shape[1], shape[2]);
+        check(s.hash() == s.compute_hash(), name + ": empty grid");
+
+        // random writes, with a copy saved halfway
+        bool in_sync = true;
+        Sudoku saved(s);
+        for (int k = 0; k < 2000; ++k) {
+            const auto cnt = static_cast<int>(rng() % s.total_size);
+            s.set_value(cnt, static_cast<int>(rng() % (n + 1)));
+            in_sync = in_sync && s.hash() == s.compute_hash();
+            if (k == 1000) saved = s;
+        }
+        check(in_sync, name + ": set_value()");
+
+        const Sudoku copy(s);
+        check(copy.hash() == s.hash(), name + ": copy");
+        const uint64_t saved_hash = saved.hash();
+        s                         = saved;
+        check(s.hash() == saved_hash && s.hash() == s.compute_hash(),
+              name + ": saved copy restored");
+
+        // the same values written backwards, and directly
+        Sudoku backwards(shape[0], shape[1], shape[2]);
+        Sudoku direct(shape[0], shape[1], shape[2]);
+        for (int cnt = s.total_size - 1; cnt >= 0; --cnt) {
+            backwards.set_value(cnt, s.values()[cnt]);
+            direct.values()[cnt] = s.values()[cnt];
+        }
+        direct.rehash();
+        check(backwards.hash() == s.hash(), name + ": values written in another order");
+        check(direct.hash() == s.hash(), name + ": values written directly, rehash()");
+
+        // one value changed and back
+        const int cnt = static_cast<int>(rng() % s.total_size);
+        const int v   = s.values()[cnt];
+        s.set_value(cnt, (v + 1) % (n + 1));
+        check(s.hash() != saved_hash, name + ": changed value");
+        s.set_value(cnt, v);
+        check(s.hash() == saved_hash, name + ": value changed back");
+    }
+
+    // engines: results (set via set_value() or restored copies) keep an up to date hash
+    Sudoku_generate_options gen_opt;
+    gen_opt.seed    = 3;
+    gen_opt.threads = 1;
+    Sudoku_generate_stats gen_stats;
+    const auto p = sudoku_generate(9, 3, 3, gen_opt, gen_stats);
+    check(p.has_value() && p->hash() == p->compute_hash(), "generated puzzle");
+    if (p) {
+        const auto rec = sudoku_remove_recursive(*p).second;
+        check(rec.hash() == rec.compute_hash(), "result of the recursive search");
+        Sudoku_search_options opt;
+        Sudoku_search_stats stats;
+        for (auto engine : {Sudoku_engine_t::mixed, Sudoku_engine_t::sat,
+                            Sudoku_engine_t::logic}) {
+            const auto res = sudoku_remove_engine(*p, engine, opt, stats).second;
+            check(res.hash() == res.compute_hash(),
+                  string("result of the engine ") + sudoku_engine_name(engine));
+        }
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}